@@ -0,0 +1,56 @@
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+#include "game-arena.h"
+#include "game-generator.h"
+#include "game-playback.h"
+#include "poker-lib.h"
+
+using namespace poker;
+
+/*
+   GMP allocations and time per game, with and without game arenas.
+   Each game is generated by two players, then played back by a referee.
+   Usage: bench-arena [games]
+*/
+
+static game_error play_game() {
+    game_error res;
+    game_generator gen;
+    if ((res = gen.generate()))
+        return res;
+    std::istringstream is(gen.raw_turn_data);
+    game_playback vcr;
+    return vcr.playback(is);
+}
+
+static int run(const char* mode, bool arenas, int games) {
+    use_game_arenas(arenas);
+    auto& counters = thread_allocation_counters();
+    counters = allocation_counters{0, 0};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < games; i++) {
+        game_error res;
+        if ((res = play_game())) {
+            fprintf(stderr, "Error %d playing game\n", res);
+            return -1;
+        }
+    }
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%-8s %6d %12.1f %14.1f %14.1f\n", mode, games, ms / games,
+           (double)counters.heap / games, (double)counters.arena / games);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int games = argc > 1 ? atoi(argv[1]) : 5;
+    poker_lib_options opts;
+    opts.game_arenas = false;
+    init_poker_lib(&opts);
+
+    printf("%-8s %6s %12s %14s %14s\n", "mode", "games", "ms/game", "heap_allocs", "arena_allocs");
+    if (run("heap", false, games) || run("arena", true, games))
+        return -1;
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+#include "bignumber.h"
+#include "poker-lib.h"
+
+using namespace poker;
+
+/*
+   Big-endian binary conversions of turn metadata sized columns, byte at a
+   time as they used to be done, through bignumber, and through streams.
+   Usage: bench-bignumber [fields]
+*/
+
+static void reference_load(mpz_t n, const unsigned char* data, int len) {
+    mpz_set_ui(n, 0);
+    for (int i = 0; i < len; i++) {
+        mpz_mul_ui(n, n, 256);
+        mpz_add_ui(n, n, data[i]);
+    }
+}
+
+static void reference_store(mpz_t n, unsigned char* data, int len) {
+    mpz_t t;
+    mpz_init_set(t, n);
+    for (int i = len - 1; i >= 0; i--) {
+        data[i] = (unsigned char)mpz_fdiv_ui(t, 256);
+        mpz_fdiv_q_ui(t, t, 256);
+    }
+    mpz_clear(t);
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int fields = argc > 1 ? atoi(argv[1]) : 20000;
+    init_poker_lib();
+
+    printf("%6s %14s %14s %14s\n", "bytes", "reference_MB/s", "bignumber_MB/s", "streams_MB/s");
+    const int sizes[] = {4, 20, 32};
+    for (auto len : sizes) {
+        std::vector<unsigned char> column(fields * len);
+        for (auto& c : column)
+            c = rand();
+        std::vector<bignumber> values(fields);
+        mpz_t ref;
+        mpz_init(ref);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < fields; i++) {
+            reference_load(ref, &column[i * len], len);
+            reference_store(ref, &column[i * len], len);
+        }
+        auto reference_ms = elapsed_ms(start);
+        mpz_clear(ref);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < fields; i++) {
+            values[i].load_binary_be((char*)&column[i * len], len);
+            values[i].store_binary_be((char*)&column[i * len], len);
+        }
+        auto ms = elapsed_ms(start);
+
+        start = std::chrono::steady_clock::now();
+        std::string packed((char*)column.data(), column.size());
+        std::istringstream is(packed);
+        std::ostringstream os;
+        game_error res = SUCCESS;
+        for (int i = 0; i < fields && !res; i++)
+            res = values[i].read_binary_be(is, len);
+        for (int i = 0; i < fields && !res; i++)
+            res = values[i].write_binary_be(os, len);
+        auto streams_ms = elapsed_ms(start);
+        if (res || packed != os.str()) {
+            fprintf(stderr, "Error %d converting through streams\n", res);
+            return -1;
+        }
+
+        double mb = 2.0 * column.size() / (1024 * 1024);
+        printf("%6d %14.1f %14.1f %14.1f\n", len, mb / (reference_ms / 1000), mb / (ms / 1000),
+               mb / (streams_ms / 1000));
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "compression.h"
+#include "game-generator.h"
+#include "messages.h"
+#include "poker-lib.h"
+
+using namespace poker;
+
+/*
+   Compression ratio and latency per message type, over the messages of a
+   generated game.
+   Usage: bench-compression [quality] [window] [dictionary] [iterations]
+*/
+
+static const char* message_names[] = {
+    "vtmf", "vtmf_response", "vsshe", "vsshe_response",
+    "bob_private_cards", "bet_request", "card_proof",
+    "short_vtmf", "short_vtmf_response", "alice_mix", "alice_private_cards"
+};
+static const int num_message_names = sizeof(message_names) / sizeof(message_names[0]);
+
+static double elapsed_us(std::chrono::steady_clock::time_point start, int iterations) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    return (double)us / iterations;
+}
+
+int main(int argc, char** argv) {
+    game_error res;
+    poker_lib_options opts;
+    if (argc > 1) opts.compression_quality = atoi(argv[1]);
+    if (argc > 2) opts.compression_window = atoi(argv[2]);
+    if (argc > 3) opts.compression_dictionary = atoi(argv[3]);
+    int iterations = argc > 4 ? atoi(argv[4]) : 20;
+    if (init_poker_lib(&opts)) {
+        fprintf(stderr, "Invalid compression options\n");
+        return -1;
+    }
+
+    game_generator gen;
+    if ((res = gen.generate())) {
+        fprintf(stderr, "Error %d generating game\n", res);
+        return -1;
+    }
+
+    // raw (uncompressed) messages grouped by type
+    std::map<int, std::vector<std::string>> messages;
+    for (auto& turn : gen.turns) {
+        std::string raw;
+        if ((res = unwrap_and_decompress(std::get<1>(turn), raw))) {
+            fprintf(stderr, "Error %d decompressing turn\n", res);
+            return -1;
+        }
+        std::istringstream is(raw);
+        message* msg = NULL;
+        if ((res = message::decode(is, &msg))) {
+            fprintf(stderr, "Error %d decoding turn\n", res);
+            return -1;
+        }
+        messages[msg->type()].push_back(raw);
+        delete msg;
+    }
+
+    int dictionary = default_compression_dictionary();
+    printf("quality=%d window=%d dictionary=%d iterations=%d\n", opts.compression_quality, opts.compression_window, dictionary, iterations);
+    printf("%-19s %5s %10s %10s %7s %12s %12s\n", "message", "count", "raw", "compressed", "ratio", "compress_us", "decompress_us");
+    for (auto& kv : messages) {
+        size_t raw_size = 0, compressed_size = 0;
+        std::vector<std::string> compressed(kv.second.size());
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            for (size_t m = 0; m < kv.second.size(); m++)
+                if ((res = compress(kv.second[m], compressed[m], dictionary))) {
+                    fprintf(stderr, "Error %d compressing\n", res);
+                    return -1;
+                }
+        auto compress_us = elapsed_us(start, iterations * kv.second.size());
+
+        std::string out;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            for (auto& c : compressed)
+                if ((res = decompress(c, out, dictionary))) {
+                    fprintf(stderr, "Error %d decompressing\n", res);
+                    return -1;
+                }
+        auto decompress_us = elapsed_us(start, iterations * kv.second.size());
+
+        for (size_t m = 0; m < kv.second.size(); m++) {
+            raw_size += kv.second[m].size();
+            compressed_size += compressed[m].size();
+        }
+        char unknown[20];
+        sprintf(unknown, "type %d", (int)kv.first);
+        printf("%-19s %5d %10d %10d %7.2f %12.1f %12.1f\n",
+               kv.first >= 0 && kv.first < num_message_names ? message_names[kv.first] : unknown, (int)kv.second.size(), (int)raw_size, (int)compressed_size,
+               (double)raw_size / compressed_size, compress_us, decompress_us);
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "hand-driver.h"
+#include "player.h"
+#include "poker-lib.h"
+
+using namespace poker;
+
+/*
+   Handshake latency, long and short, over a simulated network: every
+   message is delivered half a round trip after it is sent. The players take
+   turns, so the handshake costs its crypto plus one delay per message.
+   Usage: bench-handshake [rtt_ms] [handshakes]
+*/
+
+// a player getting each message half a round trip after it was sent
+struct remote_player : player {
+    int rtt_ms;
+    remote_player(int id, int rtt) : player(id), rtt_ms(rtt) {}
+    game_error process_handshake(std::string& msg_in, std::string& msg_out) {
+        std::this_thread::sleep_for(std::chrono::microseconds(rtt_ms * 500));
+        return player::process_handshake(msg_in, msg_out);
+    }
+};
+
+static game_error handshake(int rtt_ms, int& messages) {
+    game_error res;
+    remote_player alice(ALICE, rtt_ms), bob(BOB, rtt_ms);
+    messages = 0;
+    if ((res = alice.init(100, 300, 10)) || (res = bob.init(100, 300, 10)) ||
+        (res = play_handshake(alice, bob, &messages)))
+        return res;
+    return alice.step() == PREFLOP_BET && bob.step() == PREFLOP_BET ? SUCCESS : PLB_BAD_HANDSHAKE;
+}
+
+static int run(const char* mode, bool short_handshake, int rtt_ms, int count) {
+    set_short_handshake(short_handshake);
+    int messages = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        game_error res;
+        if ((res = handshake(rtt_ms, messages))) {
+            fprintf(stderr, "Error %d in handshake\n", res);
+            return -1;
+        }
+    }
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / count;
+    printf("%-8s %8d %8d %14.1f %14.1f\n", mode, rtt_ms, messages, ms, ms - messages * rtt_ms / 2.0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int rtt_ms = argc > 1 ? atoi(argv[1]) : 100;
+    int count = argc > 2 ? atoi(argv[2]) : 3;
+    init_poker_lib();
+
+    printf("%-8s %8s %8s %14s %14s\n", "mode", "rtt_ms", "messages", "ms/handshake", "ms_crypto");
+    if (run("long", false, rtt_ms, count) || run("short", true, rtt_ms, count))
+        return -1;
+    return 0;
+}
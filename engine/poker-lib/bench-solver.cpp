@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#ifdef POKER_THREADS
+#include <thread>
+#endif
+
+#include "hand-evaluator.h"
+#include "poker-lib.h"
+#include "solver.h"
+
+using namespace poker;
+
+/*
+   7-card hands per second on one core: rated by the built-in tables one
+   by one and in batches, and compared in pairs through the solver with
+   each backend. Batches are also rated on all cores, reported per core.
+   Usage: bench-solver [hands]
+*/
+
+static const int hand_size = 7;
+
+static double hands_per_second(std::chrono::steady_clock::time_point start, int hands) {
+    auto s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return hands / s;
+}
+
+static int run_solver(const char* name, solver_backend backend, const std::vector<card_t>& hands, int count) {
+    if (set_solver_backend(backend)) {
+        printf("%-12s %14s\n", name, "unavailable");
+        return 0;
+    }
+    solver sol;
+    int wins[3] = {0, 0, 0};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i + 1 < count; i += 2) {
+        int result;
+        game_error res;
+        if ((res = sol.compare_hands(&hands[i * hand_size], &hands[(i + 1) * hand_size], hand_size, &result))) {
+            fprintf(stderr, "Error %d comparing hands\n", res);
+            return -1;
+        }
+        wins[result]++;
+    }
+    printf("%-12s %14.0f    %d/%d/%d\n", name, hands_per_second(start, count), wins[1], wins[2], wins[0]);
+    return 0;
+}
+
+typedef void (*batch_evaluator)(const uint64_t*, int, unsigned short*);
+
+static void avx2_batch(const uint64_t* hands, int count, unsigned short* ratings) {
+    evaluate_hands_avx2(hands, count, ratings);
+}
+
+static long checksum(const std::vector<unsigned short>& ratings) {
+    long sum = 0;
+    for (auto r : ratings)
+        sum += r;
+    return sum;
+}
+
+static void run_batch(const char* name, batch_evaluator evaluate, const std::vector<uint64_t>& masks) {
+    std::vector<unsigned short> ratings(masks.size());
+    auto start = std::chrono::steady_clock::now();
+    evaluate(masks.data(), (int)masks.size(), ratings.data());
+    printf("%-12s %14.0f    checksum %ld\n", name, hands_per_second(start, masks.size()), checksum(ratings));
+}
+
+#ifdef POKER_THREADS
+static void run_threaded_batch(const char* name, batch_evaluator evaluate, const std::vector<uint64_t>& masks) {
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned short> ratings(masks.size());
+    // every thread rates all the hands, as a core would alone
+    std::vector<std::vector<unsigned short>> results(threads, ratings);
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++)
+        workers.push_back(std::thread([&, t]() { evaluate(masks.data(), (int)masks.size(), results[t].data()); }));
+    for (auto& w : workers)
+        w.join();
+    printf("%-12s %14.0f    %d threads, checksum %ld\n", name, hands_per_second(start, masks.size()), threads, checksum(results[0]));
+}
+#endif
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 1000000;
+    poker_lib_options opts;
+    opts.encryption = false;
+    init_poker_lib(&opts);
+
+    // random deals
+    std::mt19937 rng(1);
+    std::vector<card_t> deck(52);
+    for (int c = 0; c < 52; c++)
+        deck[c] = c;
+    std::vector<card_t> hands;
+    hands.reserve(count * hand_size);
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < hand_size; j++)
+            std::swap(deck[j], deck[j + rng() % (52 - j)]);
+        hands.insert(hands.end(), deck.begin(), deck.begin() + hand_size);
+    }
+
+    printf("%-12s %14s    %s\n", "evaluator", "hands/s", "wins first/second/ties");
+    auto start = std::chrono::steady_clock::now();
+    long checksum = 0;
+    for (int i = 0; i < count; i++)
+        checksum += evaluate_hand(&hands[i * hand_size], hand_size);
+    printf("%-12s %14.0f    checksum %ld\n", "tables", hands_per_second(start, count), checksum);
+
+    std::vector<uint64_t> masks;
+    for (int i = 0; i < count; i++)
+        masks.push_back(hand_mask(&hands[i * hand_size], hand_size));
+    run_batch("scalar", evaluate_hands_scalar, masks);
+    unsigned short probe;
+    bool avx2 = evaluate_hands_avx2(masks.data(), 1, &probe);
+    if (avx2)
+        run_batch("avx2", avx2_batch, masks);
+    else
+        printf("%-12s %14s\n", "avx2", "unavailable");
+#ifdef POKER_THREADS
+    run_threaded_batch("scalar/core", evaluate_hands_scalar, masks);
+    if (avx2)
+        run_threaded_batch("avx2/core", avx2_batch, masks);
+#endif
+
+    if (run_solver("hand-tables", SOLVER_HAND_TABLES, hands, count) ||
+        run_solver("poker-eval", SOLVER_POKER_EVAL, hands, count))
+        return -1;
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#ifdef POKER_THREADS
+#include <thread>
+#endif
+
+#include "hand-driver.h"
+#include "player.h"
+#include "poker-lib.h"
+
+using namespace poker;
+
+/*
+   Tables per second on 1, 2, 4... threads, up to one per core. Each table
+   is a pair of players of its own options playing a handshake and an all-in
+   preflop; tables share nothing, so the rate should grow with the threads.
+   Usage: bench-tables [tables] [encryption]
+*/
+
+static game_error play(const poker_lib_options& opts) {
+    player alice(ALICE, opts), bob(BOB, opts);
+    game_error res;
+    if ((res = alice.init(100, 300, 10)) || (res = bob.init(100, 300, 10)) || (res = play_all_in(alice, bob)))
+        return res;
+    return alice.step() == GAME_OVER && bob.step() == GAME_OVER ? SUCCESS : PLB_BAD_HANDSHAKE;
+}
+
+static double run(const poker_lib_options& opts, int tables, int threads) {
+    std::atomic<int> next(0);
+    std::atomic<int> errors(0);
+    auto work = [&]() {
+        for (int i; (i = next++) < tables;) {
+            game_error res = play(opts);
+            if (res && !errors++)
+                fprintf(stderr, "Error %d playing a table\n", res);
+        }
+    };
+    auto start = std::chrono::steady_clock::now();
+#ifdef POKER_THREADS
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++)
+        pool.emplace_back(work);
+    work();
+    for (auto& t : pool)
+        t.join();
+#else
+    work();
+#endif
+    if (errors)
+        return -1;
+    return tables / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int cores = 1;
+#ifdef POKER_THREADS
+    cores = std::max(1, (int)std::thread::hardware_concurrency());
+#endif
+    int tables = argc > 1 ? atoi(argv[1]) : 4 * cores;
+    init_poker_lib();
+    poker_lib_options opts;
+    opts.encryption = argc > 2 ? atoi(argv[2]) != 0 : true;
+
+    printf("%8s %14s %10s %12s\n", "threads", "tables/s", "speedup", "efficiency");
+    double base = 0;
+    for (int threads = 1;; threads = std::min(2 * threads, cores)) {
+        double rate = run(opts, tables, threads);
+        if (rate < 0)
+            return -1;
+        if (threads == 1)
+            base = rate;
+        printf("%8d %14.2f %10.2f %12.2f\n", threads, rate, rate / base, rate / base / threads);
+        if (threads == cores)
+            break;
+    }
+    return 0;
+}
@@ -1,13 +1,17 @@
 #include <memory.h>
 #include "bignumber.h"
 #include <iostream>
+#include <vector>
 
 namespace poker {
 
 std::string bignumber::to_string(int base)  const{
     char* mem = mpz_get_str(NULL, base, n);
     std::string s = mem;
-    free(mem);
+    // through GMP, which may be allocating from a game arena
+    void (*free_fn)(void*, size_t);
+    mp_get_memory_functions(NULL, NULL, &free_fn);
+    free_fn(mem, s.size() + 1);
     return s;
 }
 
@@ -17,54 +21,69 @@ game_error bignumber::parse_string(const char* s, int base) {
     return SUCCESS;
 }
 
-void bignumber::load_binary_be(char* data, int len) {
-    auto udata = (unsigned char*)data;
-    mpz_set_ui(n, 0);
-    for(int i=0; i<len; i++) {
-        mpz_mul_ui(n, n, 256);
-        mpz_add_ui(n, n, udata[i]);
-    }
+// fields of the blockchain data are at most a word wide
+static const int max_field_size = 32;
+
+void bignumber::load_binary_be(const char* data, int len) {
+    if (len > 0)
+        mpz_import(n, len, 1, 1, 1, 0, data);
+    else
+        mpz_set_ui(n, 0);
 }
 
 void bignumber::store_binary_be(char* data, int len) {
-    mpz_t r, t;
-    mpz_init(r);
-    mpz_init(t);
-    mpz_set(t, n);
-    for(int i=len-1; i>=0; i--) {
-        mpz_mod_ui(r, t, 256);
-        mpz_div_ui(t, t, 256);
-        data[i] = (unsigned char)mpz_get_ui(r);
+    if (len <= 0)
+        return;
+    int size = mpz_sgn(n) ? (int)((mpz_sizeinbase(n, 2) + 7) / 8) : 0;
+    if (size <= len) {
+        memset(data, 0, len - size);
+        mpz_export(data + len - size, NULL, 1, 1, 1, 0, n);
+        return;
+    }
+    // wider than the field: keep the lower bytes
+    char small[max_field_size];
+    std::vector<char> large;
+    char* tmp = small;
+    if (size > max_field_size) {
+        large.resize(size);
+        tmp = large.data();
     }
-    mpz_clear(r);
-    mpz_clear(t);
+    mpz_export(tmp, NULL, 1, 1, 1, 0, n);
+    memcpy(data, tmp + size - len, len);
 }
 
 game_error bignumber::read_binary_be(std::istream& in, int len) {
-    if (!in.good())
+    if (!in.good() || len < 0)
         return BIG_READ_ERROR;
-    game_error res = SUCCESS;
-    auto tmp = new char[len];
+    char small[max_field_size];
+    std::vector<char> large;
+    char* tmp = small;
+    if (len > max_field_size) {
+        large.resize(len);
+        tmp = large.data();
+    }
     in.read(tmp, len);
-    if (in.good())
-        load_binary_be(tmp, len);
-    else
-        res = BIG_READ_ERROR;
-    delete [] tmp;
-    return res;
+    if (!in.good())
+        return BIG_READ_ERROR;
+    load_binary_be(tmp, len);
+    return SUCCESS;
 }
 
 game_error bignumber::write_binary_be(std::ostream& out, int len) {
-    if (!out.good())
+    if (!out.good() || len < 0)
         return BIG_WRITE_ERROR;
-    game_error res = SUCCESS;
-    auto tmp = new char[len];
+    char small[max_field_size];
+    std::vector<char> large;
+    char* tmp = small;
+    if (len > max_field_size) {
+        large.resize(len);
+        tmp = large.data();
+    }
     store_binary_be(tmp, len);
     out.write(tmp, len);
     if (!out.good())
-        res = BIG_WRITE_ERROR;
-    delete [] tmp;
-    return res;
+        return BIG_WRITE_ERROR;
+    return SUCCESS;
 }
 
 
@@ -82,15 +82,14 @@ public:
     
     std::string to_string(int base=10) const;
     game_error parse_string(const char* s, int base=10);
-    void load_binary_be(char* data, int len);
+    void load_binary_be(const char* data, int len);
+    // keeps the len least significant bytes
     void store_binary_be(char* data, int len);
     game_error read_binary_be(std::istream& in, int len);
     game_error write_binary_be(std::ostream& out, int len);
     
 };
 
-typedef bignumber money_t;
-
 std::ostream& operator << (std::ostream &out, const bignumber& v);
 
 }
@@ -45,6 +45,12 @@ game_error encoder::write(const bignumber& v) {
     return write(s.c_str(), s.size(), pfx_bignumber);
 }
 
+// same text as a bignumber of that value
+game_error encoder::write(const money& v) {
+    auto s = v.to_string(16);
+    return write(s.c_str(), s.size(), pfx_bignumber);
+}
+
 game_error encoder::write(const char* v, int len, char pfx) {
     std::stringstream ss;
     ss << pfx << len << separator;
@@ -147,6 +153,14 @@ game_error decoder::read(bignumber& v) {
     return SUCCESS;
 }
 
+game_error decoder::read(money& v) {
+    game_error res;
+    std::string temp;
+    if ((res=read(temp, pfx_bignumber)))
+        return res;
+    return v.parse_string(temp.c_str(), 16);
+}
+
 game_error decoder::skip_padding() {
     while(_in.good() && _in.peek()==pfx_filler) {
         char c;
@@ -6,6 +6,7 @@
 #include "common.h"
 #include "blob.h"
 #include "bignumber.h"
+#include "money.h"
 
 namespace poker {
 
@@ -16,7 +17,12 @@ enum message_type {
     MSG_VSSHE_RESPONSE,
     MSG_BOB_PRIVATE_CARDS,
     MSG_BET_REQUEST,
-    MSG_CARD_PROOF
+    MSG_CARD_PROOF,
+    // short handshake
+    MSG_SHORT_VTMF,
+    MSG_SHORT_VTMF_RESPONSE,
+    MSG_ALICE_MIX,
+    MSG_ALICE_PRIVATE_CARDS
 };
 
 /*
@@ -34,6 +40,7 @@ public:
     game_error write(blob& v);
     game_error write(const std::string& v);
     game_error write(const bignumber& v);
+    game_error write(const money& v);
     game_error write(const char* v, int len, char pfx);
     game_error pad(int padding_size);
 };
@@ -49,6 +56,7 @@ public:
     game_error read(int& v);
     game_error read(bool& v);
     game_error read(bignumber& v);
+    game_error read(money& v);
     game_error read(message_type& v);
     game_error read(bet_type& v);
     game_error read(std::string& v);
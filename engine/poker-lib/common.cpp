@@ -4,7 +4,7 @@
 
 namespace poker {
 
-bool logging_enabled = false;
+std::atomic<bool> logging_enabled(false);
 
 game_error public_cards_range(game_step step, int& first_card_index, int& card_count) {
     switch(step) {
@@ -27,32 +27,23 @@ game_error public_cards_range(game_step step, int& first_card_index, int& card_c
 }
 
 game_error read_exactly(std::istream& in, int len, char* dst) {
-    char tmp[4096];
-    while(len) {
-        if (!in.good())
-            return END_OF_STREAM;
-        int chunk = std::min(len, (int)sizeof(tmp));
-        in.read(tmp, chunk);
-        auto actual = in.gcount();
-        if (!in.good() || actual==0)
-            return END_OF_STREAM;
-
-        memcpy(dst, tmp, actual);
-        dst += actual;
-        len -= actual;
-    }
+    if (!len)
+        return SUCCESS;
+    if (!in.good())
+        return END_OF_STREAM;
+    in.read(dst, len);
+    if (!in.good() || in.gcount() != len)
+        return END_OF_STREAM;
     return SUCCESS;
 }
 
 game_error read_exactly(std::istream& in, int len, std::string& dst) {
     game_error res;
-    std::shared_ptr<char> p(new char[len]);
-
-    if (( res = read_exactly(in, len, p.get())))
+    dst.resize(len);
+    if (( res = read_exactly(in, len, &dst[0]))) {
+      dst.clear();
       return res;
-    
-    dst = std::string(p.get(), len);
-
+    }
     return SUCCESS;
 }
 
@@ -1,13 +1,14 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#include <atomic>
 #include <iostream>
 
 #include "cards.h"
 
 namespace poker {
 
-extern bool logging_enabled;
+extern std::atomic<bool> logging_enabled;
 
 #define logger if(!logging_enabled) {} else std::cerr
 
@@ -25,6 +26,13 @@ const int NUM_CARDS = NUM_PUBLIC_CARDS + (NUM_PLAYERS * NUM_PRIVATE_CARDS);
 const int HAND_SIZE = NUM_PUBLIC_CARDS + NUM_PRIVATE_CARDS;
 const int DECK_SIZE = 52;
 
+// Protocol versions. A game is played at the version of Alice's first
+// message (see check_version()), so newer players still play older ones.
+const int poker_version = 0x010100;
+const int min_poker_version = 0x010000;
+// first version with the all-in runout, see referee::step_runout()
+const int runout_version = 0x010100;
+
 enum bet_type {
     BET_NONE = 0,
     BET_FOLD = 1,
@@ -52,6 +60,9 @@ enum game_step {
     RIVER_BET = 15,
     SHOWDOWN = 16,
     GAME_OVER = 17,
+    // short handshake, see set_short_handshake(): bob mixes first
+    BOB_FIRST_MIX = 18,
+    ALICE_LAST_MIX = 19,
 };
 
 enum game_error {
@@ -109,10 +120,15 @@ enum game_error {
     PRR_ALICE_MONEY_DIVERGES,
     PRR_BOB_MONEY_DIVERGES,
     PRR_BIG_BLIND_DIVERGES,
+    PRR_INVALID_SNAPSHOT,
+    PRR_BATCH_INTERRUPTED,
 
     // solver errors
     SRR_UNKNOWN_CARD = 300,
     SRR_DUPLICATE_CARD,
+    SRR_UNSUPPORTED_HAND_SIZE,
+    SRR_BACKEND_UNAVAILABLE,
+    SRR_INVALID_EQUITY_OPTIONS,
 
     // game_state errors
     GRR_INVALID_PLAYER = 400,
@@ -143,6 +159,7 @@ enum game_error {
     TMC_INVALID_CARD_INDEX,
     TMC_PROVE_CARD,
     TMC_RUNTIME_EXCEPTION,
+    TMC_INVALID_STATE,
 
     // Verifier
     VRF_INVALID_PLAYER_COUNT = 700,
@@ -156,6 +173,7 @@ enum game_error {
     BIG_UNPARSEABLE = 800,
     BIG_READ_ERROR,
     BIG_WRITE_ERROR,
+    BIG_OVERFLOW,
 
     // Compression
     CPR_COMPRESS_INIT = 900,
@@ -168,12 +186,38 @@ enum game_error {
     CPR_READ_ERROR,
     CPR_DATA_TOO_BIG,
     CPR_EOF,
+    CPR_INVALID_OPTIONS,
+    CPR_UNKNOWN_DICTIONARY,
+    CPR_UNEXPECTED_BATCH,
 
     // playback
     PLB_UNKNOWN_MSG_TYPE = 1000,
     PLB_CURRENT_PLAYER_MISMATCH,
     PLB_BAD_HANDSHAKE,
-    PLB_DECODE_ERROR
+    PLB_DECODE_ERROR,
+    PLB_INVALID_CHECKPOINT,
+    PLB_CHECKPOINT_SEEK,
+    PLB_FRAME_NOT_FOUND,
+
+    // C API
+    APR_TASK_NOT_FOUND = 1100,
+    APR_TASK_STARTED,
+    APR_CANCELLED,
+    APR_NO_COMPLETION,
+    APR_WORKERS_RUNNING,
+    APR_BUFFER_TOO_SMALL,
+    APR_NO_MESSAGE,
+    APR_WORKERS_STOPPING,
+    APR_WORKER_THREAD,
+    APR_MESSAGE_PENDING,
+
+    // host
+    HST_UNKNOWN_OP = 1200,
+    HST_TABLE_NOT_FOUND,
+    HST_TABLE_BUSY,
+    HST_FRAME_TOO_BIG,
+    HST_SOCKET_ERROR,
+    HST_CONNECTION_CLOSED
 
 };
 
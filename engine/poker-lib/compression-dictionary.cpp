@@ -0,0 +1,35 @@
+// Generated by make-dictionary from 4 games. Do not edit:
+// dictionaries are referenced by id from existing game logs.
+
+namespace poker {
+
+extern const unsigned char compression_dictionary_v1[];
+extern const unsigned int compression_dictionary_v1_len;
+
+const unsigned char compression_dictionary_v1[] = {
+    0x0a, 0x24, 0x34, 0x33, 0x33, 0x7c, 0x0a, 0x24, 0x39, 0x35, 0x34, 0x7c, 0x24, 0x30, 0x7c, 0x23,
+    0x31, 0x7c, 0x7c, 0x5e, 0x0a, 0x24, 0x39, 0x33, 0x36, 0x33, 0x7c, 0x7c, 0x5e, 0x0a, 0x24, 0x39,
+    0x33, 0x36, 0x36, 0x7c, 0x24, 0x34, 0x33, 0x33, 0x7c, 0x24, 0x31, 0x30, 0x33, 0x36, 0x7c, 0x23,
+    0x34, 0x7c, 0x23, 0x36, 0x35, 0x35, 0x33, 0x36, 0x7c, 0x23, 0x30, 0x7c, 0x24, 0x39, 0x35, 0x34,
+    0x7c, 0x24, 0x31, 0x34, 0x33, 0x31, 0x7c, 0x23, 0x35, 0x7c, 0x23, 0x36, 0x35, 0x35, 0x33, 0x36,
+    0x7c, 0x23, 0x31, 0x7c, 0x23, 0x33, 0x7c, 0x25, 0x31, 0x7c, 0x23, 0x36, 0x7c, 0x23, 0x36, 0x35,
+    0x35, 0x33, 0x36, 0x7c, 0x23, 0x30, 0x7c, 0x23, 0x32, 0x7c, 0x25, 0x31, 0x7c, 0x23, 0x36, 0x7c,
+    0x23, 0x36, 0x35, 0x35, 0x33, 0x36, 0x7c, 0x23, 0x31, 0x7c, 0x23, 0x32, 0x7c, 0x25, 0x31, 0x7c,
+    0x23, 0x32, 0x7c, 0x23, 0x36, 0x35, 0x35, 0x33, 0x36, 0x7c, 0x23, 0x30, 0x7c, 0x24, 0x32, 0x30,
+    0x30, 0x35, 0x34, 0x7c, 0x23, 0x33, 0x7c, 0x23, 0x36, 0x35, 0x35, 0x33, 0x36, 0x7c, 0x23, 0x31,
+    0x7c, 0x24, 0x33, 0x36, 0x31, 0x34, 0x36, 0x7c, 0x73, 0x74, 0x6b, 0x5e, 0x35, 0x32, 0x5e, 0x63,
+    0x72, 0x64, 0x7c, 0x24, 0x30, 0x7c, 0x23, 0x30, 0x7c, 0x23, 0x36, 0x35, 0x35, 0x33, 0x36, 0x7c,
+    0x23, 0x30, 0x7c, 0x25, 0x32, 0x7c, 0x23, 0x31, 0x7c, 0x23, 0x36, 0x35, 0x35, 0x33, 0x36, 0x7c,
+    0x23, 0x31, 0x7c, 0x25, 0x32, 0x7c, 0x0a, 0x23, 0x30, 0x7c, 0x24, 0x34, 0x37, 0x37, 0x7c, 0x23,
+    0x36, 0x7c, 0x23, 0x36, 0x35, 0x35, 0x33, 0x36, 0x7c, 0x23, 0x30, 0x7c, 0x23, 0x34, 0x7c, 0x25,
+    0x31, 0x7c, 0x23, 0x35, 0x7c, 0x23, 0x36, 0x35, 0x35, 0x33, 0x36, 0x7c, 0x23, 0x30, 0x7c, 0x23,
+    0x32, 0x7c, 0x25, 0x31, 0x7c, 0x23, 0x35, 0x7c, 0x23, 0x36, 0x35, 0x35, 0x33, 0x36, 0x7c, 0x23,
+    0x30, 0x7c, 0x23, 0x34, 0x7c, 0x25, 0x31, 0x7c, 0x23, 0x36, 0x7c, 0x23, 0x36, 0x35, 0x35, 0x33,
+    0x36, 0x7c, 0x23, 0x31, 0x7c, 0x23, 0x34, 0x7c, 0x25, 0x31, 0x7c, 0x23, 0x35, 0x7c, 0x23, 0x36,
+    0x35, 0x35, 0x33, 0x36, 0x7c, 0x23, 0x31, 0x7c, 0x23, 0x34, 0x7c, 0x25, 0x31, 0x7c, 0x7c, 0x5e,
+    0x63, 0x72, 0x64, 0x7c,
+};
+
+const unsigned int compression_dictionary_v1_len = 324;
+
+}  // namespace poker
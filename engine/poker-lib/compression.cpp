@@ -1,148 +1,602 @@
 #include <vector>
 #include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
 #include <brotli/decode.h>
 #include <brotli/encode.h>
 
 #include "compression.h"
 
-namespace poker {
+// The shared dictionary API appeared in brotli 1.1.0
+#if defined(__has_include)
+#if __has_include(<brotli/shared_dictionary.h>)
+#define POKER_BROTLI_DICTIONARY 1
+#endif
+#endif
 
-static BROTLI_BOOL compress_stream(BrotliEncoderState* enc, BrotliEncoderOperation op, std::vector<uint8_t>* output, uint8_t* input, size_t input_length);
-static BROTLI_BOOL decompress_stream(BrotliDecoderState* dec, std::vector<uint8_t>* output, uint8_t* input, size_t input_length);
+namespace poker {
 
+/*
+ * Frame header.
+ * The top byte of data_len carries the id of the dictionary the payload was
+ * compressed with. Legacy frames never exceed wrap_max_len, so it reads as
+ * NO_DICTIONARY for them.
+ */
 struct wrap_header {
   int32_t total_len;
   int32_t data_len;
 };
 
-std::string wrap(const std::string& data) {
+const int32_t wrap_length_mask = 0x00ffffff;
+const int wrap_dictionary_shift = 24;
+
+// options may be set again while other threads compress
+static std::atomic<int> compression_quality(BROTLI_DEFAULT_QUALITY);
+static std::atomic<int> compression_window(BROTLI_DEFAULT_WINDOW);
+static std::atomic<int> compression_dictionary(NO_DICTIONARY);
+static std::atomic<bool> compact_frames(false);
+
+// dictionaries by id, see compression-dictionary.cpp
+extern const unsigned char compression_dictionary_v1[];
+extern const unsigned int compression_dictionary_v1_len;
+
+static bool get_dictionary(int id, const uint8_t** data, size_t* size) {
+    switch(id) {
+        case 1:
+            *data = compression_dictionary_v1;
+            *size = compression_dictionary_v1_len;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Per-thread brotli context.
+ * Brotli 1.0.x cannot reset an encoder/decoder instance once a stream is
+ * flushed, so every message still gets a fresh state. What is reused is the
+ * memory behind it: the state allocations (ring buffers and hash tables, which
+ * are tens of MB at the default quality/window) are served from a per-thread
+ * block cache instead of going back to malloc/mmap on every message.
+ * A thread keeps a few MB of blocks of its own; larger ones, such as the hash
+ * tables of the top qualities, are only kept while the blocks cached beyond
+ * that by all threads fit a process-wide budget, so the memory held does not
+ * grow with the number of threads.
+ */
+class compression_context {
+    struct block_header {
+        size_t capacity;
+        size_t pad;  // keep the payload 16-byte aligned
+    };
+    std::vector<block_header*> _free;
+    size_t _cached;
+#ifdef POKER_BROTLI_DICTIONARY
+    // encoder-side dictionaries, prepared once per thread and quality
+    std::vector<BrotliEncoderPreparedDictionary*> _prepared;
+    int _prepared_quality;
+#endif
+
+    static const size_t thread_cached = 4 * 1024 * 1024;
+    static const size_t max_shared = 64 * 1024 * 1024;
+    // bytes cached beyond thread_cached, by all threads
+    static std::atomic<size_t> shared;
+
+    size_t excess() const { return _cached > thread_cached ? _cached - thread_cached : 0; }
+
+public:
+#ifdef POKER_BROTLI_DICTIONARY
+    compression_context() : _cached(0), _prepared(LATEST_DICTIONARY + 1), _prepared_quality(-1) { }
+#else
+    compression_context() : _cached(0) { }
+#endif
+    ~compression_context() {
+        shared -= excess();
+#ifdef POKER_BROTLI_DICTIONARY
+        for(auto d: _prepared)
+            if (d)
+                BrotliEncoderDestroyPreparedDictionary(d);
+#endif
+        for(auto b: _free)
+            ::free(b);
+    }
+
+#ifdef POKER_BROTLI_DICTIONARY
+    BrotliEncoderPreparedDictionary* prepared_dictionary(int id, int quality) {
+        if (quality != _prepared_quality) {
+            for(auto& d: _prepared)
+                if (d) {
+                    BrotliEncoderDestroyPreparedDictionary(d);
+                    d = NULL;
+                }
+            _prepared_quality = quality;
+        }
+        if (!_prepared[id]) {
+            const uint8_t* data;
+            size_t size;
+            if (!get_dictionary(id, &data, &size))
+                return NULL;
+            _prepared[id] = BrotliEncoderPrepareDictionary(BROTLI_SHARED_DICTIONARY_RAW, size, data, quality, NULL, NULL, NULL);
+        }
+        return _prepared[id];
+    }
+#endif
+
+    static compression_context& current() {
+        static thread_local compression_context ctx;
+        return ctx;
+    }
+
+    static void* alloc(void* opaque, size_t size) {
+        auto self = (compression_context*)opaque;
+        // best fit among cached blocks, ignoring ones more than twice as large
+        int best = -1;
+        for(int i = 0; i < (int)self->_free.size(); i++) {
+            auto cap = self->_free[i]->capacity;
+            if (cap >= size && cap <= 2 * size && (best < 0 || cap < self->_free[best]->capacity))
+                best = i;
+        }
+        block_header* b;
+        if (best >= 0) {
+            b = self->_free[best];
+            self->_free[best] = self->_free.back();
+            self->_free.pop_back();
+            auto before = self->excess();
+            self->_cached -= b->capacity;
+            shared -= before - self->excess();
+        } else {
+            b = (block_header*)::malloc(sizeof(block_header) + size);
+            if (!b)
+                return NULL;
+            b->capacity = size;
+        }
+        return b + 1;
+    }
+
+    static void release(void* opaque, void* address) {
+        if (!address)
+            return;
+        auto self = (compression_context*)opaque;
+        auto b = ((block_header*)address) - 1;
+        auto before = self->excess();
+        self->_cached += b->capacity;
+        auto added = self->excess() - before;
+        if (added && shared.fetch_add(added) + added > max_shared) {
+            shared -= added;
+            self->_cached -= b->capacity;
+            ::free(b);
+            return;
+        }
+        self->_free.push_back(b);
+    }
+};
+
+std::atomic<size_t> compression_context::shared(0);
+
+// RAII holders so that error paths do not leak brotli states
+struct encoder_instance {
+    BrotliEncoderState* state;
+    encoder_instance(compression_context& ctx)
+        : state(BrotliEncoderCreateInstance(compression_context::alloc, compression_context::release, &ctx)) { }
+    ~encoder_instance() { if (state) BrotliEncoderDestroyInstance(state); }
+};
+
+struct decoder_instance {
+    BrotliDecoderState* state;
+    decoder_instance(compression_context& ctx)
+        : state(BrotliDecoderCreateInstance(compression_context::alloc, compression_context::release, &ctx)) { }
+    ~decoder_instance() { if (state) BrotliDecoderDestroyInstance(state); }
+};
+
+game_error set_compression_options(int quality, int window, int dictionary) {
+    if (quality < BROTLI_MIN_QUALITY || quality > BROTLI_MAX_QUALITY)
+        return CPR_INVALID_OPTIONS;
+    if (window < BROTLI_MIN_WINDOW_BITS || window > BROTLI_MAX_WINDOW_BITS)
+        return CPR_INVALID_OPTIONS;
+    if (dictionary < NO_DICTIONARY || dictionary > LATEST_DICTIONARY)
+        return CPR_INVALID_OPTIONS;
+    compression_quality = quality;
+    compression_window = window;
+#ifdef POKER_BROTLI_DICTIONARY
+    compression_dictionary = dictionary;
+#else
+    // built against a brotli without shared dictionaries: frames stay plain
+    compression_dictionary = NO_DICTIONARY;
+#endif
+    return SUCCESS;
+}
+
+int default_compression_dictionary() {
+    return compression_dictionary;
+}
+
+void set_compact_frames(bool compact) {
+    compact_frames = compact;
+}
+
+std::string wrap(const std::string& data, int dictionary) {
     wrap_header hdr;
 
-    hdr.data_len = data.size();
-    hdr.total_len = sizeof(hdr) + hdr.data_len;
+    hdr.data_len = data.size() | (dictionary << wrap_dictionary_shift);
+    hdr.total_len = sizeof(hdr) + data.size();
 
-    auto pads = 0;
     auto mod = hdr.total_len % wrap_padding_size;
     if (mod != 0)
-      pads += (wrap_padding_size - mod);;    
-    hdr.total_len += pads;
+      hdr.total_len += (wrap_padding_size - mod);
+
+    std::string out(hdr.total_len, '\0');
+    memcpy(&out[0], &hdr, sizeof(hdr));
+    memcpy(&out[sizeof(hdr)], data.data(), data.size());
 
-    std::ostringstream os;
-    os.write((const char*)&hdr, sizeof(hdr));
-    os.write(data.data(), data.size());
-    for(; pads; pads--)
-      os.write("\0", 1);
+    return out;
+}
 
-    return os.str();
+std::string wrap_compact(const std::string& data, int dictionary, bool batch) {
+    std::string out(compact_header_size + data.size(), '\0');
+    out[0] = (char)(batch ? compact_batch_magic : compact_frame_magic);
+    out[1] = (char)dictionary;
+    for (int i = 0; i < 3; i++)
+        out[2 + i] = (char)(data.size() >> (8 * i));
+    memcpy(&out[compact_header_size], data.data(), data.size());
+    return out;
+}
+
+void pad_to_page(std::string& data) {
+    auto mod = data.size() % wrap_padding_size;
+    if (mod != 0)
+        data.append(wrap_padding_size - mod, '\0');
+}
+
+static bool is_compact_magic(int c) {
+    return c == compact_frame_magic || c == compact_batch_magic;
+}
+
+static int32_t compact_data_len(const unsigned char* hdr, int& dictionary, bool& batch) {
+    batch = hdr[0] == compact_batch_magic;
+    dictionary = hdr[1];
+    return hdr[2] | (hdr[3] << 8) | (hdr[4] << 16);
 }
 
 game_error unwrap(const std::string& in, std::string& out) {
+    int dictionary;
+    return unwrap(in, out, dictionary);
+}
+
+game_error unwrap(const std::string& in, std::string& out, int& dictionary) {
+    bool batch;
+    return unwrap(in, out, dictionary, batch);
+}
+
+game_error unwrap(const std::string& in, std::string& out, int& dictionary, bool& batch) {
     wrap_header hdr;
 
+    batch = false;
+    if (in.size() && is_compact_magic((unsigned char)in[0])) {
+        if (in.size() < (size_t)compact_header_size)
+            return CPR_INVALID_DATA_LENGTH;
+        int32_t data_len = compact_data_len((const unsigned char*)in.data(), dictionary, batch);
+        if (data_len > wrap_max_len)
+            return CPR_DATA_TOO_BIG;
+        if (in.size() < compact_header_size + (size_t)data_len)
+            return CPR_INSUFFICIENT_DATA;
+        out.assign(in, compact_header_size, data_len);
+        return SUCCESS;
+    }
+
     if (in.size() < sizeof(wrap_header))
         return CPR_INVALID_DATA_LENGTH;
 
-    std::istringstream is(in);
-    is.read((char*)&hdr, sizeof(hdr));
-    if (!is.good())
-        return CPR_READ_ERROR;
+    memcpy(&hdr, in.data(), sizeof(hdr));
+    int32_t data_len = hdr.data_len & wrap_length_mask;
+    dictionary = (uint32_t)hdr.data_len >> wrap_dictionary_shift;
 
-    if (hdr.data_len > wrap_max_len)
+    if (data_len > wrap_max_len)
       return CPR_DATA_TOO_BIG;
 
-    if (in.size() < sizeof(hdr) + hdr.data_len)
+    if (in.size() < sizeof(hdr) + data_len)
       return CPR_INSUFFICIENT_DATA;
-    
-    out = in.substr(sizeof(hdr), hdr.data_len);
+
+    out.assign(in, sizeof(hdr), data_len);
 
     return SUCCESS;
 }
 
-game_error compress(const std::string& in, std::string &out) {
-    std::vector<uint8_t> output;
-    
-    BrotliEncoderState* enc = BrotliEncoderCreateInstance(0, 0, 0);
-    if (!enc)
+game_error compress(const std::string& in, std::string &out, int dictionary) {
+    auto& ctx = compression_context::current();
+    encoder_instance enc(ctx);
+    if (!enc.state)
         return CPR_COMPRESS_INIT;
+    int quality = compression_quality;
+    if (!BrotliEncoderSetParameter(enc.state, BROTLI_PARAM_QUALITY, quality) ||
+        !BrotliEncoderSetParameter(enc.state, BROTLI_PARAM_LGWIN, compression_window))
+        return CPR_COMPRESS_INIT;
+    if (dictionary != NO_DICTIONARY) {
+#ifdef POKER_BROTLI_DICTIONARY
+        auto prepared = ctx.prepared_dictionary(dictionary, quality);
+        if (!prepared)
+            return CPR_UNKNOWN_DICTIONARY;
+        if (!BrotliEncoderAttachPreparedDictionary(enc.state, prepared))
+            return CPR_COMPRESS_INIT;
+#else
+        return CPR_UNKNOWN_DICTIONARY;
+#endif
+    }
 
-    auto in_size = in.size();
-    auto ok = compress_stream(enc, BROTLI_OPERATION_PROCESS, &output, (uint8_t*)in.data(), in.size());
-    if (ok != BROTLI_TRUE)
-        return CPR_COMPRESS;
+    // the bound holds for a finished stream, so a flushed one fits too
+    out.resize(BrotliEncoderMaxCompressedSize(in.size()) + 16);
+    size_t available_in = in.size();
+    const uint8_t* next_in = (const uint8_t*)in.data();
+    size_t available_out = out.size();
+    uint8_t* next_out = (uint8_t*)&out[0];
+
+    BrotliEncoderOperation op = BROTLI_OPERATION_PROCESS;
+    while (true) {
+        if (!BrotliEncoderCompressStream(enc.state, op, &available_in, &next_in, &available_out, &next_out, NULL))
+            return op == BROTLI_OPERATION_FLUSH ? CPR_COMPRESS_FLUSH : CPR_COMPRESS;
+        if (!available_out && BrotliEncoderHasMoreOutput(enc.state)) {
+            auto used = out.size();
+            out.resize(2 * used);
+            next_out = (uint8_t*)&out[used];
+            available_out = out.size() - used;
+            continue;
+        }
+        if (available_in)
+            continue;
+        if (op == BROTLI_OPERATION_PROCESS) {
+            op = BROTLI_OPERATION_FLUSH;
+            continue;
+        }
+        if (!BrotliEncoderHasMoreOutput(enc.state))
+            break;
+    }
+    out.resize(out.size() - available_out);
 
-    ok = compress_stream(enc, BROTLI_OPERATION_FLUSH, &output, NULL, 0);
-    if (ok != BROTLI_TRUE)
-        return CPR_COMPRESS_FLUSH;
+    return SUCCESS;
+}
+
+static game_error attach_dictionary(BrotliDecoderState* state, int dictionary) {
+    if (dictionary == NO_DICTIONARY)
+        return SUCCESS;
+#ifdef POKER_BROTLI_DICTIONARY
+    const uint8_t* data;
+    size_t size;
+    if (!get_dictionary(dictionary, &data, &size))
+        return CPR_UNKNOWN_DICTIONARY;
+    if (!BrotliDecoderAttachDictionary(state, BROTLI_SHARED_DICTIONARY_RAW, size, data))
+        return CPR_DECOMPRESS_INIT;
+    return SUCCESS;
+#else
+    return CPR_UNKNOWN_DICTIONARY;
+#endif
+}
 
-    BrotliEncoderDestroyInstance(enc);
+game_error decompress(const std::string& in, std::string &out, int dictionary) {
+    game_error res;
+    decoder_instance dec(compression_context::current());
+    if (!dec.state)
+        return CPR_DECOMPRESS_INIT;
+    if ((res=attach_dictionary(dec.state, dictionary)))
+        return res;
 
-    out = std::string(output.begin(), output.end());
-    //logger << "## --> compressed " << in_size << " -> " << out.size() << std::endl;
+    // messages are text-encoded and compress 3-6x, start from there and grow
+    out.resize(std::max<size_t>(4 * in.size(), 1024));
+    size_t available_in = in.size();
+    const uint8_t* next_in = (const uint8_t*)in.data();
+    size_t available_out = out.size();
+    uint8_t* next_out = (uint8_t*)&out[0];
+
+    BrotliDecoderResult result;
+    while (true) {
+        result = BrotliDecoderDecompressStream(dec.state, &available_in, &next_in, &available_out, &next_out, NULL);
+        // the decoder may report it needs input while output is still pending
+        if (result != BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT && !BrotliDecoderHasMoreOutput(dec.state))
+            break;
+        if (result == BROTLI_DECODER_RESULT_ERROR)
+            break;
+        if (!available_out) {
+            auto used = out.size();
+            out.resize(2 * used);
+            next_out = (uint8_t*)&out[used];
+            available_out = out.size() - used;
+        }
+    }
+    if (result == BROTLI_DECODER_RESULT_ERROR || available_in)
+        return CPR_DECOMPRESS;
+    out.resize(out.size() - available_out);
 
-    return SUCCESS; 
+    return SUCCESS;
 }
 
-game_error decompress(const std::string& in, std::string &out) {
-    std::vector<uint8_t> output;
-    
-    BrotliDecoderState* dec = BrotliDecoderCreateInstance(0, 0, 0);
-    if (!dec)
+game_error decompress_prefix(const std::string& in, std::string &out, size_t len, int dictionary) {
+    game_error res;
+    decoder_instance dec(compression_context::current());
+    if (!dec.state)
         return CPR_DECOMPRESS_INIT;
+    if ((res=attach_dictionary(dec.state, dictionary)))
+        return res;
 
-    auto ok = decompress_stream(dec, &output, (uint8_t*)in.data(), in.size());
-    if (ok != BROTLI_TRUE)
+    out.resize(len);
+    size_t available_in = in.size();
+    const uint8_t* next_in = (const uint8_t*)in.data();
+    size_t available_out = out.size();
+    uint8_t* next_out = (uint8_t*)&out[0];
+
+    // stops as soon as the output is full, leaving the rest of the stream alone
+    BrotliDecoderResult result;
+    do {
+        result = BrotliDecoderDecompressStream(dec.state, &available_in, &next_in, &available_out, &next_out, NULL);
+    } while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT && available_out);
+    if (result == BROTLI_DECODER_RESULT_ERROR)
         return CPR_DECOMPRESS;
+    out.resize(out.size() - available_out);
 
-    BrotliDecoderDestroyInstance(dec);
-
-    out = std::string(output.begin(), output.end());
-    // logger << "## --< decompressed " << in.size() << " -> " << out.size() << std::endl;
-    
-    return SUCCESS; 
+    return SUCCESS;
 }
 
 game_error compress_and_wrap(const std::string& in, std::string &out) {
     game_error res;
     std::string compressed;
-    if (in.size())
-        if ((res=compress(in, compressed)))
+    int dictionary = NO_DICTIONARY;
+    if (in.size()) {
+        dictionary = compression_dictionary;
+        if ((res=compress(in, compressed, dictionary)))
             return res;
-    out = wrap(compressed);
+    }
+    out = compact_frames ? wrap_compact(compressed, dictionary) : wrap(compressed, dictionary);
+    return SUCCESS;
+}
+
+/*
+ * Batch payload: each message preceded by its 32-bit length, all of them
+ * compressed as one brotli stream so later messages reuse the context of
+ * earlier ones.
+ */
+game_error compress_and_wrap_batch(const std::vector<std::string>& in, std::string &out) {
+    game_error res;
+    if (in.empty())
+        return CPR_INVALID_DATA_LENGTH;
+
+    std::string payload;
+    for(auto& msg: in) {
+        uint32_t len = msg.size();
+        payload.append((const char*)&len, sizeof(len));
+        payload += msg;
+    }
+    std::string compressed;
+    int dictionary = compression_dictionary;
+    if ((res=compress(payload, compressed, dictionary)))
+        return res;
+    out = wrap_compact(compressed, dictionary, true);
     return SUCCESS;
 }
 
+static game_error split_batch(const std::string& payload, std::vector<std::string>& out) {
+    out.clear();
+    size_t pos = 0;
+    while (pos < payload.size()) {
+        uint32_t len;
+        if (payload.size() - pos < sizeof(len))
+            return CPR_INVALID_DATA_LENGTH;
+        memcpy(&len, &payload[pos], sizeof(len));
+        pos += sizeof(len);
+        if (len > payload.size() - pos)
+            return CPR_INSUFFICIENT_DATA;
+        out.push_back(payload.substr(pos, len));
+        pos += len;
+    }
+    return SUCCESS;
+}
+
+static game_error decompress_frame(const std::string& compressed, int dictionary, bool batch, std::vector<std::string>& out) {
+    game_error res;
+    std::string payload;
+    if (compressed.size() && (res=decompress(compressed, payload, dictionary)))
+        return res;
+    if (batch)
+        return split_batch(payload, out);
+    out.assign(1, payload);
+    return SUCCESS;
+}
+
+game_error unwrap_and_decompress_batch(const std::string& in, std::vector<std::string> &out) {
+    game_error res;
+    std::string compressed;
+    int dictionary;
+    bool batch;
+    if ((res=unwrap(in, compressed, dictionary, batch)))
+        return res;
+    return decompress_frame(compressed, dictionary, batch, out);
+}
+
+game_error batch_frames(const std::vector<std::string>& frames, std::string &out) {
+    game_error res;
+    std::vector<std::string> messages, frame_messages;
+    for(auto& frame: frames) {
+        if ((res=unwrap_and_decompress_batch(frame, frame_messages)))
+            return res;
+        messages.insert(messages.end(), frame_messages.begin(), frame_messages.end());
+    }
+    return compress_and_wrap_batch(messages, out);
+}
+
 game_error unwrap_and_decompress(const std::string& in, std::string &out) {
     game_error res;
 
     std::string compressed;
-    if ((res=unwrap(in, compressed)))
+    int dictionary;
+    bool batch;
+    if ((res=unwrap(in, compressed, dictionary, batch)))
         return res;
+    if (batch)
+        return CPR_UNEXPECTED_BATCH;
 
     if (!compressed.size())
         out = compressed;
     else
-        if ((res=decompress(compressed, out)))
+        if ((res=decompress(compressed, out, dictionary)))
             return res;
     return SUCCESS;
 }
 
 game_error unwrap_next(std::istream& in, std::string& out) {
+    int dictionary;
+    return unwrap_next(in, out, dictionary);
+}
+
+// Consumes the zeros between a compact frame and the next page boundary.
+// When the stream position is unknown, nothing: the next frame may be a
+// padded one, whose header starts with a zero.
+static void skip_compact_padding(std::istream& in) {
+    std::streamoff pos = in.tellg();
+    if (pos < 0)
+        return;
+    std::streamoff pads = (wrap_padding_size - pos % wrap_padding_size) % wrap_padding_size;
+    auto buf = in.rdbuf();
+    while (pads && buf->sgetc() == 0) {
+        buf->sbumpc();
+        pads--;
+    }
+}
+
+game_error unwrap_next(std::istream& in, std::string& out, int& dictionary) {
+    bool batch;
+    return unwrap_next(in, out, dictionary, batch);
+}
+
+game_error unwrap_next(std::istream& in, std::string& out, int& dictionary, bool& batch) {
     game_error res;
     wrap_header hdr;
 
+    batch = false;
+    if (is_compact_magic(in.peek())) {
+        unsigned char compact[compact_header_size];
+        if ((res = read_exactly(in, compact_header_size, (char*)compact)))
+            return res;
+        int32_t data_len = compact_data_len(compact, dictionary, batch);
+        if (data_len > wrap_max_len)
+            return CPR_DATA_TOO_BIG;
+        if ((res = read_exactly(in, data_len, out)))
+            return res;
+        skip_compact_padding(in);
+        return SUCCESS;
+    }
+
     if ((res = read_exactly(in, sizeof(hdr), (char*)&hdr)))
         return res;
+    int32_t data_len = hdr.data_len & wrap_length_mask;
+    dictionary = (uint32_t)hdr.data_len >> wrap_dictionary_shift;
 
-    if (hdr.data_len > wrap_max_len)
+    if (data_len > wrap_max_len)
       return CPR_DATA_TOO_BIG;
 
-    if ((res = read_exactly(in, hdr.data_len, out)))
+    if ((res = read_exactly(in, data_len, out)))
         return res;
 
-    for (int pads = hdr.total_len - sizeof(hdr) - hdr.data_len; pads > 0; pads--) {
-      char tmp;
-      in.read(&tmp, 1);
-      if (!in.good())
+    std::streamsize pads = hdr.total_len - sizeof(hdr) - data_len;
+    if (pads > 0) {
+      in.ignore(pads);
+      if (in.gcount() != pads || !in.good())
         return CPR_READ_ERROR;
     }
 
@@ -152,63 +606,25 @@ game_error unwrap_next(std::istream& in, std::string& out) {
 game_error unwrap_and_decompress_next(std::istream& is, std::string &out) {
     game_error res;
     std::string compressed;
-    if ((res=unwrap_next(is, compressed)))
+    int dictionary;
+    bool batch;
+    if ((res=unwrap_next(is, compressed, dictionary, batch)))
         return res;
+    if (batch)
+        return CPR_UNEXPECTED_BATCH;
 
-    return decompress(compressed, out);
+    return decompress(compressed, out, dictionary);
 }
 
-static BROTLI_BOOL compress_stream(BrotliEncoderState* enc, BrotliEncoderOperation op, std::vector<uint8_t>* output, uint8_t* input, size_t input_length) {
-  BROTLI_BOOL ok = BROTLI_TRUE;
-
-  size_t available_in = input_length;
-  const uint8_t* next_in = input;
-  size_t available_out = 0;
-  uint8_t* next_out = NULL;
-
-  while (ok) {
-    ok = BrotliEncoderCompressStream(enc, op,
-                                     &available_in, &next_in,
-                                     &available_out, &next_out, NULL);
-    if (!ok)
-      break;
-
-    size_t buffer_length = 0; // Request all available output.
-    const uint8_t* buffer = BrotliEncoderTakeOutput(enc, &buffer_length);
-    if (buffer_length) {
-      (*output).insert((*output).end(), buffer, buffer + buffer_length);
-    }
-
-    if (available_in || BrotliEncoderHasMoreOutput(enc)) {
-      continue;
-    }
-
-    break;
-  }
-  return ok;
-}
-
-static BROTLI_BOOL decompress_stream(BrotliDecoderState* dec, std::vector<uint8_t>* output, uint8_t* input, size_t input_length) {
-  BROTLI_BOOL ok = BROTLI_TRUE;
-  size_t available_in = input_length;
-  const uint8_t* next_in = input;
-  size_t available_out = 0;
-  uint8_t* next_out = NULL;
-
-  BrotliDecoderResult result = BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT;
-  while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT) {
-    result = BrotliDecoderDecompressStream(dec,
-                                           &available_in, &next_in,
-                                           &available_out, &next_out, NULL);
-    size_t buffer_length = 0; // Request all available output.
-    const uint8_t* buffer = BrotliDecoderTakeOutput(dec, &buffer_length);
-    if (buffer_length) {
-      (*output).insert((*output).end(), buffer, buffer + buffer_length);
-    }
-  }
-  ok = result != BROTLI_DECODER_RESULT_ERROR && !available_in;
+game_error unwrap_and_decompress_next(std::istream& is, std::vector<std::string> &out) {
+    game_error res;
+    std::string compressed;
+    int dictionary;
+    bool batch;
+    if ((res=unwrap_next(is, compressed, dictionary, batch)))
+        return res;
 
-  return ok;
+    return decompress_frame(compressed, dictionary, batch, out);
 }
 
 }
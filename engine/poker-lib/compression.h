@@ -1,6 +1,7 @@
 #ifndef COMPRESSION_H
 #define COMPRESSION_H
 
+#include <vector>
 #include "common.h"
 
 namespace poker {
@@ -8,17 +9,60 @@ namespace poker {
 const int wrap_max_len = 1024 * 64;
 const int wrap_padding_size = 4096;
 
-std::string wrap(const std::string& data);
+/*
+ * Frame layouts.
+ * Padded frames carry an 8-byte header and are zero-padded to
+ * wrap_padding_size. Compact frames start with compact_frame_magic, then the
+ * dictionary id and a 3-byte little-endian payload length, with no padding.
+ * Readers accept both, and skip the zero padding found after a compact frame
+ * up to the next page boundary (turns start on one in the turns drive). That
+ * takes a stream reporting its position; on others, compact frames must be
+ * followed directly by the next frame.
+ * Batch frames are compact frames holding several messages of one player,
+ * see compress_and_wrap_batch().
+ */
+const unsigned char compact_frame_magic = 0xc7;
+const unsigned char compact_batch_magic = 0xc8;
+const int compact_header_size = 5;
+
+// Compression dictionaries. Ids are carried in the frame header and are
+// never reused, so logs written with any of them remain decodable.
+const int NO_DICTIONARY = 0;
+const int LATEST_DICTIONARY = 1;
+
+// Brotli quality (0-11), window bits (10-24) and dictionary used by compress_and_wrap()
+game_error set_compression_options(int quality, int window, int dictionary);
+int default_compression_dictionary();
+// Frame layout used by compress_and_wrap()
+void set_compact_frames(bool compact);
+
+std::string wrap(const std::string& data, int dictionary = NO_DICTIONARY);
+std::string wrap_compact(const std::string& data, int dictionary = NO_DICTIONARY, bool batch = false);
+// Zero-pads data to the next page boundary, as the turns drive lays out turns
+void pad_to_page(std::string& data);
 game_error unwrap(const std::string& in, std::string& out);
+game_error unwrap(const std::string& in, std::string& out, int& dictionary);
+game_error unwrap(const std::string& in, std::string& out, int& dictionary, bool& batch);
 
-game_error compress(const std::string& in, std::string &out);
-game_error decompress(const std::string& in, std::string &out);
+game_error compress(const std::string& in, std::string &out, int dictionary = NO_DICTIONARY);
+game_error decompress(const std::string& in, std::string &out, int dictionary = NO_DICTIONARY);
+// Decompresses no more than the first len bytes, e.g. to peek at a message header
+game_error decompress_prefix(const std::string& in, std::string &out, size_t len, int dictionary = NO_DICTIONARY);
 
 game_error compress_and_wrap(const std::string& in, std::string &out);
 game_error unwrap_and_decompress(const std::string& in, std::string &out);
 
+// Several messages in a single frame; unwrapping also accepts single-message frames
+game_error compress_and_wrap_batch(const std::vector<std::string>& in, std::string &out);
+game_error unwrap_and_decompress_batch(const std::string& in, std::vector<std::string> &out);
+// The messages of consecutive frames of one player, batch or not, in one batch frame
+game_error batch_frames(const std::vector<std::string>& frames, std::string &out);
+
 game_error unwrap_next(std::istream& in, std::string& out);
+game_error unwrap_next(std::istream& in, std::string& out, int& dictionary);
+game_error unwrap_next(std::istream& in, std::string& out, int& dictionary, bool& batch);
 game_error unwrap_and_decompress_next(std::istream& is, std::string &out);
+game_error unwrap_and_decompress_next(std::istream& is, std::vector<std::string> &out);
 
 }
 
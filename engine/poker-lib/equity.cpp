@@ -0,0 +1,259 @@
+#include "equity.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "hand-evaluator.h"
+#ifdef POKER_THREADS
+#include <thread>
+#endif
+
+namespace poker {
+
+static const int deck_size = 52;
+// outcomes enumerated at most; the turn and river have at most 45540
+static const long long exhaustive_limit = 100000;
+// Monte Carlo samples are drawn in batches, each from a random stream of its
+// own, and the precision is checked after every round of batches. Neither
+// depends on the number of threads, so neither does the result.
+static const int batch_size = 4096;
+static const int round_batches = 16;
+
+namespace {
+
+struct tally {
+    long long win, tie, loss;
+    tally() : win(0), tie(0), loss(0) {}
+};
+
+// What is known of a deal, and the cards left to complete it
+struct deal {
+    uint64_t hand;      // the hand and the board so far
+    uint64_t opponent;  // the opponent's known cards and the board so far
+    int board_missing;
+    int opponent_missing;
+    std::vector<card_t> deck;
+};
+
+// Rates the hands of a showdown in blocks, so they go through the batch evaluator
+class showdowns {
+    static const int block = 512;
+    uint64_t _hands[2 * block];  // hand, then opponent
+    unsigned short _ratings[2 * block];
+    int _count;
+    tally& _t;
+
+public:
+    showdowns(tally& t) : _count(0), _t(t) {}
+    ~showdowns() { flush(); }
+
+    void add(uint64_t hand, uint64_t opponent) {
+        _hands[2 * _count] = hand;
+        _hands[2 * _count + 1] = opponent;
+        if (++_count == block)
+            flush();
+    }
+
+    void flush() {
+        if (!evaluate_hands_avx2(_hands, 2 * _count, _ratings))
+            evaluate_hands_scalar(_hands, 2 * _count, _ratings);
+        for (int i = 0; i < _count; i++) {
+            if (_ratings[2 * i] > _ratings[2 * i + 1])
+                _t.win++;
+            else if (_ratings[2 * i] < _ratings[2 * i + 1])
+                _t.loss++;
+            else
+                _t.tie++;
+        }
+        _count = 0;
+    }
+};
+
+// splitmix64: small, fast and the same on every platform
+class random_stream {
+    uint64_t _state;
+
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+public:
+    random_stream(uint64_t seed, uint64_t stream) : _state(mix(seed + mix(stream + 1))) {}
+
+    uint64_t next() {
+        _state += 0x9e3779b97f4a7c15ULL;
+        return mix(_state);
+    }
+};
+
+}  // namespace
+
+static long long combinations(int n, int k) {
+    long long c = 1;
+    for (int i = 0; i < k; i++)
+        c = c * (n - i) / (i + 1);
+    return c;
+}
+
+// calls f with the mask of every set of k cards of the deck that are not used
+template <typename F>
+static void for_each_combination(const std::vector<card_t>& deck, size_t from, int k, uint64_t used, uint64_t mask,
+                                 const F& f) {
+    if (!k) {
+        f(mask);
+        return;
+    }
+    for (size_t i = from; i + k <= deck.size(); i++) {
+        uint64_t bit = (uint64_t)1 << deck[i];
+        if (!(used & bit))
+            for_each_combination(deck, i + 1, k - 1, used, mask | bit, f);
+    }
+}
+
+static void enumerate(const deal& d, tally& t) {
+    showdowns s(t);
+    for_each_combination(d.deck, 0, d.board_missing, 0, 0, [&](uint64_t board) {
+        for_each_combination(d.deck, 0, d.opponent_missing, board, 0, [&](uint64_t opponent) {
+            s.add(d.hand | board, d.opponent | board | opponent);
+        });
+    });
+}
+
+static void sample_batch(const deal& d, uint64_t seed, long long batch, int samples, tally& t) {
+    random_stream rnd(seed, (uint64_t)batch);
+    std::vector<card_t> deck(d.deck);
+    int n = (int)deck.size();
+    showdowns s(t);
+    for (int i = 0; i < samples; i++) {
+        // the first cards of a partial shuffle: the board, then the opponent's
+        uint64_t board = 0, opponent = 0;
+        for (int j = 0; j < d.board_missing + d.opponent_missing; j++) {
+            int k = j + (int)(rnd.next() % (uint64_t)(n - j));
+            std::swap(deck[j], deck[k]);
+            (j < d.board_missing ? board : opponent) |= (uint64_t)1 << deck[j];
+        }
+        s.add(d.hand | board, d.opponent | board | opponent);
+    }
+}
+
+static int thread_count(int requested) {
+#ifdef POKER_THREADS
+    if (requested > 0)
+        return requested;
+    int n = (int)std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+#else
+    return 1;
+#endif
+}
+
+static void sample(const deal& d, const equity_options& opts, tally& total) {
+    long long batches = (opts.max_samples + batch_size - 1) / batch_size;
+    int threads = thread_count(opts.threads);
+    for (long long first = 0; first < batches; first += round_batches) {
+        int count = (int)std::min<long long>(round_batches, batches - first);
+        std::vector<tally> tallies(count);
+        auto work = [&](int worker, int workers) {
+            for (int i = worker; i < count; i += workers) {
+                long long b = first + i;
+                int samples = (int)std::min<long long>(batch_size, opts.max_samples - b * batch_size);
+                sample_batch(d, opts.seed, b, samples, tallies[i]);
+            }
+        };
+        int workers = std::min(threads, count);
+#ifdef POKER_THREADS
+        std::vector<std::thread> pool;
+        for (int w = 1; w < workers; w++)
+            pool.emplace_back(work, w, workers);
+        work(0, workers);
+        for (auto& t : pool)
+            t.join();
+#else
+        work(0, workers);
+#endif
+        for (auto& t : tallies) {
+            total.win += t.win;
+            total.tie += t.tie;
+            total.loss += t.loss;
+        }
+
+        // standard error of the equity, a tie counting half
+        double n = (double)(total.win + total.tie + total.loss);
+        double equity = (total.win + total.tie / 2.0) / n;
+        double square = (total.win + total.tie / 4.0) / n;
+        if (opts.precision > 0 && std::sqrt(std::max(0.0, square - equity * equity) / n) <= opts.precision)
+            break;
+    }
+}
+
+static game_error add_card(card_t card, uint64_t& seen, uint64_t& mask) {
+    if (card < 0 || card >= deck_size)
+        return SRR_UNKNOWN_CARD;
+    uint64_t bit = (uint64_t)1 << card;
+    if (seen & bit)
+        return SRR_DUPLICATE_CARD;
+    seen |= bit;
+    mask |= bit;
+    return SUCCESS;
+}
+
+game_error compute_equity(const card_t* hand, const card_t* opponent, const card_t* board, int board_size,
+                          const equity_options& opts, equity_result& result) {
+    game_error res;
+    if (board_size != 0 && (board_size < 3 || board_size > NUM_PUBLIC_CARDS))
+        return SRR_UNSUPPORTED_HAND_SIZE;
+    if (opts.max_samples <= 0 || opts.precision < 0 || opts.threads < 0)
+        return SRR_INVALID_EQUITY_OPTIONS;
+
+    deal d;
+    d.hand = d.opponent = 0;
+    d.board_missing = NUM_PUBLIC_CARDS - board_size;
+    d.opponent_missing = 0;
+    uint64_t seen = 0, known_board = 0;
+    for (int i = 0; i < NUM_PRIVATE_CARDS; i++)
+        if ((res = add_card(hand[i], seen, d.hand)))
+            return res;
+    for (int i = 0; i < NUM_PRIVATE_CARDS; i++) {
+        if (opponent[i] == cards::uk)
+            d.opponent_missing++;
+        else if ((res = add_card(opponent[i], seen, d.opponent)))
+            return res;
+    }
+    for (int i = 0; i < board_size; i++)
+        if ((res = add_card(board[i], seen, known_board)))
+            return res;
+    d.hand |= known_board;
+    d.opponent |= known_board;
+    for (int c = 0; c < deck_size; c++)
+        if (!(seen & (uint64_t)1 << c))
+            d.deck.push_back((card_t)c);
+
+    tally t;
+    long long outcomes = combinations((int)d.deck.size(), d.board_missing) *
+                         combinations((int)d.deck.size() - d.board_missing, d.opponent_missing);
+    result.exact = outcomes <= exhaustive_limit;
+    if (result.exact)
+        enumerate(d, t);
+    else
+        sample(d, opts, t);
+
+    result.samples = t.win + t.tie + t.loss;
+    result.win = (double)t.win / result.samples;
+    result.tie = (double)t.tie / result.samples;
+    result.loss = (double)t.loss / result.samples;
+    return SUCCESS;
+}
+
+game_error compute_equity(const game_state& g, int player, const equity_options& opts, equity_result& result) {
+    if (player != ALICE && player != BOB)
+        return GRR_INVALID_PLAYER;
+    int board_size = 0;
+    while (board_size < NUM_PUBLIC_CARDS && g.public_cards[board_size] != cards::uk)
+        board_size++;
+    return compute_equity(g.players[player].cards, g.players[1 - player].cards, g.public_cards, board_size,
+                          opts, result);
+}
+
+}  // namespace poker
@@ -0,0 +1,47 @@
+#ifndef EQUITY_H
+#define EQUITY_H
+
+#include <cstdint>
+#include "common.h"
+#include "game-state.h"
+
+namespace poker {
+
+/*
+ * Heads-up equity: how often a hand wins, ties and loses at showdown against
+ * an opponent whose cards may be unknown, once the board is complete.
+ * Outcomes are enumerated exhaustively when there are few of them (always on
+ * the turn and river), otherwise sampled by Monte Carlo. Hands are rated by
+ * the built-in evaluator (hand-evaluator.h), whatever the solver backend.
+ */
+
+struct equity_options {
+    equity_options() : max_samples(1000000), precision(0.001), seed(1), threads(0) {}
+
+    // Monte Carlo only
+    int max_samples;
+    double precision;   // stops once the standard error of the equity is below this; 0 never stops early
+    uint64_t seed;      // same seed, same result, whatever the number of threads
+    int threads;        // 0 for one per hardware thread; ignored without POKER_THREADS
+};
+
+struct equity_result {
+    double win;
+    double tie;
+    double loss;
+    long long samples;  // outcomes counted
+    bool exact;         // every outcome was enumerated
+};
+
+// Equity of a hand, the opponent's cards being cards::uk when unknown, on a
+// board of 0, 3, 4 or 5 cards
+game_error compute_equity(const card_t* hand, const card_t* opponent, const card_t* board, int board_size,
+                          const equity_options& opts, equity_result& result);
+
+// Equity of a player from the cards known in a game: its own, the public
+// cards opened so far, and the opponent's once shown
+game_error compute_equity(const game_state& g, int player, const equity_options& opts, equity_result& result);
+
+}  // namespace poker
+
+#endif  // EQUITY_H
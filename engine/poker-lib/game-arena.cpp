@@ -0,0 +1,277 @@
+#include "game-arena.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <gmp.h>
+#ifdef POKER_THREADS
+#include <mutex>
+#endif
+
+namespace poker {
+
+// Chunks are aligned to granules, so the owner of a block is found from its address
+static const size_t granule_size = 1024 * 1024;
+static const size_t alignment = 16;
+static const size_t max_class_size = 4096;
+// larger blocks get a chunk of their own
+static const size_t max_shared_size = granule_size / 4;
+
+static std::atomic<bool> arenas_enabled(false);
+#ifdef POKER_THREADS
+static std::once_flag gmp_allocator_installed;
+#else
+static bool gmp_allocator_installed = false;
+#endif
+static thread_local game_arena* current_arena = NULL;
+static thread_local allocation_counters counters = {0, 0};
+
+/*
+ * Granule address -> arena, looked up on every free without a lock: an open
+ * addressing table whose slots are published by their key. Chunks come and
+ * go with their arenas only, so the writers take a lock. A removed key
+ * leaves a tombstone, reused by later insertions; a lookup racing with one
+ * is of a block whose arena is gone, which no caller may free.
+ */
+static const size_t registry_size = 1 << 16;  // granules, i.e. 64GB of arenas
+static const uintptr_t empty_key = 0;
+static const uintptr_t removed_key = 1;
+struct registry_slot {
+    std::atomic<uintptr_t> key;
+    std::atomic<game_arena*> arena;
+};
+static registry_slot registry[registry_size];
+static std::atomic<size_t> registered(0);
+#ifdef POKER_THREADS
+static std::mutex registry_lock;
+#define LOCK_REGISTRY() std::lock_guard<std::mutex> lock(registry_lock)
+#else
+#define LOCK_REGISTRY()
+#endif
+
+static size_t registry_hash(uintptr_t granule) {
+    return (size_t)((granule / granule_size) * 0x9e3779b97f4a7c15ull) & (registry_size - 1);
+}
+
+static registry_slot* find_slot(uintptr_t granule) {
+    for (size_t i = registry_hash(granule), n = 0; n < registry_size; i = (i + 1) & (registry_size - 1), n++) {
+        auto key = registry[i].key.load(std::memory_order_acquire);
+        if (key == granule)
+            return &registry[i];
+        if (key == empty_key)
+            return NULL;
+    }
+    return NULL;
+}
+
+// called with the registry locked
+static void register_granule(uintptr_t granule, game_arena* arena) {
+    for (size_t i = registry_hash(granule), n = 0; n < registry_size; i = (i + 1) & (registry_size - 1), n++) {
+        auto key = registry[i].key.load(std::memory_order_relaxed);
+        if (key == empty_key || key == removed_key) {
+            registry[i].arena.store(arena, std::memory_order_relaxed);
+            registry[i].key.store(granule, std::memory_order_release);
+            return;
+        }
+    }
+    fprintf(stderr, "game arenas hold more than %lu granules\n", (unsigned long)registry_size);
+    abort();
+}
+
+// called with the registry locked
+static void unregister_granule(uintptr_t granule) {
+    if (auto slot = find_slot(granule))
+        slot->key.store(removed_key, std::memory_order_release);
+}
+
+static size_t round_up(size_t size, size_t to) {
+    return size ? (size + to - 1) & ~(to - 1) : to;
+}
+
+static void* heap_allocate(size_t size) {
+    void* p = ::malloc(size);
+    if (!p && size) {
+        fprintf(stderr, "out of memory allocating %lu bytes\n", (unsigned long)size);
+        abort();
+    }
+    return p;
+}
+
+game_arena::game_arena() : _next(NULL), _end(NULL), _free(max_class_size / alignment, NULL), _stats{0, 0, 0} {
+}
+
+game_arena::~game_arena() {
+    if (_chunks.empty())
+        return;
+    {
+        LOCK_REGISTRY();
+        for (auto& c : _chunks)
+            for (size_t g = 0; g < c.size; g += granule_size)
+                unregister_granule((uintptr_t)(c.base + g));
+    }
+    for (auto& c : _chunks) {
+        registered -= c.size / granule_size;
+        ::free(c.raw);
+    }
+}
+
+char* game_arena::new_chunk(size_t size) {
+    chunk c;
+    c.size = round_up(size, granule_size);
+    c.raw = (char*)heap_allocate(c.size + granule_size);
+    c.base = (char*)round_up((uintptr_t)c.raw, granule_size);
+    {
+        LOCK_REGISTRY();
+        for (size_t g = 0; g < c.size; g += granule_size)
+            register_granule((uintptr_t)(c.base + g), this);
+    }
+    registered += c.size / granule_size;
+    _chunks.push_back(c);
+    _stats.reserved += c.size;
+    return c.base;
+}
+
+void* game_arena::allocate(size_t size) {
+    size = round_up(size, alignment);
+    _stats.allocations++;
+    if (size <= max_class_size) {
+        auto& head = _free[size / alignment - 1];
+        if (head) {
+            auto b = head;
+            head = b->next;
+            _stats.reused++;
+            return b;
+        }
+    } else {
+        for (size_t i = 0; i < _large.size(); i++) {
+            if (_large_sizes[i] != size)
+                continue;
+            auto b = _large[i];
+            _large[i] = _large.back();
+            _large_sizes[i] = _large_sizes.back();
+            _large.pop_back();
+            _large_sizes.pop_back();
+            _stats.reused++;
+            return b;
+        }
+        if (size > max_shared_size)
+            return new_chunk(size);
+    }
+    if ((size_t)(_end - _next) < size) {
+        _next = new_chunk(granule_size);
+        _end = _next + granule_size;
+    }
+    auto p = _next;
+    _next += size;
+    return p;
+}
+
+void game_arena::release(void* p, size_t size) {
+    size = round_up(size, alignment);
+    auto b = (free_block*)p;
+    if (size <= max_class_size) {
+        auto& head = _free[size / alignment - 1];
+        b->next = head;
+        head = b;
+    } else {
+        _large.push_back(b);
+        _large_sizes.push_back(size);
+    }
+}
+
+game_arena* game_arena::current() {
+    return current_arena;
+}
+
+game_arena* game_arena::owner(const void* p) {
+    if (!registered || !p)
+        return NULL;
+    auto slot = find_slot((uintptr_t)p & ~(uintptr_t)(granule_size - 1));
+    return slot ? slot->arena.load(std::memory_order_relaxed) : NULL;
+}
+
+arena_scope::arena_scope(game_arena& arena) : _previous(current_arena) {
+    if (arenas_enabled)
+        current_arena = &arena;
+}
+
+arena_scope::~arena_scope() {
+    current_arena = _previous;
+}
+
+void* arena_allocate(size_t size) {
+    if (auto arena = current_arena)
+        return arena->allocate(size);
+    return ::operator new(size);
+}
+
+// blocks of other arenas are left for them to release at once
+void arena_free(void* p, size_t size) {
+    auto arena = game_arena::owner(p);
+    if (!arena)
+        ::operator delete(p);
+    else if (arena == current_arena)
+        arena->release(p, size);
+}
+
+static void* gmp_allocate(size_t size) {
+    if (auto arena = current_arena) {
+        counters.arena++;
+        return arena->allocate(size);
+    }
+    counters.heap++;
+    return heap_allocate(size);
+}
+
+static void gmp_free(void* p, size_t size) {
+    auto arena = game_arena::owner(p);
+    if (!arena)
+        ::free(p);
+    else if (arena == current_arena)
+        arena->release(p, size);
+}
+
+// heap blocks stay on the heap, e.g. a caller's bignumber set inside a scope
+static void* gmp_reallocate(void* p, size_t old_size, size_t new_size) {
+    if (!game_arena::owner(p)) {
+        void* q = ::realloc(p, new_size);
+        if (!q && new_size) {
+            fprintf(stderr, "out of memory allocating %lu bytes\n", (unsigned long)new_size);
+            abort();
+        }
+        return q;
+    }
+    void* q = gmp_allocate(new_size);
+    memcpy(q, p, old_size < new_size ? old_size : new_size);
+    gmp_free(p, old_size);
+    return q;
+}
+
+static void install_gmp_allocator() {
+    mp_set_memory_functions(gmp_allocate, gmp_reallocate, gmp_free);
+}
+
+void use_game_arenas(bool enable) {
+#ifdef POKER_THREADS
+    std::call_once(gmp_allocator_installed, install_gmp_allocator);
+#else
+    if (!gmp_allocator_installed) {
+        install_gmp_allocator();
+        gmp_allocator_installed = true;
+    }
+#endif
+    arenas_enabled = enable;
+}
+
+bool game_arenas_enabled() {
+    return arenas_enabled;
+}
+
+allocation_counters& thread_allocation_counters() {
+    return counters;
+}
+
+}  // namespace poker
@@ -0,0 +1,101 @@
+#ifndef GAME_ARENA_H
+#define GAME_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+namespace poker {
+
+/*
+ * Per-game memory arena.
+ * A game makes many short-lived allocations: GMP limbs for every bignumber
+ * and for the libTMCG proofs, and a message object per decoded message.
+ * While a thread is inside an arena_scope these are served from large chunks
+ * with per-size free lists, and all of them are released at once when the
+ * arena is destroyed with its game.
+ *
+ * GMP's allocator is process wide: use_game_arenas() replaces it once with
+ * one that dispatches on the calling thread's arena, and falls back to
+ * malloc outside of a scope. Blocks keep their origin when reallocated or
+ * freed, so objects may move between arenas and the heap, but nothing
+ * allocated inside a scope may outlive its arena. An arena serves one thread
+ * at a time.
+ */
+
+struct arena_stats {
+    unsigned long long allocations;  // blocks handed out
+    unsigned long long reused;       // of which taken from the free lists
+    size_t reserved;                 // bytes of chunks held
+};
+
+// GMP allocations made through the replaced allocator on the calling thread
+struct allocation_counters {
+    unsigned long long heap;
+    unsigned long long arena;
+};
+
+class game_arena {
+    struct chunk {
+        char* raw;
+        char* base;
+        size_t size;
+    };
+    struct free_block {
+        free_block* next;
+    };
+
+    std::vector<chunk> _chunks;
+    char* _next;
+    char* _end;
+    std::vector<free_block*> _free;  // by size class
+    std::vector<free_block*> _large;  // blocks above the largest class, first fit
+    std::vector<size_t> _large_sizes;
+    arena_stats _stats;
+
+    char* new_chunk(size_t size);
+
+public:
+    game_arena();
+    ~game_arena();
+    game_arena(const game_arena&) = delete;
+    game_arena& operator=(const game_arena&) = delete;
+
+    void* allocate(size_t size);
+    // returns a block of this arena, size as passed to allocate()
+    void release(void* p, size_t size);
+    const arena_stats& stats() const { return _stats; }
+
+    // arena of the calling thread's innermost scope, NULL outside of one
+    static game_arena* current();
+    // arena holding p, NULL for memory from elsewhere
+    static game_arena* owner(const void* p);
+
+    friend class arena_scope;
+};
+
+/*
+ * Makes an arena the calling thread's current one until destroyed.
+ * Does nothing while arenas are not in use.
+ */
+class arena_scope {
+    game_arena* _previous;
+
+public:
+    arena_scope(game_arena& arena);
+    ~arena_scope();
+    arena_scope(const arena_scope&) = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
+};
+
+// Turns arenas on or off; the first call installs the GMP allocator
+void use_game_arenas(bool enable);
+bool game_arenas_enabled();
+allocation_counters& thread_allocation_counters();
+
+// Allocation through the current arena, if any, for class-specific operator new/delete
+void* arena_allocate(size_t size);
+void arena_free(void* p, size_t size);
+
+}  // namespace poker
+
+#endif
@@ -1,7 +1,10 @@
 #include "game-generator.h"
 
+#include <algorithm>
 #include <array>
 
+#include "compression.h"
+
 namespace poker {
 
 void game_generator::push_turn(const char* label, int player, const std::string& msg, int next_player, const money_t& stake) {
@@ -9,20 +12,48 @@ void game_generator::push_turn(const char* label, int player, const std::string&
   turns.push_back({player, msg, next_player, stake});
 }
 
+// Each run of turns by the same sender becomes one turn: a batch frame with
+// the stake of its first turn and the next sender of its last one.
+game_error game_generator::merge_consecutive_turns() {
+    game_error res;
+    std::vector<std::tuple<int, std::string, int, money_t>> merged;
+    for(size_t i = 0; i < turns.size(); ) {
+        size_t j = i + 1;
+        while (j < turns.size() && std::get<0>(turns[j]) == std::get<0>(turns[i]))
+            j++;
+        if (j == i + 1) {
+            merged.push_back(turns[i++]);
+            continue;
+        }
+        auto first = turns[i];
+        std::vector<std::string> frames;
+        for(; i < j; i++)
+            frames.push_back(std::get<1>(turns[i]));
+        std::string frame;
+        if ((res = batch_frames(frames, frame)))
+            return res;
+        merged.push_back(std::make_tuple(std::get<0>(first), frame, std::get<2>(turns[j - 1]), std::get<3>(first)));
+    }
+    turns = merged;
+    return SUCCESS;
+}
+
 game_error game_generator::generate() {
     game_error res;
-    std::array<player,2> players{ player(ALICE), player(BOB) };
+    // players own their game arenas, so they are not copied around
+    player alice(ALICE), bob(BOB);
+    std::array<player*,2> players{ {&alice, &bob} };
     int p, np; // player next player
     std::string msg1, msg2;
     money_t stake;
 
-    for (auto& p : players)
-        if ((res = p.init(alice_money, bob_money, big_blind)))
+    for (auto p : players)
+        if ((res = p->init(alice_money, bob_money, big_blind)))
             return res;
 
     // Handshake
-    stake = players[ALICE].game().players[ALICE].bets;
-    if ((res = players[ALICE].create_handshake(msg1)))
+    stake = players[ALICE]->game().players[ALICE].bets;
+    if ((res = players[ALICE]->create_handshake(msg1)))
       return res;
     push_turn("create_handshake", ALICE, msg1, BOB, stake);
       
@@ -30,31 +61,33 @@ game_error game_generator::generate() {
     p = BOB;
     while (msg1.size()) {
       logger << "\nHANDSHAKE p=" << p << std::endl;
-      stake = players[p].game().players[p].bets;
+      stake = players[p]->game().players[p].bets;
       msg2.clear();
-      r[p] = players[p].process_handshake(msg1, msg2);
+      r[p] = players[p]->process_handshake(msg1, msg2);
       if (r[p] != SUCCESS && r[p] != CONTINUED)
         return r[p];
       if (msg2.size()) {
-        push_turn("handshake", p, msg2, players[p].game().next_msg_author, stake);
+        push_turn("handshake", p, msg2, players[p]->game().next_msg_author, stake);
       }
 
       p = opponent_id(p);
       msg1 = msg2;
     }
 
-    if (p != ALICE)
+    // alice opens the betting, whichever handshake was played
+    if (players[ALICE]->step() != game_step::PREFLOP_BET || players[BOB]->step() != game_step::PREFLOP_BET)
       return PLB_BAD_HANDSHAKE;
+    p = ALICE;
 
     // bets
     auto t = BET_CALL;
-    auto amount = 0;
+    money_t amount = 0;
     auto did_raise = false;
 
-    while (!players[ALICE].game_over() && !players[BOB].game_over()) {
-        if (!players[p].game_over()) {
+    while (!players[ALICE]->game_over() && !players[BOB]->game_over()) {
+        if (!players[p]->game_over()) {
             r = {CONTINUED, CONTINUED};
-            if (last_aggressor >= 0 && players[p].game().phase == bet_phase::PHS_RIVER) {
+            if (last_aggressor >= 0 && players[p]->game().phase == bet_phase::PHS_RIVER) {
                 logger << "-=> player " << p << " AAA" << std::endl;
                 if (p == last_aggressor) {
                     logger << "-=> player " << p << " RAISE" << std::endl;
@@ -70,32 +103,38 @@ game_error game_generator::generate() {
                     t = BET_CHECK;
                 }
             }
-            stake = players[p].game().players[p].bets;
-            r[p] = players[p].create_bet(t, amount, msg1);
+            if (all_in && players[p]->game().phase == bet_phase::PHS_PREFLOP) {
+                t = p == ALICE ? BET_RAISE : BET_CALL;
+                amount = 0;
+                if (p == ALICE && !checked_sub(std::min(alice_money, bob_money), big_blind, amount))
+                    return GRR_BET_ABOVE_MAXIMUM;
+            }
+            stake = players[p]->game().players[p].bets;
+            r[p] = players[p]->create_bet(t, amount, msg1);
             logger << "\n== " << p << " CREATE BET: " << r[p] << "\n";
             if (r[p] != SUCCESS && r[p] != CONTINUED)
                 return r[p];
-            push_turn("create_bet", p, msg1, players[p].game().next_msg_author, stake);
+            push_turn("create_bet", p, msg1, players[p]->game().next_msg_author, stake);
             t = BET_CHECK;
 
             do {
                 p = opponent_id(p);
                 if (r[p] == CONTINUED) {
                     msg2.clear();
-                    stake = players[p].game().players[p].bets;
-                    r[p] = players[p].process_bet(msg1, msg2);
+                    stake = players[p]->game().players[p].bets;
+                    r[p] = players[p]->process_bet(msg1, msg2);
                     logger << "\n== " << p << " PROCESS BET: " << r[p] << "\n";
                     if (msg2.size()) {
-                        push_turn("process_bet", p, msg2, players[p].game().next_msg_author, stake);
+                        push_turn("process_bet", p, msg2, players[p]->game().next_msg_author, stake);
                         msg1 = msg2;
                     }
                 }
             } while (r[ALICE] == CONTINUED || r[BOB] == CONTINUED);
         }
-        if (players[p].game_over())
+        if (players[p]->game_over())
             p = opponent_id(p);
         else
-            p = players[p].game().current_player;
+            p = players[p]->game().current_player;
     }
 
     if (r[ALICE] != SUCCESS)
@@ -103,13 +142,18 @@ game_error game_generator::generate() {
     if (r[BOB] != SUCCESS)
         return r[BOB];
 
-    alice_game = players[ALICE].game();
-    bob_game = players[BOB].game();    
+    alice_game = players[ALICE]->game();
+    bob_game = players[BOB]->game();    
+
+    if (batch_turns && (res = merge_consecutive_turns()))
+        return res;
     
-    // generate turn data
+    // generate turn data: like the turns drive, every turn starts on a page
     raw_turn_data.clear();
-    for(auto&& m: turns)
+    for(auto&& m: turns) {
         raw_turn_data += std::get<1>(m);
+        pad_to_page(raw_turn_data);
+    }
 
     // generate turn meta-data
     std::ostringstream os;
@@ -143,10 +187,10 @@ game_error game_generator::generate() {
         zero.write_binary_be(os, 4);
     }
 
-    // turn-metadata: turn-data sizes
+    // turn-metadata: turn-data sizes, in whole pages
     for(auto& m: turns) {
         auto& data = std::get<1>(m);
-        bignumber sz = (int)data.size();
+        bignumber sz = (int)((data.size() + wrap_padding_size - 1) / wrap_padding_size * wrap_padding_size);
         sz.write_binary_be(os, 4);
     }
     raw_turn_metadata = os.str();
@@ -20,6 +20,8 @@ class game_generator {
     bignumber claimer_addr;
     bignumber challenger_addr;
     int last_aggressor;
+    bool batch_turns;  // send consecutive turns of a player as one batch frame
+    bool all_in;       // alice raises all of bob's funds preflop and bob calls
 
     // output
 
@@ -33,9 +35,9 @@ class game_generator {
     // turns: tuple(sender, msg, next_sender, sender_stake)
     std::vector<std::tuple<int, std::string, int, money_t>> turns;
 
-    game_generator() : alice_money(200), bob_money(100), big_blind(10), last_aggressor(-1) {
-        alice_addr.parse_string("8000000000000000000000000000000000000000000000000000000000000001", 16);
-        bob_addr.parse_string("9000000000000000000000000000000000000000000000000000000000000002", 16);
+    game_generator() : alice_money(200), bob_money(100), big_blind(10), last_aggressor(-1), batch_turns(false), all_in(false) {
+        alice_addr.parse_string("8000000000000000000000000000000000000001", 16);
+        bob_addr.parse_string("9000000000000000000000000000000000000002", 16);
         challenger_addr = alice_addr;
         claimer_addr = 0;
     }
@@ -44,6 +46,7 @@ class game_generator {
 
   private:
     void push_turn(const char* label, int player, const std::string& msg, int next_player, const money_t& stake);
+    game_error merge_consecutive_turns();
 };
 
 }  // namespace poker
@@ -1,61 +1,264 @@
 #include "game-playback.h"
 #include "compression.h"
+#include "verification-cache.h"
+#ifdef POKER_THREADS
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#endif
 
 namespace poker {
 
-game_playback::game_playback() : _last_player_id(-1) {
+game_playback::game_playback() : _last_player_id(-1), _frame_index(-1), _frame_message_index(-1), _messages_handled(0),
+      _frame_offset(-1), _pipeline_depth(0) {
+}
+
+game_playback::game_playback(i_participant* eve)
+    : _r(eve), _last_player_id(-1), _frame_index(-1), _frame_message_index(-1), _messages_handled(0),
+      _frame_offset(-1), _pipeline_depth(0) {
 }
 
 game_playback:: ~game_playback() {
 }
 
+// A frame read ahead of the referee: its messages decoded, or the error
+// that ends the playback once the messages before it are replayed.
+struct decoded_frame {
+    game_error error;
+    bool unwrapped;
+    std::vector<std::unique_ptr<message>> messages;
+    std::vector<std::string> hashes;  // running transcript hash after each message
+    std::streamoff next_offset;       // position of the following frame
+    decoded_frame() : error(SUCCESS), unwrapped(false), next_offset(-1) {}
+};
+
+// Reads, decompresses and decodes the frames of a log in order. With a depth,
+// this runs on a producer thread that stays up to depth frames ahead of the
+// referee, so replaying a frame overlaps with decoding the next ones.
+// The producer owns the stream until the source is destroyed.
+class frame_source {
+    std::istream& _in;
+    std::string _last_hash;
+#ifdef POKER_THREADS
+    size_t _depth;
+    std::deque<decoded_frame> _queue;
+    std::mutex _lock;
+    std::condition_variable _changed;
+    bool _stop;
+    std::thread _producer;
+#endif
+
+    void read(decoded_frame& f) {
+        std::vector<std::string> frame;
+        if ((f.error = unwrap_and_decompress_next(_in, frame)))
+            return;
+        f.unwrapped = true;
+        for (auto& serialized_msg : frame) {
+            message* msg = NULL;
+            std::istringstream is(serialized_msg);
+            if ((f.error = message::decode(is, &msg)))
+                return;
+            f.messages.emplace_back(msg);
+            _last_hash = next_transcript_hash(_last_hash, serialized_msg);
+            f.hashes.push_back(_last_hash);
+        }
+        // through the buffer, as reaching the end of the log sets eof on the stream
+        f.next_offset = _in.rdbuf()->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+    }
+
+#ifdef POKER_THREADS
+    void produce() {
+        bool done = false;
+        while (!done) {
+            decoded_frame f;
+            read(f);
+            done = f.error != SUCCESS;
+            std::unique_lock<std::mutex> lock(_lock);
+            _changed.wait(lock, [&]() { return _stop || _queue.size() < _depth; });
+            if (_stop)
+                return;
+            _queue.push_back(std::move(f));
+            _changed.notify_all();
+        }
+    }
+#endif
+
+public:
+    frame_source(std::istream& in, const std::string& last_hash, int depth) : _in(in), _last_hash(last_hash) {
+#ifdef POKER_THREADS
+        _depth = depth > 0 ? depth : 0;
+        _stop = false;
+        if (_depth)
+            _producer = std::thread(&frame_source::produce, this);
+#endif
+    }
+
+    ~frame_source() {
+#ifdef POKER_THREADS
+        if (_producer.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _stop = true;
+            }
+            _changed.notify_all();
+            _producer.join();
+        }
+#endif
+    }
+
+    void next(decoded_frame& f) {
+#ifdef POKER_THREADS
+        if (_depth) {
+            std::unique_lock<std::mutex> lock(_lock);
+            _changed.wait(lock, [&]() { return !_queue.empty(); });
+            f = std::move(_queue.front());
+            _queue.pop_front();
+            _changed.notify_all();
+            return;
+        }
+#endif
+        read(f);
+    }
+};
+
 game_error game_playback::playback(std::istream& logfile, std::function<game_error(message*)> visitor) {
+    arena_scope scope(_arena);
     game_error res;
     logger << "*** game playback...\n";
-    std::string serialized_msg;
-    while(SUCCESS == (res=unwrap_and_decompress_next(logfile, serialized_msg))) {
-        message* msg = NULL;
-        std::istringstream is(serialized_msg);
-        if ((res = message::decode(is, &msg)))
-            return res;
-        logger << "*** " << msg->to_string() << std::endl;
+    frame_source frames(logfile, _transcript_hashes.empty() ? std::string() : _transcript_hashes.back(),
+                        _pipeline_depth);
+    while (true) {
+        decoded_frame frame;
+        frames.next(frame);
+        if (frame.unwrapped)
+            _frame_index++;
+        for(_frame_message_index = 0; _frame_message_index < (int)frame.messages.size(); _frame_message_index++) {
+            _transcript_hashes.push_back(frame.hashes[_frame_message_index]);
+            message* msg = frame.messages[_frame_message_index].get();
+            logger << "*** " << msg->to_string() << std::endl;
+
+            if (visitor && (res = visitor(msg))) {
+            logger << "*** visitor returned error " << res  << std::endl;
+              return res;
+            }
 
-        if (visitor && (res = visitor(msg))) {
-        logger << "*** visitor returned error " << res  << std::endl;
-          return res;
+            res = handle(msg);
+            if (!res)
+                _messages_handled++;
+            if (res || _r.step() == game_step::GAME_OVER)
+                return res == END_OF_STREAM ? SUCCESS : res;
         }
+        if (frame.error)
+            return frame.error == END_OF_STREAM ? SUCCESS : frame.error;
+        _frame_offset = frame.next_offset;
+    }
+}
 
-        switch(msg->type()) {
-            case MSG_VTMF:
-                res = handle_vtmf((msg_vtmf*)msg);
-                break;
-            case MSG_VTMF_RESPONSE:
-                res = handle_vtmf_response((msg_vtmf_response*)msg);
-                break;
-            case MSG_VSSHE:
-                res = handle_vsshe((msg_vsshe*)msg);
-                break;
-            case MSG_VSSHE_RESPONSE:
-                res = handle_vsshe_response((msg_vsshe_response*)msg);
-                break;
-            case MSG_BOB_PRIVATE_CARDS:
-                res = handle_bob_private_cards((msg_bob_private_cards*)msg);
-                break;
-            case MSG_BET_REQUEST:
-                res = handle_bet_request((msg_bet_request*)msg);
-                break;
-            case MSG_CARD_PROOF:
-                res = handle_card_proof((msg_card_proof*)msg);
-                break;
-            default:
-                res = PLB_UNKNOWN_MSG_TYPE;
-        }
-        delete msg;
-        msg = NULL;
-        if (res || _r.step() == game_step::GAME_OVER)
-            break;
+game_error game_playback::handle(message* msg) {
+    game_error res;
+    if ((res=check_version(msg, _r.game())))
+        return res;
+
+    switch(msg->type()) {
+        case MSG_VTMF:
+            return handle_vtmf((msg_vtmf*)msg);
+        case MSG_VTMF_RESPONSE:
+            return handle_vtmf_response((msg_vtmf_response*)msg);
+        case MSG_VSSHE:
+            return handle_vsshe((msg_vsshe*)msg);
+        case MSG_VSSHE_RESPONSE:
+            return handle_vsshe_response((msg_vsshe_response*)msg);
+        case MSG_BOB_PRIVATE_CARDS:
+            return handle_bob_private_cards((msg_bob_private_cards*)msg);
+        case MSG_BET_REQUEST:
+            return handle_bet_request((msg_bet_request*)msg);
+        case MSG_CARD_PROOF:
+            return handle_card_proof((msg_card_proof*)msg);
+        case MSG_SHORT_VTMF:
+            return handle_vtmf((msg_vtmf*)msg);
+        case MSG_SHORT_VTMF_RESPONSE:
+            return handle_short_vtmf_response((msg_short_vtmf_response*)msg);
+        case MSG_ALICE_MIX:
+            return handle_alice_mix((msg_alice_mix*)msg);
+        case MSG_ALICE_PRIVATE_CARDS:
+            return handle_alice_private_cards((msg_alice_private_cards*)msg);
+        default:
+            return PLB_UNKNOWN_MSG_TYPE;
     }
-    return res == END_OF_STREAM ? SUCCESS : res;
+}
+
+static const char checkpoint_tag[] = "playback-checkpoint";
+static const int checkpoint_version = 2;
+
+game_error game_playback::save_checkpoint(std::ostream& out) {
+    arena_scope scope(_arena);
+    game_error res;
+    encoder e(out);
+    if ((res = e.write(checkpoint_tag)) || (res = e.write(checkpoint_version)) ||
+        (res = e.write(_alice_key)) || (res = e.write(_alice_private_cards_proof)) ||
+        (res = e.write(_bob_private_cards_proof)) || (res = e.write(_bet_card_proof)) ||
+        (res = e.write(_last_player_id)) || (res = e.write(_frame_index)) ||
+        (res = e.write(_messages_handled)) || (res = e.write(std::to_string(_frame_offset))))
+        return res;
+    if ((res = e.write((int)_transcript_hashes.size())))
+        return res;
+    for (auto& h : _transcript_hashes)
+        if ((res = e.write(h)))
+            return res;
+    return _r.save(out);
+}
+
+game_error game_playback::load_checkpoint(std::istream& in) {
+    arena_scope scope(_arena);
+    game_error res;
+    decoder d(in);
+    std::string tag, frame_offset;
+    int version, hash_count;
+    if ((res = d.read(tag)) || (res = d.read(version)))
+        return res;
+    if (tag != checkpoint_tag || version != checkpoint_version)
+        return PLB_INVALID_CHECKPOINT;
+    if ((res = d.read(_alice_key)) || (res = d.read(_alice_private_cards_proof)) ||
+        (res = d.read(_bob_private_cards_proof)) || (res = d.read(_bet_card_proof)) ||
+        (res = d.read(_last_player_id)) || (res = d.read(_frame_index)) ||
+        (res = d.read(_messages_handled)) || (res = d.read(frame_offset)) || (res = d.read(hash_count)))
+        return res;
+    if (!(std::istringstream(frame_offset) >> _frame_offset))
+        return PLB_INVALID_CHECKPOINT;
+    _frame_message_index = -1;
+    _transcript_hashes.resize(hash_count < 0 ? 0 : hash_count);
+    for (auto& h : _transcript_hashes)
+        if ((res = d.read(h)))
+            return res;
+    return _r.load(in);
+}
+
+game_error game_playback::resume(std::istream& checkpoint, std::istream& logfile, std::streamoff frame_offset,
+                                 std::function<game_error(message*)> visitor) {
+    game_error res;
+    if ((res = load_checkpoint(checkpoint)))
+        return res;
+    logfile.clear();
+    if (!logfile.seekg(frame_offset))
+        return PLB_CHECKPOINT_SEEK;
+    return playback(logfile, visitor);
+}
+
+game_error game_playback::seek_frame(std::istream& logfile, const turn_data_index& index, int frame) {
+    if (frame < 0 || frame >= (int)index.size())
+        return PLB_FRAME_NOT_FOUND;
+    logfile.clear();
+    if (!logfile.seekg(index[frame].offset))
+        return PLB_FRAME_NOT_FOUND;
+    _frame_index = frame - 1;
+    _frame_message_index = -1;
+    _frame_offset = index[frame].offset;
+    return SUCCESS;
+}
+
+game_error game_playback::seek_step(std::istream& logfile, const turn_data_index& index, game_step step) {
+    return seek_frame(logfile, index, index.find(step));
 }
 
 game_error game_playback::handle_vtmf(msg_vtmf* msg) {
@@ -123,6 +326,52 @@ game_error game_playback::handle_bob_private_cards(msg_bob_private_cards* msg) {
     return SUCCESS;
 }
 
+game_error game_playback::handle_short_vtmf_response(msg_short_vtmf_response* msg) {
+    game_error res;
+
+    blob notused_eve_key;
+    if ((res=_r.step_load_keys(_alice_key, msg->bob_key, notused_eve_key)))
+        return res;
+
+    if ((res=_r.step_vsshe_group(msg->vsshe, true)))
+        return res;
+
+    if ((res=_r.step_bob_mix(msg->stack, msg->stack_proof)))
+        return res;
+
+    return SUCCESS;
+}
+
+game_error game_playback::handle_alice_mix(msg_alice_mix* msg) {
+    game_error res;
+
+    if ((res=_r.step_alice_mix(msg->stack, msg->stack_proof)))
+        return res;
+
+    blob notused1, notused2;
+    if ((res=_r.step_final_mix(notused1, notused2)))
+        return res;
+
+    if ((res=_r.step_take_cards_from_stack()))
+        return res;
+
+    _bob_private_cards_proof = msg->cards_proof;
+
+    return SUCCESS;
+}
+
+game_error game_playback::handle_alice_private_cards(msg_alice_private_cards* msg) {
+    game_error res;
+
+    _alice_private_cards_proof = msg->cards_proof;
+
+    blob notused;
+    if ((res=_r.step_open_private_cards(VERIFIER, notused, notused)))
+        return res;
+
+    return SUCCESS;
+}
+
 game_error game_playback::handle_bet_request(msg_bet_request* msg) {
     game_error res;
 
@@ -147,7 +396,19 @@ game_error game_playback::handle_card_proof(msg_card_proof* msg) {
     game_error res;
     int first_card, count;
 
-    if (_r.step() == game_step::SHOWDOWN) {
+    if (_r.runout_pending()) {
+        // the bettor's runout proofs came with its bet, these are the response
+        blob public_proofs[NUM_PLAYERS], own_private_proofs[NUM_PLAYERS];
+        auto bettor = opponent_id(msg->player_id);
+        if ((res = read_runout_proofs(_bet_card_proof, public_proofs[bettor], own_private_proofs[bettor])))
+            return res;
+        if ((res = read_runout_proofs(msg->cards_proof, public_proofs[msg->player_id], own_private_proofs[msg->player_id])))
+            return res;
+        blob alice_private_proofs[NUM_PLAYERS] = { own_private_proofs[ALICE], _bob_private_cards_proof };
+        blob bob_private_proofs[NUM_PLAYERS] = { _alice_private_cards_proof, own_private_proofs[BOB] };
+        if ((res = _r.step_runout(public_proofs[ALICE], public_proofs[BOB], alice_private_proofs, bob_private_proofs)))
+            return res;
+    } else if (_r.step() == game_step::SHOWDOWN) {
         logger << "game_step::SHOWDOWN" << std::endl;
 
         if (msg->muck) {  // Last player lost and mucked
@@ -9,11 +9,14 @@
 #include "codec.h"
 #include "referee.h"
 #include "messages.h"
+#include "game-arena.h"
+#include "turn-data-index.h"
 
 
 namespace poker {
 
 class game_playback {
+    game_arena _arena; // first, so that it outlives everything allocated in it
     referee _r;
     blob _alice_key;
     blob _alice_private_cards_proof;
@@ -21,19 +24,60 @@ class game_playback {
     blob _bet_card_proof;
     std::vector<std::unique_ptr<message>> _messages;
     int _last_player_id; // sender of the last msg replayed
+    int _frame_index; // frame (turn) holding the msg being replayed
+    int _frame_message_index; // position of the msg within its frame
+    std::vector<std::string> _transcript_hashes; // running hash after each msg read
+    int _messages_handled; // msgs replayed without errors
+    std::streamoff _frame_offset; // position of the frame after the last complete one, -1 if unknown
+    int _pipeline_depth; // frames decoded ahead of the referee, 0 to decode in turn
 public:
     game_playback();
+    // plays back with the given participant as the referee's, see referee(i_participant*)
+    game_playback(i_participant* eve);
     virtual ~game_playback();
+    // plays back the frames of logfile, continuing from the current state
     game_error playback(std::istream& logfile, std::function<game_error(message*)> visitor = NULL);
+
+    // Checkpoints hold the playback and referee state after a complete frame,
+    // so that appending a turn does not require replaying the whole game.
+    // resume() loads one and plays back logfile from the frame at frame_offset.
+    game_error save_checkpoint(std::ostream& out);
+    game_error load_checkpoint(std::istream& in);
+    game_error resume(std::istream& checkpoint, std::istream& logfile, std::streamoff frame_offset,
+                      std::function<game_error(message*)> visitor = NULL);
+    std::streamoff frame_offset() { return _frame_offset; }
+
+    // Positions logfile at a frame of its index, so that playback() continues
+    // from it, e.g. after load_checkpoint() or to inspect a single turn.
+    game_error seek_frame(std::istream& logfile, const turn_data_index& index, int frame);
+    // to the first frame played back in step
+    game_error seek_step(std::istream& logfile, const turn_data_index& index, game_step step);
+
+    // Decodes up to depth frames ahead on a producer thread while the referee
+    // replays, so long games cost little more than their proofs. The log may
+    // then be read past the frame that ends the playback. Ignored in builds
+    // without POKER_THREADS.
+    void set_pipeline_depth(int depth) { _pipeline_depth = depth; }
     game_state& game() { return _r.game(); }
+    game_step step() { return _r.step(); }
     int last_player_id() { return _last_player_id; }
+    // batch frames carry several messages; these locate the one being visited
+    int frame_index() { return _frame_index; }
+    int frame_message_index() { return _frame_message_index; }
+    // running transcript hashes, see next_transcript_hash()
+    const std::vector<std::string>& transcript_hashes() { return _transcript_hashes; }
+    int messages_handled() { return _messages_handled; }
 
 private:
+    game_error handle(message* msg);
     game_error handle_vtmf(msg_vtmf* msg); 
     game_error handle_vtmf_response(msg_vtmf_response* msg);
     game_error handle_vsshe(msg_vsshe* msg);
     game_error handle_vsshe_response(msg_vsshe_response* msg);
     game_error handle_bob_private_cards(msg_bob_private_cards* msg);
+    game_error handle_short_vtmf_response(msg_short_vtmf_response* msg);
+    game_error handle_alice_mix(msg_alice_mix* msg);
+    game_error handle_alice_private_cards(msg_alice_private_cards* msg);
     game_error handle_bet_request(msg_bet_request* msg);
     game_error handle_card_proof(msg_card_proof* msg);
 };
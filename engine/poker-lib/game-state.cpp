@@ -1,5 +1,6 @@
 #include <iostream>
 #include "game-state.h"
+#include "codec.h"
 
 namespace poker {
 
@@ -53,5 +54,58 @@ std::string game_state::to_json(char* extra_fields) {
     return std::string(json);
 }
 
+game_error game_state::save(encoder& out) {
+    game_error res;
+    int fields[] = { current_player, (int)error, (int)phase, winner, last_aggressor, next_msg_author, muck };
+    for (auto f : fields)
+        if ((res = out.write(f)))
+            return res;
+    for (auto& p : players) {
+        if ((res = out.write(p.id)) || (res = out.write(p.total_funds)) || (res = out.write(p.bets)))
+            return res;
+        for (auto c : p.cards)
+            if ((res = out.write(c)))
+                return res;
+    }
+    for (auto c : public_cards)
+        if ((res = out.write(c)))
+            return res;
+    if ((res = out.write(big_blind)))
+        return res;
+    for (auto& f : funds_share)
+        if ((res = out.write(f)))
+            return res;
+    return out.write(version);
+}
+
+game_error game_state::load(decoder& in) {
+    game_error res;
+    int err, ph, mk;
+    if ((res = in.read(current_player)) || (res = in.read(err)) || (res = in.read(ph)) ||
+        (res = in.read(winner)) || (res = in.read(last_aggressor)) || (res = in.read(next_msg_author)) ||
+        (res = in.read(mk)))
+        return res;
+    error = (game_error)err;
+    phase = (bet_phase)ph;
+    muck = mk != 0;
+    for (auto& p : players) {
+        int id;
+        if ((res = in.read(id)) || (res = in.read(p.total_funds)) || (res = in.read(p.bets)))
+            return res;
+        p.id = id;
+        for (auto& c : p.cards)
+            if ((res = in.read(c)))
+                return res;
+    }
+    for (auto& c : public_cards)
+        if ((res = in.read(c)))
+            return res;
+    if ((res = in.read(big_blind)))
+        return res;
+    for (auto& f : funds_share)
+        if ((res = in.read(f)))
+            return res;
+    return in.read(version);
+}
 
 }  // namespace poker
\ No newline at end of file
@@ -2,12 +2,16 @@
 #define GAME_STATE_H
 
 #include <cstdint>
+#include <type_traits>
 #include "common.h"
 #include "solver.h"
-#include "bignumber.h"
+#include "money.h"
 
 namespace poker {
 
+class encoder;
+class decoder;
+
 enum bet_phase {
     PHS_PREFLOP,
     PHS_FLOP,
@@ -33,7 +37,7 @@ class game_state {
 public:
     game_state()
         : error(SUCCESS),winner(-1), current_player(ALICE),
-          last_aggressor(BOB), next_msg_author(NONE), phase(PHS_PREFLOP), muck(false),
+          last_aggressor(BOB), next_msg_author(NONE), phase(PHS_PREFLOP), muck(false), version(poker_version),
           players{player_state(ALICE), player_state(BOB)},
           public_cards{cards::uk, cards::uk, cards::uk, cards::uk, cards::uk}
         { }
@@ -49,11 +53,17 @@ public:
     money_t big_blind;
     money_t funds_share[NUM_PLAYERS];
     bool muck;
+    int version;  // protocol version the game is played at, see check_version()
 
     std::string to_json(char* extra_fields=NULL);
+    game_error save(encoder& out);
+    game_error load(decoder& in);
     game_error get_player_hand(int player, card_t* hand);
 };
 
+// copied around by the verifier and playback without allocating
+static_assert(std::is_trivially_copyable<game_state>::value, "game_state must be trivially copyable");
+
 }
 
 #endif
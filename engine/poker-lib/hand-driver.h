@@ -0,0 +1,62 @@
+#ifndef HAND_DRIVER_H
+#define HAND_DRIVER_H
+
+#include <string>
+#include "common.h"
+#include "money.h"
+
+namespace poker {
+
+/*
+ * The hand played by the benchmarks and load tests: a handshake, then
+ * alice raises 90 and bob calls, which leaves alice all in when the table
+ * was set up with 100, 300, 10. A seat is anything answering like a
+ * player: create_handshake(out), process_handshake(in, out),
+ * create_bet(type, amt, out) and process_bet(in, out), e.g. a player or a
+ * table of poker-host.
+ */
+
+// delivers msg and the answers to it until there are none
+template <class seat>
+game_error exchange(bool handshake, seat& receiver, seat& sender, std::string& msg, int* messages = NULL) {
+    game_error res;
+    seat* to = &receiver;
+    std::string out;
+    while (msg.size()) {
+        if (messages)
+            (*messages)++;
+        res = handshake ? to->process_handshake(msg, out) : to->process_bet(msg, out);
+        if (res != SUCCESS && res != CONTINUED)
+            return res;
+        msg = out;
+        to = to == &receiver ? &sender : &receiver;
+    }
+    return SUCCESS;
+}
+
+template <class seat>
+game_error play_handshake(seat& alice, seat& bob, int* messages = NULL) {
+    game_error res;
+    std::string msg;
+    if ((res = alice.create_handshake(msg)) && res != CONTINUED)
+        return res;
+    return exchange(true, bob, alice, msg, messages);
+}
+
+// both seats initialized, the hand from the handshake to the end of the game
+template <class seat>
+game_error play_all_in(seat& alice, seat& bob, int* messages = NULL) {
+    game_error res;
+    std::string msg;
+    if ((res = play_handshake(alice, bob, messages)) ||
+        ((res = alice.create_bet(BET_RAISE, 90, msg)) && res != CONTINUED) ||
+        (res = exchange(false, bob, alice, msg, messages)) ||
+        ((res = bob.create_bet(BET_CALL, 0, msg)) && res != CONTINUED) ||
+        (res = exchange(false, alice, bob, msg, messages)))
+        return res;
+    return SUCCESS;
+}
+
+}  // namespace poker
+
+#endif  // HAND_DRIVER_H
@@ -0,0 +1,182 @@
+#include "hand-evaluator.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define HAND_EVALUATOR_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace poker {
+
+// see make-hand-tables.cpp
+extern const unsigned short hand_category_floors[];
+extern const unsigned short hand_flush_ratings[];
+extern const unsigned short hand_rank_hash[];
+extern const unsigned short hand_rank_ratings_5[];
+extern const unsigned short hand_rank_ratings_6[];
+extern const unsigned short hand_rank_ratings_7[];
+
+static const int ranks = 13;
+static const int suits = 4;
+static const int max_hand_size = 7;
+static const int deck_size = 52;
+static const unsigned int suit_bits = (1 << ranks) - 1;
+
+static inline int hash_index(int rank, int remaining, int count) {
+    return (rank * (max_hand_size + 1) + remaining) * 5 + count;
+}
+
+int evaluate_hand(const card_t* hand, int hand_size) {
+    const unsigned short* ratings;
+    switch (hand_size) {
+        case 5: ratings = hand_rank_ratings_5; break;
+        case 6: ratings = hand_rank_ratings_6; break;
+        case 7: ratings = hand_rank_ratings_7; break;
+        default: return 0;
+    }
+
+    unsigned char counts[ranks] = {0};
+    unsigned char suit_counts[suits] = {0};
+    unsigned int suit_ranks[suits] = {0};
+    for (int i = 0; i < hand_size; i++) {
+        int rank = hand[i] % ranks;
+        int suit = hand[i] / ranks;
+        counts[rank]++;
+        suit_counts[suit]++;
+        suit_ranks[suit] |= 1 << rank;
+    }
+
+    // with at most 7 cards, a flush beats anything else the hand holds
+    for (int s = 0; s < suits; s++)
+        if (suit_counts[s] >= 5)
+            return hand_flush_ratings[suit_ranks[s]];
+
+    int index = 0;
+    int remaining = hand_size;
+    for (int r = 0; remaining; r++) {
+        index += hand_rank_hash[hash_index(r, remaining, counts[r])];
+        remaining -= counts[r];
+    }
+    return ratings[index];
+}
+
+hand_category get_hand_category(int rating) {
+    int c = HAND_STRAIGHT_FLUSH;
+    while (c > HAND_HIGH_CARD && rating < hand_category_floors[c])
+        c--;
+    return (hand_category)c;
+}
+
+static inline int evaluate_mask(uint64_t hand) {
+    unsigned int suit_ranks[suits];
+    for (int s = 0; s < suits; s++) {
+        suit_ranks[s] = (unsigned int)(hand >> (s * ranks)) & suit_bits;
+        if (__builtin_popcount(suit_ranks[s]) >= 5)
+            return hand_flush_ratings[suit_ranks[s]];
+    }
+    int index = 0;
+    int remaining = max_hand_size;
+    for (int r = 0; remaining; r++) {
+        int count = ((suit_ranks[0] >> r) & 1) + ((suit_ranks[1] >> r) & 1) +
+                    ((suit_ranks[2] >> r) & 1) + ((suit_ranks[3] >> r) & 1);
+        index += hand_rank_hash[hash_index(r, remaining, count)];
+        remaining -= count;
+    }
+    return hand_rank_ratings_7[index];
+}
+
+void evaluate_hands_scalar(const uint64_t* hands, int count, unsigned short* ratings) {
+    for (int i = 0; i < count; i++)
+        ratings[i] = (unsigned short)evaluate_mask(hands[i]);
+}
+
+#ifdef HAND_EVALUATOR_AVX2
+// 16-bit entries, loaded 32 bits at a time: tables have an entry to spare
+__attribute__((target("avx2")))
+static inline __m256i gather_table(const unsigned short* table, __m256i index) {
+    return _mm256_and_si256(_mm256_i32gather_epi32((const int*)table, index, 2), _mm256_set1_epi32(0xffff));
+}
+
+// 8 hands at a time, in 32-bit lanes: the same steps as evaluate_mask(), without branches
+__attribute__((target("avx2")))
+static void evaluate_hands_avx2_blocks(const uint64_t* hands, int count, unsigned short* ratings) {
+    const __m256i bits = _mm256_set1_epi32(suit_bits);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i four = _mm256_set1_epi32(4);
+    const __m256i halves = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    for (int i = 0; i + 8 <= count; i += 8) {
+        // low and high 32 bits of each mask
+        __m256i a = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)(hands + i)), halves);
+        __m256i b = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)(hands + i + 4)), halves);
+        __m256i lo = _mm256_permute2x128_si256(a, b, 0x20);
+        __m256i hi = _mm256_permute2x128_si256(a, b, 0x31);
+
+        __m256i suit_ranks[suits] = {
+            _mm256_and_si256(lo, bits),
+            _mm256_and_si256(_mm256_srli_epi32(lo, ranks), bits),
+            _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi32(lo, 2 * ranks), _mm256_slli_epi32(hi, 32 - 2 * ranks)), bits),
+            _mm256_and_si256(_mm256_srli_epi32(hi, 3 * ranks - 32), bits),
+        };
+
+        __m256i suit_counts[suits] = {
+            _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()
+        };
+        __m256i index = _mm256_setzero_si256();
+        __m256i remaining = _mm256_set1_epi32(max_hand_size);
+        for (int r = 0; r < ranks; r++) {
+            __m256i count = _mm256_setzero_si256();
+            for (int s = 0; s < suits; s++) {
+                __m256i bit = _mm256_and_si256(_mm256_srli_epi32(suit_ranks[s], r), one);
+                count = _mm256_add_epi32(count, bit);
+                suit_counts[s] = _mm256_add_epi32(suit_counts[s], bit);
+            }
+            // hash_index(r, remaining, count)
+            __m256i h = _mm256_add_epi32(_mm256_mullo_epi32(
+                _mm256_add_epi32(_mm256_set1_epi32(r * (max_hand_size + 1)), remaining), _mm256_set1_epi32(5)), count);
+            index = _mm256_add_epi32(index, gather_table(hand_rank_hash, h));
+            remaining = _mm256_sub_epi32(remaining, count);
+        }
+
+        __m256i flush = _mm256_setzero_si256();
+        __m256i flush_ranks = _mm256_setzero_si256();
+        for (int s = 0; s < suits; s++) {
+            __m256i is_flush = _mm256_cmpgt_epi32(suit_counts[s], four);
+            flush = _mm256_or_si256(flush, is_flush);
+            flush_ranks = _mm256_blendv_epi8(flush_ranks, suit_ranks[s], is_flush);
+        }
+        __m256i rating = _mm256_blendv_epi8(gather_table(hand_rank_ratings_7, index),
+                                            gather_table(hand_flush_ratings, flush_ranks), flush);
+
+        // 8 ratings to 16 bits
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(rating, rating), 0x08);
+        _mm_storeu_si128((__m128i*)(ratings + i), _mm256_castsi256_si128(packed));
+    }
+}
+#endif
+
+bool evaluate_hands_avx2(const uint64_t* hands, int count, unsigned short* ratings) {
+#ifdef HAND_EVALUATOR_AVX2
+    static const bool available = __builtin_cpu_supports("avx2");
+    if (!available)
+        return false;
+    evaluate_hands_avx2_blocks(hands, count, ratings);
+    int done = count / 8 * 8;
+    evaluate_hands_scalar(hands + done, count - done, ratings + done);
+    return true;
+#else
+    return false;
+#endif
+}
+
+game_error evaluate_hands(const uint64_t* hands, int count, unsigned short* ratings) {
+    for (int i = 0; i < count; i++) {
+        if (hands[i] >> deck_size)
+            return SRR_UNKNOWN_CARD;
+        if (__builtin_popcountll(hands[i]) != max_hand_size)
+            return SRR_UNSUPPORTED_HAND_SIZE;
+    }
+    if (!evaluate_hands_avx2(hands, count, ratings))
+        evaluate_hands_scalar(hands, count, ratings);
+    return SUCCESS;
+}
+
+}  // namespace poker
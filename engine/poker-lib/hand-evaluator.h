@@ -0,0 +1,59 @@
+#ifndef HAND_EVALUATOR_H
+#define HAND_EVALUATOR_H
+
+#include <cstdint>
+#include "common.h"
+
+namespace poker {
+
+/*
+ * Built-in hand evaluator, for hands of 5 to 7 cards.
+ * A hand is rated by its best 5 cards, from 1 (7-5-4-3-2 offsuit) to 7462
+ * (royal flush): a better hand has a higher rating and equal hands rate the
+ * same. A hand with 5 or more cards of a suit is looked up by the ranks of
+ * that suit, any other by a minimal perfect hash of its rank counts. The
+ * tables are generated at build time by make-hand-tables.
+ */
+
+enum hand_category {
+    HAND_HIGH_CARD,
+    HAND_PAIR,
+    HAND_TWO_PAIR,
+    HAND_TRIPS,
+    HAND_STRAIGHT,
+    HAND_FLUSH,
+    HAND_FULL_HOUSE,
+    HAND_QUADS,
+    HAND_STRAIGHT_FLUSH
+};
+
+const int hand_categories = HAND_STRAIGHT_FLUSH + 1;
+
+// Rating of valid, distinct cards; 0 if there are not 5 to 7 of them
+int evaluate_hand(const card_t* hand, int hand_size);
+
+hand_category get_hand_category(int rating);
+
+/*
+ * Batch evaluation of 7-card hands, given as card masks: bit c is set for
+ * card c. Masks are checked up front, without logging: SRR_UNKNOWN_CARD
+ * for bits above the deck, SRR_UNSUPPORTED_HAND_SIZE unless 7 are set.
+ * Uses AVX2 where the build targets x86-64 and the CPU has it.
+ */
+game_error evaluate_hands(const uint64_t* hands, int count, unsigned short* ratings);
+
+// The evaluate_hands() implementations, for unchecked masks
+void evaluate_hands_scalar(const uint64_t* hands, int count, unsigned short* ratings);
+// false, evaluating nothing, where AVX2 is not available
+bool evaluate_hands_avx2(const uint64_t* hands, int count, unsigned short* ratings);
+
+inline uint64_t hand_mask(const card_t* hand, int hand_size) {
+    uint64_t mask = 0;
+    for (int i = 0; i < hand_size; i++)
+        mask |= (uint64_t)1 << hand[i];
+    return mask;
+}
+
+}  // namespace poker
+
+#endif  // HAND_EVALUATOR_H
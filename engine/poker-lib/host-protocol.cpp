@@ -0,0 +1,80 @@
+#include "host-protocol.h"
+
+#include <cerrno>
+#include <unistd.h>
+
+namespace poker {
+
+std::string host_frame(const std::string& payload) {
+    uint32_t len = payload.size();
+    std::string frame;
+    frame.reserve(host_frame_header + len);
+    for (int shift = 24; shift >= 0; shift -= 8)
+        frame.push_back((char)((len >> shift) & 0xff));
+    return frame + payload;
+}
+
+static uint32_t frame_length(const std::string& header) {
+    uint32_t len = 0;
+    for (int i = 0; i < host_frame_header; i++)
+        len = (len << 8) | (unsigned char)header[i];
+    return len;
+}
+
+game_error next_host_frame(std::string& buffer, std::string& payload, bool& found) {
+    found = false;
+    if (buffer.size() < (size_t)host_frame_header)
+        return SUCCESS;
+    uint32_t len = frame_length(buffer);
+    if (len > (uint32_t)max_host_frame)
+        return HST_FRAME_TOO_BIG;
+    if (buffer.size() < host_frame_header + len)
+        return SUCCESS;
+    payload = buffer.substr(host_frame_header, len);
+    buffer.erase(0, host_frame_header + len);
+    found = true;
+    return SUCCESS;
+}
+
+game_error write_host_frame(int fd, const std::string& payload) {
+    auto frame = host_frame(payload);
+    size_t done = 0;
+    while (done < frame.size()) {
+        ssize_t n = write(fd, frame.data() + done, frame.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return HST_SOCKET_ERROR;
+        done += n;
+    }
+    return SUCCESS;
+}
+
+static game_error read_all(int fd, std::string& data, size_t len) {
+    data.resize(len);
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = read(fd, &data[done], len - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return HST_SOCKET_ERROR;
+        if (n == 0)
+            return HST_CONNECTION_CLOSED;
+        done += n;
+    }
+    return SUCCESS;
+}
+
+game_error read_host_frame(int fd, std::string& payload) {
+    game_error res;
+    std::string header;
+    if ((res = read_all(fd, header, host_frame_header)))
+        return res;
+    uint32_t len = frame_length(header);
+    if (len > (uint32_t)max_host_frame)
+        return HST_FRAME_TOO_BIG;
+    return read_all(fd, payload, len);
+}
+
+}  // namespace poker
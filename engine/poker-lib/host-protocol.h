@@ -0,0 +1,53 @@
+#ifndef HOST_PROTOCOL_H
+#define HOST_PROTOCOL_H
+
+#include <string>
+#include "common.h"
+
+namespace poker {
+
+/*
+ * Protocol of poker-host, over a Unix domain socket. Each frame is a 4 byte
+ * big-endian length followed by that many bytes, encoded with the codec.
+ *
+ *   request:  id, op, table, then the arguments of op
+ *   response: id, result, then the results of op if result is SUCCESS
+ *             or CONTINUED
+ *
+ * Responses carry the id of their request. Requests on different tables may
+ * be answered out of order; requests on the same table are answered in order.
+ */
+enum host_op {
+    // player_id, encryption, winner, short_handshake, alice_money, bob_money, big_blind -> table
+    HOST_NEW_TABLE,
+    // -> msg_out
+    HOST_CREATE_HANDSHAKE,
+    // msg_in -> msg_out
+    HOST_PROCESS_HANDSHAKE,
+    // type, amount -> msg_out
+    HOST_CREATE_BET,
+    // msg_in -> msg_out, type, amount
+    HOST_PROCESS_BET,
+    // -> json
+    HOST_GAME_STATE,
+    // ->
+    HOST_DELETE_TABLE
+};
+
+const int host_frame_header = 4;
+const int max_host_frame = 16 * 1024 * 1024;
+
+// Prepends the frame header to payload
+std::string host_frame(const std::string& payload);
+
+// Takes the first whole frame out of buffer, if there is one.
+// Returns HST_FRAME_TOO_BIG if the frame header is not valid.
+game_error next_host_frame(std::string& buffer, std::string& payload, bool& found);
+
+// Blocking writes and reads of whole frames
+game_error write_host_frame(int fd, const std::string& payload);
+game_error read_host_frame(int fd, std::string& payload);
+
+}  // namespace poker
+
+#endif  // HOST_PROTOCOL_H
@@ -0,0 +1,323 @@
+#include "host-server.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <sstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "codec.h"
+
+namespace poker {
+
+static std::string response(int id, game_error res, const std::string& results) {
+    std::stringstream out;
+    encoder e(out);
+    e.write(id);
+    e.write(res);
+    if (res == SUCCESS || res == CONTINUED)
+        out << results;
+    return host_frame(out.str());
+}
+
+// runs on a worker
+static game_error run(host_table& t, int op, decoder& args, encoder& results) {
+    game_error res;
+    std::string msg_in, msg_out;
+    switch (op) {
+    case HOST_CREATE_HANDSHAKE:
+        if ((res = t.p.create_handshake(msg_out)))
+            return res;
+        results.write(msg_out);
+        return SUCCESS;
+    case HOST_PROCESS_HANDSHAKE:
+        if ((res = args.read(msg_in)))
+            return res;
+        res = t.p.process_handshake(msg_in, msg_out);
+        if (res == SUCCESS || res == CONTINUED)
+            results.write(msg_out);
+        return res;
+    case HOST_CREATE_BET: {
+        bet_type type;
+        money_t amount;
+        if ((res = args.read(type)) || (res = args.read(amount)))
+            return res;
+        res = t.p.create_bet(type, amount, msg_out);
+        if (res == SUCCESS || res == CONTINUED)
+            results.write(msg_out);
+        return res;
+    }
+    case HOST_PROCESS_BET: {
+        bet_type type = BET_NONE;
+        money_t amount;
+        if ((res = args.read(msg_in)))
+            return res;
+        res = t.p.process_bet(msg_in, msg_out, &type, &amount);
+        if (res == SUCCESS || res == CONTINUED) {
+            results.write(msg_out);
+            results.write((int)type);
+            results.write(amount);
+        }
+        return res;
+    }
+    case HOST_GAME_STATE: {
+        char extra_fields[100];
+        sprintf(extra_fields, "\"step\": %d", (int)t.p.step());
+        results.write(t.p.game().to_json(extra_fields));
+        return SUCCESS;
+    }
+    case HOST_DELETE_TABLE:
+        // queued behind the table's other requests, so it is answered after them
+        return SUCCESS;
+    }
+    return HST_UNKNOWN_OP;
+}
+
+host_server::host_server(int threads, int table_queue, int max_inflight, size_t max_unsent, std::function<void()> wake)
+    : _wake(wake), _table_queue(table_queue), _max_inflight(max_inflight), _max_unsent(max_unsent), _next_task(0),
+      _workers(threads) {
+}
+
+bool host_server::accepting(const host_connection& c) {
+    return c.pending < _max_inflight && c.out.size() < _max_unsent;
+}
+
+void host_server::reply(host_connection& c, int id, game_error res, const std::string& results) {
+    auto frame = response(id, res, results);
+    std::lock_guard<std::mutex> l(_lock);
+    c.out += frame;
+}
+
+game_error host_server::new_table(host_connection& c, decoder& args, encoder& results) {
+    game_error res;
+    int player_id, encryption, short_handshake;
+    poker_lib_options opts;
+    money_t alice_money, bob_money, big_blind;
+    if ((res = args.read(player_id)) || (res = args.read(encryption)) || (res = args.read(opts.winner)) ||
+        (res = args.read(short_handshake)) || (res = args.read(alice_money)) || (res = args.read(bob_money)) ||
+        (res = args.read(big_blind)))
+        return res;
+    opts.encryption = encryption != 0;
+    opts.short_handshake = short_handshake != 0;
+    if (player_id != ALICE && player_id != BOB)
+        return GRR_INVALID_PLAYER;
+    std::shared_ptr<host_table> t(new host_table(player_id, opts));
+    if ((res = t->p.init(alice_money, bob_money, big_blind)))
+        return res;
+    int id = c.next_table++;
+    c.tables[id] = t;
+    results.write(id);
+    return SUCCESS;
+}
+
+// handles one request; the ones on a table are queued to the workers
+void host_server::handle(const std::shared_ptr<host_connection>& c, const std::string& payload) {
+    std::stringstream in(payload);
+    decoder d(in);
+    int id = 0, op, table_id;
+    game_error res;
+    if ((res = d.read(id)) || (res = d.read(op)) || (res = d.read(table_id)))
+        return reply(*c, id, res);
+
+    if (op == HOST_NEW_TABLE) {
+        std::stringstream results;
+        encoder e(results);
+        res = new_table(*c, d, e);
+        return reply(*c, id, res, results.str());
+    }
+
+    auto found = c->tables.find(table_id);
+    if (found == c->tables.end())
+        return reply(*c, id, HST_TABLE_NOT_FOUND);
+    auto t = found->second;
+    auto pos = in.tellg();
+    std::string args = pos < 0 ? "" : payload.substr(pos);
+
+    int task = _next_task++;
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        if (op != HOST_DELETE_TABLE && t->pending >= _table_queue) {
+            c->out += response(id, HST_TABLE_BUSY, "");
+            return;
+        }
+        t->pending++;
+        c->pending++;
+        c->tasks[task] = t;
+    }
+    if (op == HOST_DELETE_TABLE)
+        c->tables.erase(found);
+
+    _workers.queue(task, t.get(), [this, c, t, task, id, op, args]() {
+        std::stringstream in(args), results;
+        decoder d(in);
+        encoder e(results);
+        game_error res = run(*t, op, d, e);
+        auto frame = response(id, res, results.str());
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            t->pending--;
+            c->pending--;
+            c->tasks.erase(task);
+            if (!c->closed)
+                c->out += frame;
+        }
+        _wake();
+    });
+}
+
+bool host_server::dispatch(const std::shared_ptr<host_connection>& c) {
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            if (!accepting(*c))
+                return true;
+        }
+        std::string payload;
+        bool found;
+        if (next_host_frame(c->in, payload, found)) {
+            fprintf(stderr, "Closing a connection: frame too big\n");
+            return false;
+        }
+        if (!found)
+            return true;
+        handle(c, payload);
+    }
+}
+
+void host_server::close(host_connection& c) {
+    std::lock_guard<std::mutex> l(_lock);
+    c.closed = true;
+    for (auto it = c.tasks.begin(); it != c.tasks.end();) {
+        if (_workers.cancel(it->first)) {
+            it->second->pending--;
+            c.pending--;
+            it = c.tasks.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+static const size_t read_chunk = 64 * 1024;
+// what a connection holds unread at most: a whole frame, taken once its
+// requests are
+static const size_t max_unread = host_frame_header + max_host_frame;
+
+static bool set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// one chunk, so that a client writing on and on doesn't hold the I/O thread
+static bool read_from(host_connection& c) {
+    if (c.in.size() > max_unread)
+        return true;
+    char buf[read_chunk];
+    for (;;) {
+        ssize_t n = read(c.fd, buf, sizeof(buf));
+        if (n > 0) {
+            c.in.append(buf, n);
+            return true;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+}
+
+static bool write_to(host_server& server, host_connection& c) {
+    std::lock_guard<std::mutex> l(server.lock());
+    size_t done = 0;
+    while (done < c.out.size()) {
+        ssize_t n = write(c.fd, c.out.data() + done, c.out.size() - done);
+        if (n > 0) {
+            done += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        return false;
+    }
+    c.out.erase(0, done);
+    return true;
+}
+
+static void add_connection(std::vector<std::shared_ptr<host_connection>>& conns, int fd) {
+    if (!set_nonblocking(fd)) {
+        ::close(fd);
+        return;
+    }
+    conns.emplace_back(new host_connection(fd));
+}
+
+void serve(host_server& server, int listener, int wake_fd, const std::vector<int>& fds, std::function<bool()> stop) {
+    std::vector<std::shared_ptr<host_connection>> conns;
+    for (int fd : fds)
+        add_connection(conns, fd);
+    // drained whole on every wake-up
+    set_nonblocking(wake_fd);
+    while (!stop()) {
+        std::vector<pollfd> polled_fds;
+        polled_fds.push_back({listener, POLLIN, 0});
+        polled_fds.push_back({wake_fd, POLLIN, 0});
+        {
+            std::lock_guard<std::mutex> l(server.lock());
+            for (auto& c : conns) {
+                short events = server.accepting(*c) && c->in.size() <= max_unread ? POLLIN : 0;
+                if (!c->out.empty())
+                    events |= POLLOUT;
+                polled_fds.push_back({c->fd, events, 0});
+            }
+        }
+        if (poll(polled_fds.data(), polled_fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll");
+            break;
+        }
+
+        if (polled_fds[1].revents & POLLIN) {
+            char buf[256];
+            while (read(wake_fd, buf, sizeof(buf)) > 0) {
+            }
+        }
+
+        size_t polled = conns.size();
+        if (polled_fds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = accept(listener, NULL, NULL)) >= 0)
+                add_connection(conns, fd);
+        }
+
+        for (size_t i = 0; i < conns.size(); i++) {
+            auto& c = conns[i];
+            short revents = i < polled ? polled_fds[i + 2].revents : 0;
+            bool ok = true;
+            if (revents & (POLLIN | POLLHUP | POLLERR))
+                ok = read_from(*c);
+            ok = ok && server.dispatch(c) && write_to(server, *c);
+            if (!ok)
+                server.close(*c);
+        }
+
+        for (auto it = conns.begin(); it != conns.end();) {
+            if ((*it)->closed) {
+                ::close((*it)->fd);
+                it = conns.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+
+    for (auto& c : conns) {
+        server.close(*c);
+        ::close(c->fd);
+    }
+}
+
+}  // namespace poker
@@ -0,0 +1,86 @@
+#ifndef HOST_SERVER_H
+#define HOST_SERVER_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "host-protocol.h"
+#include "poker-lib.h"
+#include "player.h"
+#include "task-pool.h"
+
+namespace poker {
+
+struct host_table {
+    player p;
+    int pending;  // requests queued or running
+    host_table(int id, const poker_lib_options& opts) : p(id, opts), pending(0) {}
+};
+
+struct host_connection {
+    int fd;
+    std::string in;   // bytes read, not yet a whole frame
+    std::string out;  // responses not yet written
+    int pending;      // requests queued or running
+    bool closed;
+    int next_table;
+    std::map<int, std::shared_ptr<host_table>> tables;
+    std::map<int, std::shared_ptr<host_table>> tasks;  // queued or running, by task id
+    host_connection(int fd) : fd(fd), pending(0), closed(false), next_table(1) {}
+};
+
+/*
+ * The requests of poker-host, apart from its sockets. The I/O thread
+ * appends what it reads to a connection's in and calls dispatch(); the
+ * responses show up in out, appended by the workers, which call wake()
+ * then. Tables belong to the connection that created them.
+ */
+class host_server {
+    std::mutex _lock;  // guards out, pending, tasks and closed; the rest belongs to the I/O thread
+    std::function<void()> _wake;
+    int _table_queue;
+    int _max_inflight;
+    size_t _max_unsent;
+    int _next_task;
+    task_pool _workers;  // last, so that it is gone before what its tasks use
+
+    void reply(host_connection& c, int id, game_error res, const std::string& results = "");
+    game_error new_table(host_connection& c, decoder& args, encoder& results);
+    void handle(const std::shared_ptr<host_connection>& c, const std::string& payload);
+
+public:
+    // table_queue: pending requests a table holds before HST_TABLE_BUSY;
+    // max_inflight, max_unsent: a connection is not read past these
+    host_server(int threads, int table_queue, int max_inflight, size_t max_unsent, std::function<void()> wake);
+
+    std::mutex& lock() { return _lock; }
+    task_pool& workers() { return _workers; }
+
+    // called with lock() held
+    bool accepting(const host_connection& c);
+
+    // handles the whole frames in c.in while c takes requests;
+    // false if the connection must be closed
+    bool dispatch(const std::shared_ptr<host_connection>& c);
+
+    // drops the requests of c not started yet; the running ones complete
+    // without a response
+    void close(host_connection& c);
+};
+
+/*
+ * The I/O loop of poker-host. Accepts connections on listener, -1 for none,
+ * and serves them and the sockets in fds until stop() is true, which is
+ * checked when something was written to wake_fd. The sockets are closed on
+ * return. A connection is read one chunk per round, and not past one whole
+ * frame while its requests are not taken.
+ */
+void serve(host_server& server, int listener, int wake_fd, const std::vector<int>& fds, std::function<bool()> stop);
+
+}  // namespace poker
+
+#endif  // HOST_SERVER_H
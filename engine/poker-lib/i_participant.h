@@ -44,6 +44,10 @@ class i_participant {
     virtual game_error verify_card_secret(int card_index, blob& their_proof) = 0;
     virtual game_error open_card(int card_index) = 0;
     virtual size_t get_open_card(int card_index) = 0;
+
+    // State, to resume a game where it was saved
+    virtual game_error save(std::ostream& out) = 0;
+    virtual game_error load(std::istream& in) = 0;
 };
 
 }  // namespace poker
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "compression.h"
+#include "game-generator.h"
+#include "poker-lib.h"
+
+using namespace poker;
+
+/*
+   Trains a raw brotli dictionary for the game messages and writes it as a
+   C++ source (see compression-dictionary.cpp).
+
+   Usage: make-dictionary <output.cpp> <variable> [turn-data.raw ...]
+
+   Without turn-data files, games are produced by game_generator. Only
+   structure shared by several games is kept: message prefixes, field
+   separators and the libTMCG serialization tokens. Proof and key material
+   is random and would only waste dictionary space; it is cut out before
+   counting, as games recorded from the same fixtures share some of it.
+*/
+
+const size_t min_fragment_size = 3;
+const int generated_games = 8;
+const size_t max_dictionary_size = 16 * 1024;
+
+typedef std::vector<std::string> game_messages;
+
+static bool is_material(char c) {
+    return isalnum((unsigned char)c) || c == '+' || c == '/' || c == '=';
+}
+
+// The message without its material: the runs of base64 and hex digits that
+// start a field or a line. A run followed by '^' is a libTMCG tag ("stk^").
+static std::vector<std::string> fragments(const std::string& msg) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    for (size_t i = 0; i < msg.size(); i++) {
+        if (!is_material(msg[i]) || (i && msg[i - 1] != '|' && msg[i - 1] != '\n'))
+            continue;
+        size_t end = i;
+        while (end < msg.size() && is_material(msg[end]))
+            end++;
+        if (end < msg.size() && msg[end] == '^')
+            continue;
+        if (i - start >= min_fragment_size)
+            out.push_back(msg.substr(start, i - start));
+        start = end;
+        i = end - 1;
+    }
+    if (msg.size() - start >= min_fragment_size)
+        out.push_back(msg.substr(start));
+    return out;
+}
+
+static game_error load_game(const char* path, game_messages& game) {
+    game_error res;
+    std::ifstream is(path, std::ios::binary);
+    std::string msg;
+    while (SUCCESS == (res = unwrap_and_decompress_next(is, msg)))
+        game.push_back(msg);
+    return res == END_OF_STREAM ? SUCCESS : res;
+}
+
+static game_error generate_game(int last_aggressor, game_messages& game) {
+    game_error res;
+    game_generator gen;
+    gen.last_aggressor = last_aggressor;
+    if ((res = gen.generate()))
+        return res;
+    for (auto& turn : gen.turns) {
+        std::string msg;
+        if ((res = unwrap_and_decompress(std::get<1>(turn), msg)))
+            return res;
+        game.push_back(msg);
+    }
+    return SUCCESS;
+}
+
+int main(int argc, char** argv) {
+    game_error res;
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <output.cpp> <variable> [turn-data.raw ...]\n", argv[0]);
+        exit(-1);
+    }
+    poker_lib_options opts;
+    opts.compression_dictionary = NO_DICTIONARY;
+    init_poker_lib(&opts);
+
+    std::vector<game_messages> games;
+    for (int i = 3; i < argc; i++) {
+        games.push_back(game_messages());
+        if ((res = load_game(argv[i], games.back()))) {
+            std::cerr << "Error " << res << " loading " << argv[i] << std::endl;
+            exit(-1);
+        }
+    }
+    for (int i = 0; argc == 3 && i < generated_games; i++) {
+        games.push_back(game_messages());
+        if ((res = generate_game(i % 3 - 1, games.back()))) {
+            std::cerr << "Error " << res << " generating game" << std::endl;
+            exit(-1);
+        }
+    }
+
+    // the structural fragments of each message, by the games they show up in
+    // and the bytes they cover
+    std::map<std::string, std::set<int>> games_of;
+    std::map<std::string, long> covered;
+    for (size_t g = 0; g < games.size(); g++)
+        for (auto& msg : games[g])
+            for (auto& f : fragments(msg)) {
+                games_of[f].insert(g);
+                covered[f] += f.size();
+            }
+    size_t min_frequency = std::max(2, (int)games.size() / 2);
+
+    // brotli prefers the end of the dictionary: best segments go last
+    std::vector<std::pair<long, std::string>> ranked;
+    for (auto& f : covered)
+        if (games_of[f.first].size() >= min_frequency)
+            ranked.push_back(std::make_pair(f.second, f.first));
+    std::sort(ranked.begin(), ranked.end());
+    std::string dictionary;
+    for (auto it = ranked.rbegin(); it != ranked.rend(); ++it) {
+        if (dictionary.size() + it->second.size() > max_dictionary_size)
+            break;
+        if (dictionary.find(it->second) != std::string::npos)
+            continue;
+        dictionary = it->second + dictionary;
+    }
+
+    std::ofstream os(argv[1]);
+    os << "// Generated by make-dictionary from " << games.size() << " games. Do not edit:\n"
+       << "// dictionaries are referenced by id from existing game logs.\n\n"
+       << "namespace poker {\n\n"
+       << "extern const unsigned char " << argv[2] << "[];\n"
+       << "extern const unsigned int " << argv[2] << "_len;\n\n"
+       << "const unsigned char " << argv[2] << "[] = {";
+    for (size_t i = 0; i < dictionary.size(); i++) {
+        if (i % 16 == 0)
+            os << "\n   ";
+        char tmp[8];
+        snprintf(tmp, sizeof(tmp), " 0x%02x,", (unsigned char)dictionary[i]);
+        os << tmp;
+    }
+    os << "\n};\n\n"
+       << "const unsigned int " << argv[2] << "_len = " << dictionary.size() << ";\n\n"
+       << "}  // namespace poker\n";
+
+    std::cout << "Dictionary: " << dictionary.size() << " bytes from " << games.size() << " games" << std::endl;
+    return 0;
+}
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+/*
+   Generates the rating tables of the built-in hand evaluator (see
+   hand-evaluator.h) as a C++ source. Run on the build host: it depends on
+   nothing else in poker-lib.
+
+   Usage: make-hand-tables <output.cpp>
+
+   Every 5-card hand is keyed by its category and the ranks deciding ties,
+   and the keys are numbered in order, from 1 for the worst hand. Larger
+   hands take the best rating of their 5-card subsets.
+*/
+
+const int ranks = 13;
+const int max_count = 4;   // cards of a rank
+const int min_cards = 5;
+const int max_cards = 7;
+const int hand_classes = 7462;
+
+enum category { HIGH_CARD, PAIR, TWO_PAIR, TRIPS, STRAIGHT, FLUSH, FULL_HOUSE, QUADS, STRAIGHT_FLUSH, CATEGORIES };
+
+typedef std::vector<int> rank_counts;
+
+static std::vector<long> keys;  // sorted, the rating of a key is its position + 1
+
+// ranks that decide among hands of a category, most significant first
+static long hand_key(const rank_counts& counts, bool flush) {
+    std::vector<std::pair<int, int>> groups;  // (count, rank)
+    for (int r = ranks - 1; r >= 0; r--)
+        if (counts[r])
+            groups.push_back(std::make_pair(counts[r], r));
+    std::stable_sort(groups.begin(), groups.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return a.first > b.first;
+    });
+
+    int straight_high = -1;
+    if (groups.size() == 5) {
+        if (groups[0].second - groups[4].second == 4)
+            straight_high = groups[0].second;
+        else if (groups[0].second == 12 && groups[1].second == 3)  // 5-4-3-2-A
+            straight_high = 3;
+    }
+
+    int cat;
+    if (straight_high >= 0)
+        cat = flush ? STRAIGHT_FLUSH : STRAIGHT;
+    else if (flush)
+        cat = FLUSH;
+    else if (groups[0].first == 4)
+        cat = QUADS;
+    else if (groups[0].first == 3)
+        cat = groups[1].first == 2 ? FULL_HOUSE : TRIPS;
+    else if (groups[0].first == 2)
+        cat = groups[1].first == 2 ? TWO_PAIR : PAIR;
+    else
+        cat = HIGH_CARD;
+
+    long key = cat;
+    if (straight_high >= 0) {
+        key = key << 4 | straight_high;
+    } else {
+        for (auto& g : groups)
+            key = key << 4 | g.second;
+    }
+    // same width for every category
+    for (int i = straight_high >= 0 ? 1 : (int)groups.size(); i < 5; i++)
+        key <<= 4;
+    return key;
+}
+
+static int rating(const rank_counts& counts, bool flush) {
+    auto key = hand_key(counts, flush);
+    auto it = std::lower_bound(keys.begin(), keys.end(), key);
+    if (it == keys.end() || *it != key) {
+        fprintf(stderr, "Hand key %lx not found\n", key);
+        exit(-1);
+    }
+    return (int)(it - keys.begin()) + 1;
+}
+
+// calls f with every rank_counts of the given size, in lexicographic order
+template <typename F>
+static void for_each_counts(rank_counts& counts, int pos, int remaining, F f) {
+    if (pos == ranks) {
+        if (!remaining)
+            f(counts);
+        return;
+    }
+    for (int c = 0; c <= max_count && c <= remaining; c++) {
+        counts[pos] = c;
+        for_each_counts(counts, pos + 1, remaining - c, f);
+    }
+    counts[pos] = 0;
+}
+
+// best rating among the 5-card subsets of a hand without a flush
+static int best_rating(const rank_counts& hand, rank_counts& subset, int pos, int remaining) {
+    if (!remaining)
+        return rating(subset, false);
+    if (pos == ranks)
+        return 0;
+    int best = 0;
+    for (int c = 0; c <= hand[pos] && c <= remaining; c++) {
+        subset[pos] = c;
+        best = std::max(best, best_rating(hand, subset, pos + 1, remaining - c));
+    }
+    subset[pos] = 0;
+    return best;
+}
+
+static int bits(int mask) {
+    int n = 0;
+    for (; mask; mask &= mask - 1)
+        n++;
+    return n;
+}
+
+static rank_counts mask_counts(int mask) {
+    rank_counts counts(ranks, 0);
+    for (int r = 0; r < ranks; r++)
+        counts[r] = (mask >> r) & 1;
+    return counts;
+}
+
+// number of rank counts of the given length adding up to sum
+static long sequences(int length, int sum) {
+    if (sum < 0)
+        return 0;
+    std::vector<std::vector<long>> n(length + 1, std::vector<long>(sum + 1, 0));
+    n[0][0] = 1;
+    for (int l = 1; l <= length; l++)
+        for (int s = 0; s <= sum; s++)
+            for (int c = 0; c <= max_count && c <= s; c++)
+                n[l][s] += n[l - 1][s - c];
+    return n[length][sum];
+}
+
+// one more entry than values, so 32-bit gathers may load the last one
+static void write_table(std::ofstream& out, const char* name, std::vector<int> values) {
+    values.push_back(0);
+    out << "extern const unsigned short " << name << "[];\n";
+    out << "const unsigned short " << name << "[" << values.size() << "] = {";
+    for (size_t i = 0; i < values.size(); i++) {
+        if (i % 16 == 0)
+            out << "\n   ";
+        out << " " << values[i] << ",";
+    }
+    out << "\n};\n\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <output.cpp>\n", argv[0]);
+        exit(-1);
+    }
+
+    // every 5-card hand
+    rank_counts counts(ranks, 0);
+    for_each_counts(counts, 0, min_cards, [](const rank_counts& c) {
+        keys.push_back(hand_key(c, false));
+    });
+    for (int mask = 0; mask < (1 << ranks); mask++)
+        if (bits(mask) == min_cards)
+            keys.push_back(hand_key(mask_counts(mask), true));
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    if (keys.size() != hand_classes) {
+        fprintf(stderr, "Found %d hand classes, expected %d\n", (int)keys.size(), hand_classes);
+        exit(-1);
+    }
+
+    std::ofstream out(argv[1]);
+    out << "// Generated by make-hand-tables. Do not edit.\n\n";
+    out << "namespace poker {\n\n";
+
+    // lowest rating of each category
+    std::vector<int> floors;
+    for (int cat = 0; cat < CATEGORIES; cat++)
+        floors.push_back((int)(std::lower_bound(keys.begin(), keys.end(), (long)cat << 20) - keys.begin()) + 1);
+    write_table(out, "hand_category_floors", floors);
+
+    // hands with 5 or more cards of a suit, by the ranks of that suit
+    std::vector<int> flushes(1 << ranks, 0);
+    for (int mask = 0; mask < (1 << ranks); mask++) {
+        int n = bits(mask);
+        if (n < min_cards || n > max_cards)
+            continue;
+        for (int sub = mask; sub; sub = (sub - 1) & mask)
+            if (bits(sub) == min_cards)
+                flushes[mask] = std::max(flushes[mask], rating(mask_counts(sub), true));
+    }
+    write_table(out, "hand_flush_ratings", flushes);
+
+    // minimal perfect hash of the rank counts: hands of a size are numbered
+    // in lexicographic order, by adding the number of hands with a lower
+    // count at each rank, see hand-evaluator.cpp
+    std::vector<int> hash;
+    for (int pos = 0; pos < ranks; pos++)
+        for (int remaining = 0; remaining <= max_cards; remaining++)
+            for (int c = 0; c <= max_count; c++) {
+                long n = 0;
+                for (int lower = 0; lower < c; lower++)
+                    n += sequences(ranks - pos - 1, remaining - lower);
+                hash.push_back((int)n);
+            }
+    write_table(out, "hand_rank_hash", hash);
+
+    for (int size = min_cards; size <= max_cards; size++) {
+        std::vector<int> ratings;
+        for_each_counts(counts, 0, size, [&](const rank_counts& c) {
+            rank_counts subset(ranks, 0);
+            ratings.push_back(best_rating(c, subset, 0, min_cards));
+        });
+        if ((long)ratings.size() != sequences(ranks, size)) {
+            fprintf(stderr, "Found %d hands of %d cards\n", (int)ratings.size(), size);
+            exit(-1);
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "hand_rank_ratings_%d", size);
+        write_table(out, name, ratings);
+    }
+
+    out << "}  // namespace poker\n";
+    if (!out.good()) {
+        fprintf(stderr, "Error writing %s\n", argv[1]);
+        exit(-1);
+    }
+    return 0;
+}
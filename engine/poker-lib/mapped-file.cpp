@@ -0,0 +1,63 @@
+#include "mapped-file.h"
+
+#include <fstream>
+#include <sstream>
+
+#ifndef WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace poker {
+
+mapped_file::mapped_file() : _data(NULL), _size(0), _mapping(NULL) {
+}
+
+mapped_file::~mapped_file() {
+    close();
+}
+
+bool mapped_file::open(const char* path) {
+    close();
+#ifndef WINDOWS
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::close(fd);
+            _mapping = p;
+            _data = (const char*)p;
+            _size = st.st_size;
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+    std::ifstream is(path, std::ios::binary);
+    if (!is.good())
+        return false;
+    std::ostringstream os;
+    os << is.rdbuf();
+    _contents = os.str();
+    _data = _contents.data();
+    _size = _contents.size();
+    return true;
+}
+
+void mapped_file::close() {
+#ifndef WINDOWS
+    if (_mapping)
+        munmap(_mapping, _size);
+#endif
+    _mapping = NULL;
+    _contents.clear();
+    _data = NULL;
+    _size = 0;
+}
+
+}  // namespace poker
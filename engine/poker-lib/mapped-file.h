@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+
+namespace poker {
+
+/*
+ * Read-only view of a whole file. Memory-mapped where available, so that
+ * large drives are paged in on demand; read into memory otherwise.
+ */
+class mapped_file {
+    const char* _data;
+    size_t _size;
+    void* _mapping;
+    std::string _contents;  // fallback when the file cannot be mapped
+
+public:
+    mapped_file();
+    ~mapped_file();
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    bool open(const char* path);
+    void close();
+    const char* data() const { return _data; }
+    size_t size() const { return _size; }
+};
+
+}  // namespace poker
+
+#endif
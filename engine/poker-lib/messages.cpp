@@ -38,6 +38,18 @@ game_error message::decode(std::istream& is, message** msg) {
         case MSG_CARD_PROOF:
             m = new msg_card_proof();
             break;
+        case MSG_SHORT_VTMF:
+            m = new msg_short_vtmf();
+            break;
+        case MSG_SHORT_VTMF_RESPONSE:
+            m = new msg_short_vtmf_response();
+            break;
+        case MSG_ALICE_MIX:
+            m = new msg_alice_mix();
+            break;
+        case MSG_ALICE_PRIVATE_CARDS:
+            m = new msg_alice_private_cards();
+            break;
         default:
             return COD_INVALID_MSG_TYPE;
     }
@@ -64,7 +76,7 @@ game_error message::read(std::istream& is)  {
     decoder in(is);
     // _msgtype has already been read by message::decode()
     if ((res=in.read(_version))) return res;
-    if (_version != poker_version) return COD_VERSION_MISMATCH;
+    if (_version < min_poker_version || _version > poker_version) return COD_VERSION_MISMATCH;
     if ((res=in.read(player_id))) return res;
     return SUCCESS;
 }
@@ -72,6 +84,9 @@ game_error message::read(std::istream& is)  {
 msg_vtmf::msg_vtmf() : message(MSG_VTMF) {
 }
 
+msg_vtmf::msg_vtmf(message_type t) : message(t) {
+}
+
 game_error msg_vtmf::write(std::ostream& os)  {
     game_error res;
     if ((res=message::write(os))) return res;
@@ -165,6 +180,9 @@ std::string msg_vsshe::to_string() {
 msg_vsshe_response::msg_vsshe_response() : message(MSG_VSSHE_RESPONSE) {
 }
 
+msg_vsshe_response::msg_vsshe_response(message_type t) : message(t) {
+}
+
 game_error msg_vsshe_response::write(std::ostream& os)  {
     game_error res;
     if ((res=message::write(os))) return res;
@@ -194,6 +212,9 @@ std::string msg_vsshe_response::to_string() {
 msg_bob_private_cards::msg_bob_private_cards() : message(MSG_BOB_PRIVATE_CARDS) {
 }
 
+msg_bob_private_cards::msg_bob_private_cards(message_type t) : message(t) {
+}
+
 game_error msg_bob_private_cards::write(std::ostream& os)  {
     game_error res;
     if ((res=message::write(os))) return res;
@@ -245,7 +266,7 @@ game_error msg_bet_request::read(std::istream& is)  {
 std::string msg_bet_request::to_string() {
     std::stringstream ss;
     ss << "msg_bet_request player:" << player_id
-       << " type:" << type << " amt: " << (int)amt;
+       << " type:" << type << " amt: " << amt;
     return ss.str();
 }
 
@@ -282,5 +303,90 @@ std::string msg_card_proof::to_string() {
     return ss.str();
 }
 
+msg_short_vtmf::msg_short_vtmf() : msg_vtmf(MSG_SHORT_VTMF) {
+}
+
+std::string msg_short_vtmf::to_string() {
+    return "msg_short_vtmf";
+}
+
+msg_short_vtmf_response::msg_short_vtmf_response() : message(MSG_SHORT_VTMF_RESPONSE) {
+}
+
+game_error msg_short_vtmf_response::write(std::ostream& os)  {
+    game_error res;
+    if ((res=message::write(os))) return res;
+
+    encoder out(os);
+    if ((res=out.write(alice_money))) return res;
+    if ((res=out.write(bob_money))) return res;
+    if ((res=out.write(big_blind))) return res;
+    if ((res=out.write(bob_key))) return res;
+    if ((res=out.write(vsshe))) return res;
+    if ((res=out.write(stack))) return res;
+    if ((res=out.write(stack_proof))) return res;
+    return SUCCESS;
+}
+
+game_error msg_short_vtmf_response::read(std::istream& is)  {
+    game_error res;
+    if ((res=message::read(is))) return res;
+
+    decoder in(is);
+    if ((res=in.read(alice_money))) return res;
+    if ((res=in.read(bob_money))) return res;
+    if ((res=in.read(big_blind))) return res;
+    if ((res=in.read(bob_key))) return res;
+    if ((res=in.read(vsshe))) return res;
+    if ((res=in.read(stack))) return res;
+    if ((res=in.read(stack_proof))) return res;
+    return SUCCESS;
+}
+
+std::string msg_short_vtmf_response::to_string() {
+    return "msg_short_vtmf_response";
+}
+
+msg_alice_mix::msg_alice_mix() : msg_vsshe_response(MSG_ALICE_MIX) {
+}
+
+std::string msg_alice_mix::to_string() {
+    return "msg_alice_mix";
+}
+
+msg_alice_private_cards::msg_alice_private_cards() : msg_bob_private_cards(MSG_ALICE_PRIVATE_CARDS) {
+}
+
+std::string msg_alice_private_cards::to_string() {
+    return "msg_alice_private_cards";
+}
+
+game_error write_runout_proofs(blob& dst, blob& public_proofs, blob& private_proofs) {
+    game_error res;
+    std::ostringstream os;
+    encoder out(os);
+    if ((res=out.write(public_proofs))) return res;
+    if ((res=out.write(private_proofs))) return res;
+    dst.set_data(os.str());
+    return SUCCESS;
+}
+
+game_error read_runout_proofs(blob& src, blob& public_proofs, blob& private_proofs) {
+    game_error res;
+    std::istringstream is(src.str());
+    decoder in(is);
+    if ((res=in.read(public_proofs))) return res;
+    if ((res=in.read(private_proofs))) return res;
+    return SUCCESS;
+}
+
+game_error check_version(message* msg, game_state& g) {
+    if (msg->type() == MSG_VTMF || msg->type() == MSG_SHORT_VTMF) {
+        g.version = msg->version();
+        return SUCCESS;
+    }
+    return msg->version() == g.version ? SUCCESS : COD_VERSION_MISMATCH;
+}
+
 } // namespace poker
 
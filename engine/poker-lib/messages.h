@@ -3,6 +3,8 @@
 
 #include "common.h"
 #include "codec.h"
+#include "game-arena.h"
+#include "game-state.h"
 
 namespace poker {
 
@@ -22,12 +24,17 @@ namespace poker {
 
        message_type type() { return _msgtype; }
        int version() { return _version; }
+       void set_version(int version) { _version = version; }
        
        virtual game_error write(std::ostream& os);
        virtual game_error read(std::istream& is);
        virtual std::string to_string() = 0;
 
        static game_error decode(std::istream& is, message** msg);
+
+       // from the current game arena, if any
+       static void* operator new(size_t size) { return arena_allocate(size); }
+       static void operator delete(void* p, size_t size) { arena_free(p, size); }
    };
 
    class msg_vtmf : public message {
@@ -43,6 +50,8 @@ namespace poker {
        game_error write(std::ostream& os) override;
        game_error read(std::istream& is) override;
        std::string to_string() override;
+   protected:
+       msg_vtmf(message_type t);
    };
 
    class msg_vtmf_response : public message {
@@ -83,6 +92,8 @@ namespace poker {
        game_error write(std::ostream& os) override;
        game_error read(std::istream& is) override;
        std::string to_string() override;
+   protected:
+       msg_vsshe_response(message_type t);
    };
 
    class msg_bob_private_cards : public message {
@@ -94,6 +105,8 @@ namespace poker {
        game_error write(std::ostream& os) override;
        game_error read(std::istream& is) override;
        std::string to_string() override;
+   protected:
+       msg_bob_private_cards(message_type t);
    };
 
    class msg_bet_request : public message {
@@ -123,6 +136,67 @@ namespace poker {
        std::string to_string() override;
    };
 
+   /*
+    *  Short handshake: four messages instead of five. Alice sends the group
+    *  and her key as in msg_vtmf; Bob answers with his key, the VSSHE group
+    *  and the first mix; Alice with the second mix and the proofs of Bob's
+    *  cards; Bob with the proofs of Alice's cards.
+   */
+   class msg_short_vtmf : public msg_vtmf {
+   public:
+       msg_short_vtmf();
+       virtual ~msg_short_vtmf() { }
+       std::string to_string() override;
+   };
+
+   class msg_short_vtmf_response : public message {
+   public:
+       money_t alice_money;
+       money_t bob_money;
+       money_t big_blind;
+       blob bob_key;
+       blob vsshe;
+       blob stack;
+       blob stack_proof;
+
+       msg_short_vtmf_response();
+       virtual ~msg_short_vtmf_response() { }
+       game_error write(std::ostream& os) override;
+       game_error read(std::istream& is) override;
+       std::string to_string() override;
+   };
+
+   // stack, stack_proof and cards_proof of Bob's private cards
+   class msg_alice_mix : public msg_vsshe_response {
+   public:
+       msg_alice_mix();
+       virtual ~msg_alice_mix() { }
+       std::string to_string() override;
+   };
+
+   class msg_alice_private_cards : public msg_bob_private_cards {
+   public:
+       msg_alice_private_cards();
+       virtual ~msg_alice_private_cards() { }
+       std::string to_string() override;
+   };
+
+   /*
+    *  Proofs of an all-in runout (see referee::step_runout), carried in the
+    *  cards_proof of the bet ending the betting and of its response: the
+    *  sender's proofs of the public cards still closed, then of its own
+    *  private cards
+   */
+   game_error write_runout_proofs(blob& dst, blob& public_proofs, blob& private_proofs);
+   game_error read_runout_proofs(blob& src, blob& public_proofs, blob& private_proofs);
+
+   /*
+    *  The game is played at the version of Alice's first message, which
+    *  every later message must carry: an older Alice gets the betting of
+    *  her version from a newer Bob. Sets g.version from that first message.
+   */
+   game_error check_version(message* msg, game_state& g);
+
 } //namespace poker
 
 #endif
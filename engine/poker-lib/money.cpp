@@ -0,0 +1,169 @@
+#include "money.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace poker {
+
+int money::compare(const money& other) const {
+    for (int i = words - 1; i >= 0; i--)
+        if (_w[i] != other._w[i])
+            return _w[i] < other._w[i] ? -1 : 1;
+    return 0;
+}
+
+money money::operator / (uint32_t divisor) const {
+    money q;
+    uint64_t r = 0;
+    for (int i = words - 1; i >= 0; i--) {
+        r = (r << 32) | _w[i];
+        q._w[i] = (uint32_t)(r / divisor);
+        r %= divisor;
+    }
+    return q;
+}
+
+bool money::to_uint64(uint64_t& v) const {
+    for (int i = 2; i < words; i++)
+        if (_w[i])
+            return false;
+    v = (uint64_t)_w[1] << 32 | _w[0];
+    return true;
+}
+
+bool checked_add(const money& a, const money& b, money& sum) {
+    money s;
+    uint64_t carry = 0;
+    for (int i = 0; i < money::words; i++) {
+        uint64_t t = (uint64_t)a._w[i] + b._w[i] + carry;
+        s._w[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    if (carry)
+        return false;
+    sum = s;
+    return true;
+}
+
+bool checked_sub(const money& a, const money& b, money& difference) {
+    if (a < b)
+        return false;
+    money d;
+    int64_t borrow = 0;
+    for (int i = 0; i < money::words; i++) {
+        int64_t t = (int64_t)a._w[i] - b._w[i] - borrow;
+        borrow = t < 0;
+        d._w[i] = (uint32_t)(t + (borrow << 32));
+    }
+    difference = d;
+    return true;
+}
+
+std::string money::to_string(int base) const {
+    static const char digits[] = "0123456789abcdef";
+    if (base < 2 || base > 16)
+        return "";
+    std::string s;
+    money v = *this;
+    do {
+        uint64_t r = 0;
+        for (int i = words - 1; i >= 0; i--) {
+            r = (r << 32) | v._w[i];
+            v._w[i] = (uint32_t)(r / base);
+            r %= base;
+        }
+        s += digits[r];
+    } while (v != 0);
+    std::reverse(s.begin(), s.end());
+    return s;
+}
+
+game_error money::parse_string(const char* s, int base) {
+    if (!s || !*s || base < 2 || base > 16)
+        return BIG_UNPARSEABLE;
+    money v;
+    for (; *s; s++) {
+        int d;
+        if (*s >= '0' && *s <= '9')
+            d = *s - '0';
+        else if (*s >= 'a' && *s <= 'f')
+            d = *s - 'a' + 10;
+        else if (*s >= 'A' && *s <= 'F')
+            d = *s - 'A' + 10;
+        else
+            return BIG_UNPARSEABLE;
+        if (d >= base)
+            return BIG_UNPARSEABLE;
+        // v = v * base + d
+        uint64_t carry = d;
+        for (int i = 0; i < words; i++) {
+            uint64_t t = (uint64_t)v._w[i] * base + carry;
+            v._w[i] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        if (carry)
+            return BIG_OVERFLOW;
+    }
+    *this = v;
+    return SUCCESS;
+}
+
+// byte i of the value, counting from the least significant
+static inline uint8_t byte_at(const uint32_t* w, int i) {
+    return (uint8_t)(w[i / 4] >> (8 * (i % 4)));
+}
+
+game_error money::load_binary_be(const char* data, int len) {
+    auto udata = (const unsigned char*)data;
+    money v;
+    for (int i = 0; i < len; i++) {
+        int pos = len - 1 - i;  // from the least significant byte
+        if (pos >= 4 * words) {
+            if (udata[i])
+                return BIG_OVERFLOW;
+            continue;
+        }
+        v._w[pos / 4] |= (uint32_t)udata[i] << (8 * (pos % 4));
+    }
+    *this = v;
+    return SUCCESS;
+}
+
+game_error money::store_binary_be(char* data, int len) const {
+    for (int i = len; i < 4 * words; i++)
+        if (byte_at(_w, i))
+            return BIG_OVERFLOW;
+    for (int i = 0; i < len; i++) {
+        int pos = len - 1 - i;
+        data[i] = pos < 4 * words ? (char)byte_at(_w, pos) : 0;
+    }
+    return SUCCESS;
+}
+
+game_error money::read_binary_be(std::istream& in, int len) {
+    if (!in.good() || len < 0)
+        return BIG_READ_ERROR;
+    std::vector<char> tmp(len);
+    if (len && !in.read(tmp.data(), len))
+        return BIG_READ_ERROR;
+    return load_binary_be(tmp.data(), len);
+}
+
+game_error money::write_binary_be(std::ostream& out, int len) const {
+    game_error res;
+    if (!out.good() || len < 0)
+        return BIG_WRITE_ERROR;
+    std::vector<char> tmp(len);
+    if ((res = store_binary_be(tmp.data(), len)))
+        return res;
+    if (!out.write(tmp.data(), len))
+        return BIG_WRITE_ERROR;
+    return SUCCESS;
+}
+
+std::ostream& operator << (std::ostream &out, const money& v) {
+    out << v.to_string();
+    return out;
+}
+
+}
@@ -0,0 +1,61 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include "common.h"
+
+namespace poker {
+
+/*
+ * Unsigned 256-bit amount, as held by the contracts (uint256).
+ * A fixed array of words: copies never allocate, so game_state stays
+ * trivially copyable. Arithmetic is checked, see checked_add() and
+ * checked_sub(); conversions to narrower types are explicit.
+ */
+class money {
+    static const int words = 8;
+    uint32_t _w[words];  // little-endian 32-bit words
+
+public:
+    money(uint64_t v = 0) : _w{(uint32_t)v, (uint32_t)(v >> 32), 0, 0, 0, 0, 0, 0} { }
+
+    int compare(const money& other) const;
+    bool operator == (const money& other) const { return 0 == compare(other); }
+    bool operator != (const money& other) const { return 0 != compare(other); }
+    bool operator > (const money& other) const { return 0 < compare(other); }
+    bool operator >= (const money& other) const { return 0 <= compare(other); }
+    bool operator < (const money& other) const { return 0 > compare(other); }
+    bool operator <= (const money& other) const { return 0 >= compare(other); }
+
+    // rounds down; divisor must not be zero
+    money operator / (uint32_t divisor) const;
+
+    // false if the amount does not fit
+    bool to_uint64(uint64_t& v) const;
+
+    std::string to_string(int base=10) const;
+    game_error parse_string(const char* s, int base=10);
+    // BIG_OVERFLOW when the amount does not fit in the other side
+    game_error load_binary_be(const char* data, int len);
+    game_error store_binary_be(char* data, int len) const;
+    game_error read_binary_be(std::istream& in, int len);
+    game_error write_binary_be(std::ostream& out, int len) const;
+
+    friend bool checked_add(const money& a, const money& b, money& sum);
+    friend bool checked_sub(const money& a, const money& b, money& difference);
+};
+
+// false on overflow, or when b > a; the result is only written on success
+bool checked_add(const money& a, const money& b, money& sum);
+bool checked_sub(const money& a, const money& b, money& difference);
+
+typedef money money_t;
+
+std::ostream& operator << (std::ostream &out, const money& v);
+
+}
+
+#endif
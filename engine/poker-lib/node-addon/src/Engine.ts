@@ -13,6 +13,9 @@ export interface Engine {
     create_bet(type: bet_type, amount: BigNumber): Promise<EngineResult>;
     process_bet(message_in: Uint8Array): Promise<EngineResult>;
     game_state(): Promise<game_state>;
+    save(): Promise<Uint8Array>;
+    load(snapshot: Uint8Array): Promise<EngineResult>;
+    equity(options?: EquityOptions): Promise<EngineEquity>;
     on_game_over(): void;
 }
 
@@ -23,6 +26,23 @@ interface EngineResult {
     message_out?: Uint8Array;
 }
 
+// Monte Carlo settings, see equity.h
+interface EquityOptions {
+    maxSamples?: number;
+    precision?: number;
+    seed?: number;
+    threads?: number;
+}
+
+// chances of the player's hand at showdown, from the cards known so far
+interface EngineEquity {
+    status: game_error;
+    win?: number;
+    tie?: number;
+    loss?: number;
+    samples?: number;
+}
+
 interface game_state {
     step: number;
     current_player: number;
@@ -98,10 +118,15 @@ const enum game_error {
     PRR_ALICE_MONEY_DIVERGES,
     PRR_BOB_MONEY_DIVERGES,
     PRR_BIG_BLIND_DIVERGES,
+    PRR_INVALID_SNAPSHOT,
+    PRR_BATCH_INTERRUPTED,
 
     // solver errors
     SRR_UNKNOWN_CARD = 300,
     SRR_DUPLICATE_CARD,
+    SRR_UNSUPPORTED_HAND_SIZE,
+    SRR_BACKEND_UNAVAILABLE,
+    SRR_INVALID_EQUITY_OPTIONS,
 
     // game_state errors
     GRR_INVALID_PLAYER = 400,
@@ -130,6 +155,8 @@ const enum game_error {
     TMC_VERIFYCARDSECRET,
     TMC_INVALID_CARD_INDEX,
     TMC_PROVE_CARD,
+    TMC_RUNTIME_EXCEPTION,
+    TMC_INVALID_STATE,
 
     // Verifier
     PLB_UNKNOWN_MSG_TYPE = 700,
@@ -148,6 +175,7 @@ const enum game_error {
     VRF_INVALID_PLAYER_COUNT,
     BIG_WRITE_ERROR,
     VRF_PLAYER_ADDRESS_NOT_FOUND,
+    BIG_OVERFLOW,
 
     // Compression
     CPR_COMPRESS_INIT = 900,
@@ -159,12 +187,38 @@ const enum game_error {
     CPR_PAYLOAD_TOO_SMALL,
     CPR_UNPARSEABLE_LEN,
     CPR_EOF,
+    CPR_INVALID_OPTIONS,
+    CPR_UNKNOWN_DICTIONARY,
+    CPR_UNEXPECTED_BATCH,
 
     // playback
     PLB_MESSAGE_NOT_FOUND = 1000,
     PLB_CURRENT_PLAYER_MISMATCH,
     PLB_OPEN_ALICE_PRIVATE_CARDS,
     PLB_OPEN_BOB_PRIVATE_CARDS,
+    PLB_INVALID_CHECKPOINT,
+    PLB_CHECKPOINT_SEEK,
+    PLB_FRAME_NOT_FOUND,
+
+    // C API
+    APR_TASK_NOT_FOUND = 1100,
+    APR_TASK_STARTED,
+    APR_CANCELLED,
+    APR_NO_COMPLETION,
+    APR_WORKERS_RUNNING,
+    APR_BUFFER_TOO_SMALL,
+    APR_NO_MESSAGE,
+    APR_WORKERS_STOPPING,
+    APR_WORKER_THREAD,
+    APR_MESSAGE_PENDING,
+
+    // host
+    HST_UNKNOWN_OP = 1200,
+    HST_TABLE_NOT_FOUND,
+    HST_TABLE_BUSY,
+    HST_FRAME_TOO_BIG,
+    HST_SOCKET_ERROR,
+    HST_CONNECTION_CLOSED,
 }
 
 const enum bet_type {
@@ -194,10 +248,14 @@ const enum game_step {
     RIVER_BET,
     OPEN_OPONENT_CARDS,
     GAME_OVER,
+    BOB_FIRST_MIX,
+    ALICE_LAST_MIX,
 }
 
 export {
     EngineResult,
+    EquityOptions,
+    EngineEquity,
     game_error as StatusCode,
     bet_type as EngineBetType,
     game_state as EngineState,
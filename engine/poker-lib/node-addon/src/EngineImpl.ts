@@ -1,14 +1,24 @@
 import { BigNumber } from "ethers";
-import { Engine, EngineBetType, EngineResult, EngineState, StatusCode } from "./Engine";
+import { Engine, EngineBetType, EngineEquity, EngineResult, EngineState, EquityOptions, StatusCode } from "./Engine";
 
 export class EngineImpl implements Engine {
     private player: any;
     private lib: any;
+    // the last call on the player; the next one starts once it settles
+    private pending: Promise<unknown> = Promise.resolve();
 
     constructor(private player_id: number, lib_path: string = "../../assets/engine/pokerlib") {
         this.lib = require(lib_path);
     }
 
+    // Calls on the player run one at a time, in the order they were made: the
+    // synchronous ones must not touch it while a worker runs a handshake or bet.
+    private serialize<T>(call: () => Promise<T>): Promise<T> {
+        const result = this.pending.then(call);
+        this.pending = result.catch(() => undefined);
+        return result;
+    }
+
     init(
         alice_funds: BigNumber,
         bob_funds: BigNumber,
@@ -16,80 +26,73 @@ export class EngineImpl implements Engine {
         encryption: boolean = true,
         winner: number = -1
     ): Promise<EngineResult> {
-        return new Promise((resolve, reject) => {
+        return this.serialize(() => new Promise<EngineResult>((resolve, reject) => {
             try {
-                this.lib.init(encryption, false, winner);
-                this.player = this.lib.newPlayer(this.player_id);
+                // the engine's own options: the library is shared by every engine of the process
+                this.player = this.lib.newPlayerWithOptions(this.player_id, encryption, winner, false);
                 this.lib.initPlayer(this.player, alice_funds.toString(), bob_funds.toString(), big_blind.toString());
                 resolve({ status: StatusCode.SUCCESS });
             } catch (error) {
                 reject(error);
             }
-        });
+        }));
     }
 
+    // handshakes and bets run on the add-on's worker threads
     create_handshake(): Promise<EngineResult> {
-        return new Promise((resolve, reject) => {
-            try {
-                const msg = this.lib.createHandshake(this.player);
-                resolve({
-                    status: StatusCode.CONTINUED,
-                    message_out: msg,
-                });
-            } catch (error) {
-                reject(error);
-            }
+        return this.serialize(async (): Promise<EngineResult> => {
+            const msg = await this.lib.createHandshake(this.player);
+            return {
+                status: StatusCode.CONTINUED,
+                message_out: msg,
+            };
         });
     }
 
     process_handshake(message_in: Uint8Array): Promise<EngineResult> {
-        return new Promise((resolve) => {
+        return this.serialize(async (): Promise<EngineResult> => {
             try {
-                const result = this.lib.processHandshake(this.player, message_in);
-                resolve({
+                const result = await this.lib.processHandshake(this.player, message_in);
+                return {
                     status: result.continued ? StatusCode.CONTINUED : StatusCode.SUCCESS,
                     message_out: result.response,
-                });
+                };
             } catch (error) {
                 console.error(error);
-                resolve({ status: error.code });
+                return { status: error.code };
             }
         });
     }
 
     create_bet(type: EngineBetType, amount: BigNumber): Promise<EngineResult> {
-        return new Promise((resolve, reject) => {
-            try {
-                const result = this.lib.createBet(this.player, type, amount.toString());
-                resolve({
-                    status: result.continued ? StatusCode.CONTINUED : StatusCode.SUCCESS,
-                    message_out: result.response,
-                });
-            } catch (error) {
-                reject(error);
-            }
+        return this.serialize(async (): Promise<EngineResult> => {
+            const result = await this.lib.createBet(this.player, type, amount.toString());
+            return {
+                status: result.continued ? StatusCode.CONTINUED : StatusCode.SUCCESS,
+                message_out: result.response,
+            };
         });
     }
 
     process_bet(message_in: Uint8Array): Promise<EngineResult> {
-        return new Promise((resolve) => {
+        return this.serialize(async (): Promise<EngineResult> => {
             try {
-                const result = this.lib.processBet(this.player, message_in);
-                resolve({
+                const result = await this.lib.processBet(this.player, message_in);
+                return {
                     status: result.continued ? StatusCode.CONTINUED : StatusCode.SUCCESS,
                     message_out: result.response,
                     betType: result.betType,
                     amount: result.amount,
-                });
+                };
             } catch (error) {
                 console.error(error);
-                resolve({ status: error.code });
+                return { status: error.code };
             }
         });
     }
 
     game_state(): Promise<EngineState> {
-        return new Promise((resolve, reject) => {
+        return this.serialize(() => new Promise<EngineState>((resolve, reject) => {
             try {
                 const stateString = this.lib.getGameState(this.player);
                 const state = JSON.parse(stateString, (key, value) => {
@@ -111,14 +114,58 @@ export class EngineImpl implements Engine {
                 console.error(error);
                 reject(error);
             }
-        });
+        }));
+    }
+
+    save(): Promise<Uint8Array> {
+        return this.serialize(() => new Promise<Uint8Array>((resolve, reject) => {
+            try {
+                resolve(this.lib.savePlayer(this.player));
+            } catch (error) {
+                reject(error);
+            }
+        }));
+    }
+
+    // restores a snapshot taken by save(), on an engine set up with init()
+    load(snapshot: Uint8Array): Promise<EngineResult> {
+        return this.serialize(() => new Promise<EngineResult>((resolve) => {
+            try {
+                this.lib.loadPlayer(this.player, snapshot);
+                resolve({ status: StatusCode.SUCCESS });
+            } catch (error) {
+                console.error(error);
+                resolve({ status: error.code });
+            }
+        }));
     }
 
+    equity(options: EquityOptions = {}): Promise<EngineEquity> {
+        return this.serialize(() => new Promise<EngineEquity>((resolve) => {
+            try {
+                const r = this.lib.computeEquity(
+                    this.player,
+                    options.maxSamples ?? 1000000,
+                    options.precision ?? 0.001,
+                    options.seed ?? 1,
+                    options.threads ?? 0
+                );
+                resolve({ status: StatusCode.SUCCESS, ...r });
+            } catch (error) {
+                console.error(error);
+                resolve({ status: error.code });
+            }
+        }));
+    }
+
+    // the player goes once the calls made before are done
     on_game_over(): void {
-        try {
-            this.lib.deletePlayer(this.player);
-        } catch (error) {
-            console.error(error);
-        }
+        this.serialize(async () => {
+            try {
+                this.lib.deletePlayer(this.player);
+            } catch (error) {
+                console.error(error);
+            }
+        });
     }
 }
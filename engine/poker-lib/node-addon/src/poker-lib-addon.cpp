@@ -1,5 +1,6 @@
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <node_api.h>
 
 #ifdef WINDOWS
@@ -72,6 +73,43 @@ napi_value newPlayer(napi_env env, napi_callback_info info) {
   return rplayer;
 }
 
+// newPlayerWithOptions(player_id, encryption, winner, short_handshake) -> player
+// The options are the player's own: unlike init, nothing changes for the other players.
+napi_value newPlayerWithOptions(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value argv[4];
+  size_t argc = 4;
+  if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
+    return NULL;
+  }
+
+  PAPI_INT player_id, winner;
+  bool encryption, short_handshake;
+  if (napi_ok != (status = napi_get_value_int32(env, argv[0], &player_id)) ||
+      napi_ok != (status = napi_get_value_bool(env, argv[1], &encryption)) ||
+      napi_ok != (status = napi_get_value_int32(env, argv[2], &winner)) ||
+      napi_ok != (status = napi_get_value_bool(env, argv[3], &short_handshake))) {
+      napi_throw_type_error(env, to_string((int)status).c_str(), "Error getting arguments");
+      return NULL;
+  }
+
+  PAPI_PLAYER player = NULL;
+  auto res = papi_new_player_with_options(player_id, encryption, winner, short_handshake, &player);
+  if (res != PAPI_SUCCESS) {
+    napi_throw_type_error(env, to_string((int)res).c_str(), "Error creating player");
+    return NULL;
+  }
+
+  napi_value rplayer;
+  if (napi_ok != (status = napi_create_bigint_uint64(env, (uint64_t)player, &rplayer))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error returning player");
+    return NULL;
+  }
+
+  return rplayer;
+}
+
 static bool get_player(napi_env env, napi_value& src, PAPI_PLAYER& dst) {
   napi_status status;
   bool lossless;
@@ -86,14 +124,19 @@ static bool get_player(napi_env env, napi_value& src, PAPI_PLAYER& dst) {
 
 static bool get_string(napi_env env, napi_value& src, std::string& dst) {
   napi_status status;
-  char tmp[1024];
   size_t len;
-  if (napi_ok != (status = napi_get_value_string_utf8(env, src, tmp, sizeof(tmp), &len))) {
+  if (napi_ok != (status = napi_get_value_string_utf8(env, src, NULL, 0, &len))) {
     napi_throw_type_error(env, to_string((int)status).c_str(), "Error getting string arg");
     return false;
   }
 
-  dst = tmp;
+  // room for the terminator written by napi
+  dst.resize(len + 1);
+  if (napi_ok != (status = napi_get_value_string_utf8(env, src, &dst[0], dst.size(), &len))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error getting string arg");
+    return false;
+  }
+  dst.resize(len);
   return true;
 }
 
@@ -163,7 +206,152 @@ napi_value initPlayer(napi_env env, napi_callback_info info) {
   return NULL;
 }
 
-// createHandshake(player) -> arrayBuffer
+/*
+ * Handshakes and bets compute shuffles and proofs: they run on the libuv
+ * thread pool and return a promise. Messages are passed without copies, the
+ * input buffer being held until the call completes and the output wrapped
+ * in an external buffer. A player must not be used by another call until
+ * its promise settles.
+ */
+enum async_kind { CREATE_HANDSHAKE, PROCESS_HANDSHAKE, CREATE_BET, PROCESS_BET };
+static const char* async_names[] = { "createHandshake", "processHandshake", "createBet", "processBet" };
+
+struct async_call {
+  async_kind kind;
+  const char* error_message;
+  napi_async_work work;
+  napi_deferred deferred;
+  napi_ref msg_in_ref;
+  PAPI_PLAYER player;
+  void* msg_in;
+  size_t msg_in_len;
+  PAPI_INT bet_type;
+  std::string amt;
+  PAPI_ERR res;
+  PAPI_MESSAGE msg_out;
+  PAPI_INT msg_out_len;
+  char amt_out[PAPI_MONEY_LEN];
+
+  async_call(async_kind k, const char* e, PAPI_PLAYER p) : kind(k), error_message(e), work(NULL), deferred(NULL),
+    msg_in_ref(NULL), player(p), msg_in(NULL), msg_in_len(0), bet_type(0), res(PAPI_SUCCESS), msg_out(NULL),
+    msg_out_len(0), amt_out{0} { }
+};
+
+// worker thread: no napi calls here
+static void execute_call(napi_env env, void* data) {
+  auto c = (async_call*)data;
+  switch(c->kind) {
+  case CREATE_HANDSHAKE:
+    c->res = papi_create_handshake(c->player, &c->msg_out, &c->msg_out_len);
+    break;
+  case PROCESS_HANDSHAKE:
+    c->res = papi_process_handshake(c->player, (PAPI_MESSAGE)c->msg_in, c->msg_in_len, &c->msg_out, &c->msg_out_len);
+    break;
+  case CREATE_BET:
+    c->res = papi_create_bet(c->player, c->bet_type, (PAPI_MONEY)c->amt.c_str(), &c->msg_out, &c->msg_out_len);
+    break;
+  case PROCESS_BET:
+    c->res = papi_process_bet(c->player, (PAPI_MESSAGE)c->msg_in, c->msg_in_len, &c->msg_out, &c->msg_out_len,
+                              &c->bet_type, (PAPI_STR)c->amt_out, sizeof(c->amt_out) - 1);
+    break;
+  }
+}
+
+// msg_out as a buffer released by papi_delete_message, null if empty
+static napi_status message_buffer(napi_env env, async_call* c, napi_value* buffer) {
+  if (!c->msg_out_len)
+    return napi_get_null(env, buffer);
+  auto status = napi_create_external_buffer(env, c->msg_out_len, (void*)c->msg_out, finalize_msg, NULL, buffer);
+  if (status == napi_ok)
+    c->msg_out = NULL;
+  return status;
+}
+
+static napi_status call_result(napi_env env, async_call* c, napi_value* result) {
+  napi_status status;
+  napi_value response, continued, vbet_type, vamt;
+  if (napi_ok != (status = message_buffer(env, c, &response)))
+    return status;
+  if (c->kind == CREATE_HANDSHAKE) {
+    *result = response;
+    return napi_ok;
+  }
+
+  if (napi_ok != (status = napi_get_boolean(env, c->res == PAPI_CONTINUED, &continued)) ||
+      napi_ok != (status = napi_create_object(env, result)) ||
+      napi_ok != (status = napi_set_named_property(env, *result, "continued", continued)) ||
+      napi_ok != (status = napi_set_named_property(env, *result, "response", response)))
+    return status;
+  if (c->kind == PROCESS_BET) {
+    if (napi_ok != (status = napi_create_string_utf8(env, c->amt_out, strlen(c->amt_out), &vamt)) ||
+        napi_ok != (status = napi_create_int32(env, c->bet_type, &vbet_type)) ||
+        napi_ok != (status = napi_set_named_property(env, *result, "amount", vamt)) ||
+        napi_ok != (status = napi_set_named_property(env, *result, "betType", vbet_type)))
+      return status;
+  }
+  return napi_ok;
+}
+
+static void reject(napi_env env, napi_deferred deferred, int code, const char* message) {
+  napi_value vcode, vmessage, error;
+  auto scode = to_string(code);
+  napi_create_string_utf8(env, scode.c_str(), scode.size(), &vcode);
+  napi_create_string_utf8(env, message, strlen(message), &vmessage);
+  napi_create_type_error(env, vcode, vmessage, &error);
+  napi_reject_deferred(env, deferred, error);
+}
+
+// main thread: settles the promise and releases the call
+static void complete_call(napi_env env, napi_status status, void* data) {
+  auto c = (async_call*)data;
+  napi_value result;
+  if (c->msg_in_ref)
+    napi_delete_reference(env, c->msg_in_ref);
+  if (status != napi_ok)
+    reject(env, c->deferred, (int)status, "Error running async call");
+  else if (c->res != PAPI_SUCCESS && c->res != PAPI_CONTINUED)
+    reject(env, c->deferred, (int)c->res, c->error_message);
+  else if (napi_ok != (status = call_result(env, c, &result)))
+    reject(env, c->deferred, (int)status, "Error creating result object");
+  else
+    napi_resolve_deferred(env, c->deferred, result);
+
+  if (c->msg_out)
+    papi_delete_message(c->msg_out);
+  napi_delete_async_work(env, c->work);
+  delete c;
+}
+
+// queues the call, keeping msg_in alive until it completes
+static napi_value queue_call(napi_env env, async_call* c, napi_value msg_in) {
+  napi_status status;
+  napi_value promise, name;
+  if ((msg_in && napi_ok != (status = napi_create_reference(env, msg_in, 1, &c->msg_in_ref))) ||
+      napi_ok != (status = napi_create_string_utf8(env, async_names[c->kind], NAPI_AUTO_LENGTH, &name)) ||
+      napi_ok != (status = napi_create_async_work(env, NULL, name, execute_call, complete_call, c, &c->work)) ||
+      napi_ok != (status = napi_create_promise(env, &c->deferred, &promise)) ||
+      napi_ok != (status = napi_queue_async_work(env, c->work))) {
+    if (c->msg_in_ref)
+      napi_delete_reference(env, c->msg_in_ref);
+    if (c->work)
+      napi_delete_async_work(env, c->work);
+    delete c;
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error queueing async call");
+    return NULL;
+  }
+  return promise;
+}
+
+static bool get_message(napi_env env, napi_value& src, async_call* c) {
+  napi_status status;
+  if (napi_ok != (status = napi_get_buffer_info(env, src, &c->msg_in, &c->msg_in_len))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error getting msg_in_len arguments");
+    return false;
+  }
+  return true;
+}
+
+// createHandshake(player) -> Promise<arrayBuffer>
 napi_value createHandshake(napi_env env, napi_callback_info info) {
   napi_status status;
   napi_value argv[1];
@@ -179,24 +367,10 @@ napi_value createHandshake(napi_env env, napi_callback_info info) {
     return NULL;
   }
 
-  PAPI_MESSAGE msg_out;
-  PAPI_INT msg_out_len;
-  auto res =  papi_create_handshake((PAPI_PLAYER)player, &msg_out, &msg_out_len);
-  if (res != PAPI_SUCCESS && res != PAPI_CONTINUED) {
-    napi_throw_type_error(env, to_string((int)res).c_str(), "Error deleting handshake");
-    return NULL;
-  }
-
-  napi_value buffer = NULL;
-  if (msg_out_len) {
-    if (napi_ok != (status = napi_create_external_buffer(env,  msg_out_len, (void*)msg_out, finalize_msg, NULL, &buffer)))
-      napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating buffer");
-  }
-
-  return buffer;
+  return queue_call(env, new async_call(CREATE_HANDSHAKE, "Error creating handshake", player), NULL);
 }
 
-// processHandshake(player, msg:arrayBuffer) -> { continued: bool, response: arrayBuffer}
+// processHandshake(player, msg:arrayBuffer) -> Promise<{ continued: bool, response: arrayBuffer}>
 napi_value processHandshake(napi_env env, napi_callback_info info) {
   napi_status status;
   napi_value argv[2];
@@ -213,45 +387,15 @@ napi_value processHandshake(napi_env env, napi_callback_info info) {
     return NULL;
   }
 
-  void* msg_in;
-  size_t msg_in_len;
-  if (napi_ok != (status =  napi_get_buffer_info(env, argv[1], &msg_in, &msg_in_len))) {
-    napi_throw_type_error(env, to_string((int)status).c_str(), "Error getting msg_in_len arguments");
+  auto c = new async_call(PROCESS_HANDSHAKE, "Error processing handshake", player);
+  if (!get_message(env, argv[1], c)) {
+    delete c;
     return NULL;
   }
-
-  PAPI_MESSAGE msg_out;
-  PAPI_INT msg_out_len;
-  auto res =  papi_process_handshake((PAPI_PLAYER)player, (PAPI_MESSAGE)msg_in, msg_in_len, &msg_out, &msg_out_len);
-  if (res != PAPI_SUCCESS && res != PAPI_CONTINUED) {
-    napi_throw_type_error(env, to_string((int)res).c_str(), "Error processing handshake");
-    return NULL;
-  }
-
-  napi_value msg_out_buffer;
-  napi_get_null(env, &msg_out_buffer);
-  if (msg_out_len) {
-    if (napi_ok != (status = napi_create_external_buffer(env,  msg_out_len, (void*)msg_out, finalize_msg, NULL, &msg_out_buffer))) {
-      napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating msg_out buffer");
-      return NULL;
-    }
-  }
-
-  napi_value continued;
-  napi_get_boolean(env, (res == PAPI_CONTINUED ? true : false), &continued);
-  
-  napi_value result;
-  if (napi_ok != (status = napi_create_object(env, &result)) ||
-      napi_ok != (status = napi_set_named_property(env, result, "continued", continued)) ||
-      napi_ok != (status = napi_set_named_property(env, result, "response", msg_out_buffer))) {
-      napi_throw_type_error(env, to_string((int)status).c_str(), "Error creating result object");
-      return NULL;
-  }
-
-  return result;
+  return queue_call(env, c, argv[1]);
 }
 
-// createBet(player, betType, amount) -> { continued: bool, response: arrayBuffer}
+// createBet(player, betType, amount) -> Promise<{ continued: bool, response: arrayBuffer}>
 napi_value createBet(napi_env env, napi_callback_info info) {
   napi_status status;
   napi_value argv[3];
@@ -265,48 +409,78 @@ napi_value createBet(napi_env env, napi_callback_info info) {
     return NULL;
   }
 
-  int32_t bet_type;
-  napi_get_value_int32(env, argv[1], &bet_type);
-  std::string amt;
-  if (!get_string(env, argv[2], amt))
+  auto c = new async_call(CREATE_BET, "Error creating bet", player);
+  napi_get_value_int32(env, argv[1], &c->bet_type);
+  if (!get_string(env, argv[2], c->amt)) {
+    delete c;
     return NULL;
+  }
+  return queue_call(env, c, NULL);
+}
 
-  PAPI_MESSAGE msg_out;
-  PAPI_INT msg_out_len;
-  auto res =  papi_create_bet((PAPI_PLAYER)player, bet_type, (PAPI_MONEY)amt.c_str(),  &msg_out, &msg_out_len);
-  if (res != PAPI_SUCCESS && res != PAPI_CONTINUED) {
-    napi_throw_type_error(env, to_string((int)res).c_str(), "Error deleting handshake");
+// processBet(player, msg:arrayBuffer) -> Promise<{ betType, amount, continued: bool, response: arrayBuffer}>
+napi_value processBet(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value argv[2];
+  size_t argc = 2;
+
+  if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
     return NULL;
   }
 
-  napi_value msg_out_buffer;
-  napi_get_null(env, &msg_out_buffer);
-  if (msg_out_len) {
-    if (napi_ok != (status = napi_create_external_buffer(env,  msg_out_len, (void*)msg_out, finalize_msg, NULL, &msg_out_buffer))) {
-      napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating msg_out buffer");
-      return NULL;
-    }
+  PAPI_PLAYER player;
+  if (!get_player(env, argv[0], player)) {
+    napi_throw_type_error(env, "", "Error loading player");
+    return NULL;
+  }
+
+  auto c = new async_call(PROCESS_BET, "Error processing bet", player);
+  if (!get_message(env, argv[1], c)) {
+    delete c;
+    return NULL;
+  }
+  return queue_call(env, c, argv[1]);
+}
+
+// getGameState(player) -> gameState:string
+napi_value getGameState(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value argv[1];
+  size_t argc = 1;
+
+  if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
+    return NULL;
   }
 
-  napi_value continued;
-  napi_get_boolean(env, (res == PAPI_CONTINUED ? true : false), &continued);
+  PAPI_PLAYER player;
+  if (!get_player(env, argv[0], player)) {
+    napi_throw_type_error(env, "", "Error loading player");
+    return NULL;
+  }
   
+  char json[1024] = { 0 };
+  auto res =  papi_get_game_state((PAPI_PLAYER)player, (PAPI_STR)json, sizeof(json));
+  if (res != PAPI_SUCCESS && res != PAPI_CONTINUED) {
+    napi_throw_type_error(env, to_string((int)res).c_str(), "Error calling papi_get_game_state");
+    return NULL;
+  }
+
   napi_value result;
-  if (napi_ok != (status = napi_create_object(env, &result)) ||
-      napi_ok != (status = napi_set_named_property(env, result, "continued", continued)) ||
-      napi_ok != (status = napi_set_named_property(env, result, "response", msg_out_buffer))) {
-      napi_throw_type_error(env, to_string((int)status).c_str(), "Error creating result object");
-      return NULL;
+  if (napi_ok != (status = napi_create_string_utf8(env, json, strlen(json), &result))) {
+    napi_throw_type_error(env, to_string((int)res).c_str(), "Error creating result string");
+    return NULL;
   }
 
   return result;
 }
 
-// processBet(player, msg:arrayBuffer) -> { betType, amount, continued: bool, response: arrayBuffer}
-napi_value processBet(napi_env env, napi_callback_info info) {
+// savePlayer(player) -> snapshot:arrayBuffer
+napi_value savePlayer(napi_env env, napi_callback_info info) {
   napi_status status;
-  napi_value argv[2];
-  size_t argc = 2;
+  napi_value argv[1];
+  size_t argc = 1;
 
   if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
     napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
@@ -319,55 +493,61 @@ napi_value processBet(napi_env env, napi_callback_info info) {
     return NULL;
   }
 
-  void* msg_in;
-  size_t msg_in_len;
-  if (napi_ok != (status =  napi_get_buffer_info(env, argv[1], &msg_in, &msg_in_len))) {
-    napi_throw_type_error(env, to_string((int)status).c_str(), "Error getting msg_in_len arguments");
+  PAPI_MESSAGE snapshot;
+  PAPI_INT snapshot_len;
+  auto res =  papi_save_player((PAPI_PLAYER)player, &snapshot, &snapshot_len);
+  if (res != PAPI_SUCCESS) {
+    napi_throw_type_error(env, to_string((int)res).c_str(), "Error saving player");
     return NULL;
   }
 
-  PAPI_MESSAGE msg_out;
-  PAPI_INT msg_out_len;
-  PAPI_INT bet_type;
-  char amt[100] = { 0 };
-  int amt_len = sizeof(amt);
-  auto res =  papi_process_bet((PAPI_PLAYER)player, (PAPI_MESSAGE)msg_in, msg_in_len, &msg_out, &msg_out_len, &bet_type, (PAPI_STR)amt, amt_len);
-  if (res != PAPI_SUCCESS && res != PAPI_CONTINUED) {
-    napi_throw_type_error(env, to_string((int)res).c_str(), "Error processing bet");
+  napi_value buffer;
+  if (napi_ok != (status = napi_create_external_buffer(env, snapshot_len, (void*)snapshot, finalize_msg, NULL, &buffer))) {
+    papi_delete_message(snapshot);
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error alloating snapshot buffer");
     return NULL;
   }
 
-  napi_value msg_out_buffer;
-  napi_get_null(env, &msg_out_buffer);
-  if (msg_out_len) {
-    if (napi_ok != (status = napi_create_external_buffer(env,  msg_out_len, (void*)msg_out, finalize_msg, NULL, &msg_out_buffer))) {
-      napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating msg_out buffer");
-      return NULL;
-    }
+  return buffer;
+}
+
+// loadPlayer(player, snapshot:arrayBuffer)
+napi_value loadPlayer(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value argv[2];
+  size_t argc = 2;
+
+  if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
+    return NULL;
   }
 
-  napi_value continued, vbet_type, vamt, result;
-  if (napi_ok != (status = napi_get_boolean(env, (res == PAPI_CONTINUED ? true : false), &continued)) ||
-      napi_ok != (status = napi_create_string_utf8(env, amt, strlen(amt), &vamt)) ||
-      napi_ok != (status = napi_create_int32(env, bet_type, &vbet_type)) ||
-      napi_ok != (status = napi_create_object(env, &result)) ||
-      napi_ok != (status = napi_set_named_property(env, result, "continued", continued)) ||
-      napi_ok != (status = napi_set_named_property(env, result, "response", msg_out_buffer)) ||
-      napi_ok != (status = napi_set_named_property(env, result, "amount", vamt)) ||
-      napi_ok != (status = napi_set_named_property(env, result, "betType", vbet_type)))
-  {
-      napi_throw_type_error(env, to_string((int)status).c_str(), "Error creating result object");
-      return NULL;
+  PAPI_PLAYER player;
+  if (!get_player(env, argv[0], player)) {
+    napi_throw_type_error(env, "", "Error loading player");
+    return NULL;
   }
 
-  return result;
+  void* snapshot;
+  size_t snapshot_len;
+  if (napi_ok != (status =  napi_get_buffer_info(env, argv[1], &snapshot, &snapshot_len))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error getting snapshot argument");
+    return NULL;
+  }
+
+  auto res =  papi_load_player((PAPI_PLAYER)player, (PAPI_MESSAGE)snapshot, snapshot_len);
+  if (res != PAPI_SUCCESS) {
+    napi_throw_type_error(env, to_string((int)res).c_str(), "Error loading player snapshot");
+  }
+
+  return NULL;
 }
 
-// getGameState(player) -> gameState:string
-napi_value getGameState(napi_env env, napi_callback_info info) {
+// computeEquity(player, maxSamples, precision, seed, threads) -> {win, tie, loss, samples}
+napi_value computeEquity(napi_env env, napi_callback_info info) {
   napi_status status;
-  napi_value argv[1];
-  size_t argc = 1;
+  napi_value argv[5];
+  size_t argc = 5;
 
   if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
     napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
@@ -379,20 +559,40 @@ napi_value getGameState(napi_env env, napi_callback_info info) {
     napi_throw_type_error(env, "", "Error loading player");
     return NULL;
   }
-  
-  char json[1024] = { 0 };
-  auto res =  papi_get_game_state((PAPI_PLAYER)player, (PAPI_STR)json, sizeof(json));
-  if (res != PAPI_SUCCESS && res != PAPI_CONTINUED) {
-    napi_throw_type_error(env, to_string((int)res).c_str(), "Error calling papi_get_game_state");
+
+  PAPI_INT max_samples, seed, threads;
+  double precision;
+  if (napi_ok != (status = napi_get_value_int32(env, argv[1], &max_samples)) ||
+      napi_ok != (status = napi_get_value_double(env, argv[2], &precision)) ||
+      napi_ok != (status = napi_get_value_int32(env, argv[3], &seed)) ||
+      napi_ok != (status = napi_get_value_int32(env, argv[4], &threads))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error getting equity arguments");
     return NULL;
   }
 
-  napi_value result;
-  if (napi_ok != (status = napi_create_string_utf8(env, json, strlen(json), &result))) {
-    napi_throw_type_error(env, to_string((int)res).c_str(), "Error creating result string");
+  double win, tie, loss;
+  PAPI_INT samples;
+  auto res =  papi_compute_equity((PAPI_PLAYER)player, max_samples, precision, seed, threads, &win, &tie, &loss, &samples);
+  if (res != PAPI_SUCCESS) {
+    napi_throw_type_error(env, to_string((int)res).c_str(), "Error computing equity");
     return NULL;
   }
 
+  napi_value vwin, vtie, vloss, vsamples, result;
+  if (napi_ok != (status = napi_create_double(env, win, &vwin)) ||
+      napi_ok != (status = napi_create_double(env, tie, &vtie)) ||
+      napi_ok != (status = napi_create_double(env, loss, &vloss)) ||
+      napi_ok != (status = napi_create_int32(env, samples, &vsamples)) ||
+      napi_ok != (status = napi_create_object(env, &result)) ||
+      napi_ok != (status = napi_set_named_property(env, result, "win", vwin)) ||
+      napi_ok != (status = napi_set_named_property(env, result, "tie", vtie)) ||
+      napi_ok != (status = napi_set_named_property(env, result, "loss", vloss)) ||
+      napi_ok != (status = napi_set_named_property(env, result, "samples", vsamples)))
+  {
+      napi_throw_type_error(env, to_string((int)status).c_str(), "Error creating result object");
+      return NULL;
+  }
+
   return result;
 }
 
@@ -412,6 +612,7 @@ struct callback {
 static callback callbacks[] = { 
   def_callback(init),
   def_callback(newPlayer),
+  def_callback(newPlayerWithOptions),
   def_callback(deletePlayer),
   def_callback(initPlayer),
   def_callback(createHandshake),
@@ -419,13 +620,23 @@ static callback callbacks[] = {
   def_callback(createBet),
   def_callback(processBet),
   def_callback(getGameState),
+  def_callback(savePlayer),
+  def_callback(loadPlayer),
+  def_callback(computeEquity),
   { NULL, NULL }
 };
 
+// once per process, with the defaults of init: players made with options
+// don't depend on them, and a worker loading the add-on again must not
+// change them under the players of the others
+static std::once_flag library_initialized;
+
 napi_value init_addon(napi_env env, napi_value exports) {
   napi_status status;
   napi_value fn;
 
+  std::call_once(library_initialized, []() { papi_init(true, false, -1); });
+
   for(callback* p=callbacks; p->name; p++) {
     status = napi_create_function(env, nullptr, 0, p->fn, nullptr, &fn);
     if (status != napi_ok) return nullptr;
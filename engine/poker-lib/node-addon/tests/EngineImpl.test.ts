@@ -115,4 +115,26 @@ describe("A complete game", () => {
         alice.on_game_over();
         bob.on_game_over();
     });
+
+    it("should run the calls on a player in the order they were made", async () => {
+        const alice = new EngineImpl(0, lib_path);
+        const bob = new EngineImpl(1, lib_path);
+        alice.init(BigNumber.from(200), BigNumber.from(300), BigNumber.from(10), true);
+        bob.init(BigNumber.from(200), BigNumber.from(300), BigNumber.from(10), true);
+
+        // inits not awaited: the handshake waits for them
+        let msg = (await alice.create_handshake()).message_out;
+        for (let i = 0; msg; i++) {
+            const r = await (i % 2 ? alice : bob).process_handshake(msg);
+            msg = r.message_out;
+        }
+        // the state is read once the bet, running on a worker, is done
+        const bet = alice.create_bet(EngineBetType.BET_RAISE, BigNumber.from(20));
+        const state = alice.game_state();
+        expect((await state).players[0].bets.toNumber()).to.equal(30);
+        expect((await bet).status).to.equal(StatusCode.SUCCESS);
+
+        alice.on_game_over();
+        bob.on_game_over();
+    });
 });
@@ -8,7 +8,7 @@ const BET_CHECK = 4
 
 describe('Poker Node.js add-on', function() {
   describe('The happy path', function() {
-    it('should play a game to the end,  without errors', function() {
+    it('should play a game to the end,  without errors', async function() {
       const lib = require('../build/Release/pokerlib.node');
       lib.init(true, false, -1);
 
@@ -20,31 +20,36 @@ describe('Poker Node.js add-on', function() {
       lib.initPlayer(alice, "100", "200", "10")
       lib.initPlayer(bob, "100", "200", "10")
       let msg, r;
-      msg = lib.createHandshake(alice);
-      r = lib.processHandshake(bob, msg);
-      r = lib.processHandshake(alice, r.response);
-      r = lib.processHandshake(bob, r.response);
-      r = lib.processHandshake(alice, r.response);
-      r = lib.processHandshake(bob, r.response);
+      msg = await lib.createHandshake(alice);
+      r = await lib.processHandshake(bob, msg);
+      r = await lib.processHandshake(alice, r.response);
+      r = await lib.processHandshake(bob, r.response);
+      r = await lib.processHandshake(alice, r.response);
+      r = await lib.processHandshake(bob, r.response);
 
       // Preflop: Alice calls
-      r = lib.createBet(alice, BET_CALL, "0");
+      r = await lib.createBet(alice, BET_CALL, "0");
       assert.equal(r.continued, false);
       assert.notEqual(r.response, undefined);
-      r = lib.processBet(bob, r.response);
+      r = await lib.processBet(bob, r.response);
       assert.equal(r.continued, false);
       assert.equal(r.response, undefined);
 
       // Preflop: Bob checks
-      r = lib.createBet(bob, BET_CHECK, "0")
-      r = lib.processBet(alice, r.response);
-      r = lib.processBet(bob, r.response);
+      r = await lib.createBet(bob, BET_CHECK, "0")
+      r = await lib.processBet(alice, r.response);
+      r = await lib.processBet(bob, r.response);
       assert.equal(r.continued, false);
       assert.equal(r.response, undefined);
 
+      // Alice's equity on the flop, by Monte Carlo
+      r = lib.computeEquity(alice, 20000, 0, 1, 0);
+      assert.equal(r.samples, 20000);
+      assert(Math.abs(r.win + r.tie + r.loss - 1) < 1e-9);
+
       // Flop: Bob checks
-      r = lib.createBet(bob, BET_CHECK, "0")
-      r = lib.processBet(alice, r.response);
+      r = await lib.createBet(bob, BET_CHECK, "0")
+      r = await lib.processBet(alice, r.response);
       assert.equal(r.betType, BET_CHECK);
       assert.equal(r.amount, "0");
       
@@ -52,43 +57,43 @@ describe('Poker Node.js add-on', function() {
       assert.equal(r.response, undefined);
 
       // Flop: Alice checks
-      r = lib.createBet(alice, BET_CHECK, "0")
+      r = await lib.createBet(alice, BET_CHECK, "0")
       assert.equal(r.continued, true);
-      r = lib.processBet(bob, r.response);
+      r = await lib.processBet(bob, r.response);
       assert.equal(r.continued, false);
       assert.notEqual(r.response, undefined);
-      r = lib.processBet(alice, r.response);
+      r = await lib.processBet(alice, r.response);
       assert.equal(r.continued, false);
       assert.equal(r.response, undefined);
 
       // Turn: Bob raises
-      r = lib.createBet(bob, BET_RAISE, "30")
-      r = lib.processBet(alice, r.response);
+      r = await lib.createBet(bob, BET_RAISE, "30")
+      r = await lib.processBet(alice, r.response);
       assert.equal(r.betType, BET_RAISE);
       assert.equal(r.amount, "30");
       assert.equal(r.continued, false);
       assert.equal(r.response, undefined);
 
       // Alice calls
-      r = lib.createBet(alice, BET_CALL, "0")
-      r = lib.processBet(bob, r.response);
-      r = lib.processBet(alice, r.response);
+      r = await lib.createBet(alice, BET_CALL, "0")
+      r = await lib.processBet(bob, r.response);
+      r = await lib.processBet(alice, r.response);
       assert.equal(r.continued, false);
       assert.equal(r.response, undefined);
 
       // River bet: Bob checks
-      r = lib.createBet(bob, BET_CHECK, "0")
+      r = await lib.createBet(bob, BET_CHECK, "0")
       assert.equal(r.continued, false);
-      r = lib.processBet(alice, r.response);
+      r = await lib.processBet(alice, r.response);
       assert.equal(r.continued, false);
       assert.equal(r.response, undefined);
  
       // River bet: alice checks
-      r = lib.createBet(alice, BET_CHECK, "0")
-      r = lib.processBet(bob, r.response);
-      r = lib.processBet(alice, r.response);      
+      r = await lib.createBet(alice, BET_CHECK, "0")
+      r = await lib.processBet(bob, r.response);
+      r = await lib.processBet(alice, r.response);      
       assert.equal(r.continued, false);
-      r = lib.processBet(bob, r.response);      
+      r = await lib.processBet(bob, r.response);      
       assert.equal(r.continued, false);
       assert.equal(r.response, undefined);
 
@@ -105,4 +110,34 @@ describe('Poker Node.js add-on', function() {
 
     });
   });
+
+  describe('Async calls', function() {
+    it('should not block the event loop', async function() {
+      const lib = require('../build/Release/pokerlib.node');
+      lib.init(true, false, -1);
+      const alice = lib.newPlayer(0);
+      const bob = lib.newPlayer(1);
+      lib.initPlayer(alice, "100", "200", "10")
+      lib.initPlayer(bob, "100", "200", "10")
+
+      let ticks = 0;
+      const timer = setInterval(() => ticks++, 1);
+      const msg = await lib.createHandshake(alice);
+      let r = await lib.processHandshake(bob, msg);
+      clearInterval(timer);
+      assert.equal(r.continued, true);
+      assert(ticks > 0);
+
+      // errors reject the promise, with the library's error code
+      await assert.rejects(lib.processHandshake(alice, Buffer.from("not a message")), (e) => e.code > 0);
+      // long strings are not truncated
+      const carol = lib.newPlayer(0);
+      lib.initPlayer(carol, "0".repeat(2000) + "100", "200", "10");
+      assert.equal(JSON.parse(lib.getGameState(carol)).players[0].total_funds, "100");
+      lib.deletePlayer(carol);
+
+      lib.deletePlayer(alice);
+      lib.deletePlayer(bob);
+    });
+  });
 });
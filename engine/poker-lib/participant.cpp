@@ -1,7 +1,10 @@
 #include "participant.h"
+#include "codec.h"
 
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <unordered_set>
 
 void set_libtmcg_cartesi_predictable(int v);
 
@@ -18,7 +21,36 @@ class libtmcg_guard {
     }
 };
 
-participant::participant() : _vtmf(NULL), _tmcg(NULL), _vsshe(NULL) {}
+/*
+ * Serialized groups that already passed CheckGroup(). Checking runs
+ * primality tests and dominates the cost of loading a group; a process
+ * verifying many games checks each distinct group once.
+ */
+class validated_groups {
+    std::mutex _lock;
+    std::unordered_set<std::string> _groups;
+    static const size_t max_groups = 256;
+
+   public:
+    static validated_groups& instance() {
+        static validated_groups instance;
+        return instance;
+    }
+
+    bool contains(const std::string& group) {
+        std::lock_guard<std::mutex> lock(_lock);
+        return _groups.count(group) > 0;
+    }
+
+    void add(const std::string& group) {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_groups.size() >= max_groups)
+            _groups.clear();
+        _groups.insert(group);
+    }
+};
+
+participant::participant() : _vtmf(NULL), _tmcg(NULL), _vsshe(NULL), _key_generated(false), _key_finalized(false) {}
 
 participant::~participant() {
     delete _vtmf;
@@ -61,9 +93,13 @@ game_error participant::load_group(blob& group) {
 
     try {
         _vtmf = new BarnettSmartVTMF_dlog(group.in());
-        if (!_vtmf->CheckGroup()) {
-            logger << "*** ERROR BarnettSmartVTMF_dlog\n";
-            return TMC_CHECK_GROUP;
+        auto key = "vtmf:" + group.str();
+        if (!validated_groups::instance().contains(key)) {
+            if (!_vtmf->CheckGroup()) {
+                logger << "*** ERROR BarnettSmartVTMF_dlog\n";
+                return TMC_CHECK_GROUP;
+            }
+            validated_groups::instance().add(key);
         }
         return SUCCESS;
     } catch (const std::exception& e) {
@@ -76,6 +112,7 @@ game_error participant::generate_key(blob& key) {
     libtmcg_guard patch_ltmcg(this);
     logger << _pfx << "publishKey " << std::endl;
     _vtmf->KeyGenerationProtocol_GenerateKey();
+    _key_generated = true;
     _vtmf->KeyGenerationProtocol_PublishKey(key.out());
     return SUCCESS;
 }
@@ -99,6 +136,7 @@ game_error participant::finalize_key_generation() {
     libtmcg_guard patch_ltmcg(this);
     logger << _pfx << "finalize_key_generation " << std::endl;
     _vtmf->KeyGenerationProtocol_Finalize();
+    _key_finalized = true;
     return SUCCESS;
 }
 
@@ -119,9 +157,13 @@ game_error participant::load_vsshe_group(blob& group) {
     logger << _pfx << "load_vsshe_group" << std::endl;
     try {
         _vsshe = new GrothVSSHE(DECK_SIZE, group.in());
-        if (!_vsshe->CheckGroup()) {
-            logger << _pfx << "*** VRHE instance was not correctly generated!" << std::endl;
-            return TMC_VSSHE_CHECKGROUP;
+        auto key = "vsshe:" + group.str();
+        if (!validated_groups::instance().contains(key)) {
+            if (!_vsshe->CheckGroup()) {
+                logger << _pfx << "*** VRHE instance was not correctly generated!" << std::endl;
+                return TMC_VSSHE_CHECKGROUP;
+            }
+            validated_groups::instance().add(key);
         }
     } catch (const std::exception& e) {
         std::cerr << e.what() << '\n';
@@ -260,4 +302,119 @@ size_t participant::get_open_card(int card_index) {
     return card_type;
 }
 
+static std::string to_hex(mpz_srcptr v) {
+    char* s = mpz_get_str(NULL, 16, v);
+    std::string hex(s);
+    void (*free_fn)(void*, size_t);
+    mp_get_memory_functions(NULL, NULL, &free_fn);
+    free_fn(s, hex.size() + 1);
+    return hex;
+}
+
+template <typename T>
+static std::string to_string(const T& v) {
+    std::ostringstream os;
+    if (v.size())
+        os << v;
+    return os.str();
+}
+
+/*
+ * Saves the groups, this participant's key share and the joint key, the
+ * stack with its secret, the cards taken and the ones opened. Groups are
+ * not checked again when loaded: state comes from a trusted source.
+ */
+game_error participant::save(std::ostream& out) {
+    libtmcg_guard patch_ltmcg(this);
+    game_error res;
+    encoder e(out);
+    std::ostringstream group, vsshe_group;
+    if (_vtmf)
+        _vtmf->PublishGroup(group);
+    if (_vsshe)
+        _vsshe->PublishGroup(vsshe_group);
+
+    if ((res = e.write(group.str())) || (res = e.write(vsshe_group.str())) ||
+        (res = e.write((int)(_vtmf && _key_generated))) || (res = e.write((int)(_vtmf && _key_finalized))))
+        return res;
+    if (_vtmf && _key_generated)
+        if ((res = e.write(to_hex(_vtmf->x_i))) || (res = e.write(to_hex(_vtmf->h_i))) || (res = e.write(to_hex(_vtmf->h))))
+            return res;
+    if ((res = e.write(to_string(_stack))) || (res = e.write(to_string(_ss))) || (res = e.write(to_string(_cards))))
+        return res;
+    if ((res = e.write((int)_open_cards.size())))
+        return res;
+    for (auto& c : _open_cards)
+        if ((res = e.write(c.first)) || (res = e.write((int)c.second)))
+            return res;
+    return SUCCESS;
+}
+
+game_error participant::load(std::istream& in) {
+    libtmcg_guard patch_ltmcg(this);
+    game_error res;
+    decoder d(in);
+    std::string group, vsshe_group, stack, secret, cards;
+    int key_generated, key_finalized, open_cards;
+    if ((res = d.read(group)) || (res = d.read(vsshe_group)) || (res = d.read(key_generated)) || (res = d.read(key_finalized)))
+        return res;
+
+    delete _vtmf;
+    delete _tmcg;
+    delete _vsshe;
+    _vtmf = NULL;
+    _tmcg = NULL;
+    _vsshe = NULL;
+    _stack.clear();
+    _ss.clear();
+    _cards.clear();
+    _open_cards.clear();
+    _key_generated = _key_finalized = false;
+
+    try {
+        if (group.size()) {
+            std::istringstream is(group);
+            _tmcg = new SchindelhauerTMCG(64, _num_participants, 6 /* bits for 52 cards*/);
+            _vtmf = new BarnettSmartVTMF_dlog(is);
+        }
+        if (key_generated) {
+            std::string x_i, h_i, h;
+            if ((res = d.read(x_i)) || (res = d.read(h_i)) || (res = d.read(h)))
+                return res;
+            if (!_vtmf || mpz_set_str(_vtmf->x_i, x_i.c_str(), 16) || mpz_set_str(_vtmf->h_i, h_i.c_str(), 16) ||
+                mpz_set_str(_vtmf->h, h.c_str(), 16))
+                return TMC_INVALID_STATE;
+            _key_generated = true;
+            if (key_finalized) {
+                _vtmf->KeyGenerationProtocol_Finalize();
+                _key_finalized = true;
+            }
+        }
+        if (vsshe_group.size()) {
+            std::istringstream is(vsshe_group);
+            _vsshe = new GrothVSSHE(DECK_SIZE, is);
+        }
+
+        if ((res = d.read(stack)) || (res = d.read(secret)) || (res = d.read(cards)))
+            return res;
+        std::istringstream stack_in(stack), secret_in(secret), cards_in(cards);
+        if ((stack.size() && !(stack_in >> _stack)) || (secret.size() && !(secret_in >> _ss)) ||
+            (cards.size() && !(cards_in >> _cards)))
+            return TMC_INVALID_STATE;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return TMC_RUNTIME_EXCEPTION;
+    }
+
+    if ((res = d.read(open_cards)))
+        return res;
+    for (auto i = 0; i < open_cards; i++) {
+        int index, type;
+        if ((res = d.read(index)) || (res = d.read(type)))
+            return res;
+        _open_cards[index] = type;
+    }
+    return SUCCESS;
+}
+
 }  // namespace poker
\ No newline at end of file
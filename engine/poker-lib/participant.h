@@ -21,6 +21,8 @@ class participant : public i_participant {
     TMCG_StackSecret<VTMF_CardSecret> _ss;
     TMCG_Stack<VTMF_Card> _cards;
     std::map<int, size_t> _open_cards;
+    bool _key_generated;
+    bool _key_finalized;
 
    public:
     participant();
@@ -55,6 +57,9 @@ class participant : public i_participant {
     game_error verify_card_secret(int card_index, blob& their_proof) override;
     game_error open_card(int card_index) override;
     size_t get_open_card(int card_index) override;
+
+    game_error save(std::ostream& out) override;
+    game_error load(std::istream& in) override;
 };
 
 }  // namespace poker
@@ -1,13 +1,34 @@
 #include "player.h"
+
+#include <atomic>
+
+#include "codec.h"
 #include "compression.h"
 #include "service_locator.h"
 
 namespace poker {
 
+static std::atomic<bool> short_handshake(false);
+
+void set_short_handshake(bool enabled) {
+    short_handshake = enabled;
+}
+
 player::player(int id)
-    : _id(id), _opponent_id(opponent_id(_id)),
-      _alice_money(0), _bob_money(0), _big_blind(0),
-      _p(service_locator::instance().new_participant())
+    : player(id, service_locator::instance().new_participant(), service_locator::instance().new_participant(),
+             short_handshake)
+{
+}
+
+player::player(int id, const poker_lib_options& opts)
+    : player(id, service_locator::new_participant(opts.encryption, opts.winner),
+             service_locator::new_participant(opts.encryption, opts.winner), opts.short_handshake)
+{
+}
+
+player::player(int id, i_participant* p, i_participant* eve, bool short_handshake)
+    : _id(id), _opponent_id(opponent_id(_id)), _p(p), _r(eve), _short_handshake(short_handshake),
+      _alice_money(0), _bob_money(0), _big_blind(0)
 {
     _p->init(id, 3, false);
     _r.game().next_msg_author = id == ALICE ? _id : _opponent_id;
@@ -18,6 +39,7 @@ player::~player() {
 }
 
 game_error player::init(money_t alice_money, money_t bob_money, money_t big_blind) {
+    arena_scope scope(_arena);
     game_error res;
     if ((res=_r.step_init_game(alice_money, bob_money, big_blind)))
         return res;
@@ -34,11 +56,14 @@ game_error player::init(money_t alice_money, money_t bob_money, money_t big_blin
 }
 
 game_error player::create_handshake(std::string&msg_out) {
+    arena_scope scope(_arena);
     game_error res;
     if (_id != ALICE)
         return PRR_INVALID_PLAYER;
 
-    msg_vtmf msgout;
+    msg_vtmf vtmf;
+    msg_short_vtmf short_vtmf;
+    msg_vtmf& msgout = _short_handshake ? short_vtmf : vtmf;
     msgout.player_id = _id;
     msgout.alice_money = _alice_money;
     msgout.bob_money = _bob_money;
@@ -56,11 +81,13 @@ game_error player::create_handshake(std::string&msg_out) {
     _r.game().next_msg_author = _opponent_id;
 
     std::ostringstream os;
+    msgout.set_version(_r.game().version);
     msgout.write(os);
     return compress_and_wrap(os.str(), msg_out);
 }
 
 game_error player::process_handshake(std::string& msg_in, std::string& msg_out) {
+    arena_scope scope(_arena);
     game_error res;
 
     std::string decompressed;
@@ -74,6 +101,8 @@ game_error player::process_handshake(std::string& msg_in, std::string& msg_out)
 
     if (msgin->player_id != opponent_id(_id))
         return PRR_INVALID_OPPONNENT;
+    if ((res=check_version(msgin, _r.game())))
+        return res;
             
     message* msgout = NULL;
     switch(msgin->type()) {
@@ -97,6 +126,21 @@ game_error player::process_handshake(std::string& msg_in, std::string& msg_out)
         case MSG_BOB_PRIVATE_CARDS:
             res =  handle_bob_private_cards((msg_bob_private_cards*)msgin);
             break;
+        case MSG_SHORT_VTMF:
+            _r.game().next_msg_author = _id;
+            res = handle_short_vtmf((msg_short_vtmf*)msgin, &msgout);
+            break;
+        case MSG_SHORT_VTMF_RESPONSE:
+            _r.game().next_msg_author = _id;
+            res = handle_short_vtmf_response((msg_short_vtmf_response*)msgin, &msgout);
+            break;
+        case MSG_ALICE_MIX:
+            _r.game().next_msg_author = _id;
+            res = handle_alice_mix((msg_alice_mix*)msgin, &msgout);
+            break;
+        case MSG_ALICE_PRIVATE_CARDS:
+            res = handle_alice_private_cards((msg_alice_private_cards*)msgin);
+            break;
         default:
             return PRR_INVALID_MSG_TYPE;
     }
@@ -106,8 +150,10 @@ game_error player::process_handshake(std::string& msg_in, std::string& msg_out)
      if (res == SUCCESS || res == CONTINUED) {
         _r.game().next_msg_author = res == SUCCESS ? _r.game().current_player : _opponent_id;
 
-        if (msgout)
+        if (msgout) {
+            msgout->set_version(_r.game().version);
             msgout->write(os);
+        }
     }
 
     delete msgin;
@@ -130,7 +176,19 @@ game_error player::handle_vtmf(msg_vtmf* msgin, message** out) {
     auto msgout = new msg_vtmf_response();
     *out = msgout;
     msgout->player_id = _id;
+    msgout->alice_money = _alice_money;
+    msgout->bob_money = _bob_money;
+    msgout->big_blind = _big_blind;
 
+    if ((res=load_vtmf(msgin, msgout->bob_key)))
+        return res;
+
+    return CONTINUED;
+}
+
+// Bob's side of the group and keys, in both handshakes
+game_error player::load_vtmf(msg_vtmf* msgin, blob& bob_key) {
+    game_error res;
     if (_id != BOB)
         return PRR_INVALID_PLAYER;
 
@@ -141,10 +199,6 @@ game_error player::handle_vtmf(msg_vtmf* msgin, message** out) {
     if (_big_blind != msgin->big_blind)
         return PRR_BIG_BLIND_DIVERGES;
 
-    msgout->alice_money = _alice_money;
-    msgout->bob_money = _bob_money;
-    msgout->big_blind = _big_blind;
-
     if (_p->load_group(msgin->vtmf))
         return PRR_CREATE_VTMF;
     if ((res=_r.step_vtmf_group(msgin->vtmf)))
@@ -152,12 +206,9 @@ game_error player::handle_vtmf(msg_vtmf* msgin, message** out) {
 
     if ((res=_p->generate_key(_my_key)))
         return res;
-    msgout->bob_key = _my_key;
+    bob_key = _my_key;
 
-    if ((res=load_opponent_key(msgin->alice_key)))
-        return res;
-
-    return CONTINUED;
+    return load_opponent_key(msgin->alice_key);
 }
 
 game_error player::handle_vtmf_response(msg_vtmf_response* msgin, message** out) {
@@ -224,12 +275,6 @@ game_error player::handle_vsshe(msg_vsshe* msgin, message** out) {
     if ((res=_r.step_bob_mix(msgout->stack, msgout->stack_proof)))
         return res;
 
-    blob mix, proof;
-    if ((res=_r.step_final_mix(mix, proof)))
-        return res;
-    if (_p->load_stack(mix, proof))
-        return PRR_LOAD_FINAL_STACK;
-
     if ((res=deal_cards()))
         return res;
 
@@ -256,12 +301,6 @@ game_error player::handle_vsshe_response(msg_vsshe_response* msgin, message** ou
     if ((res=_r.step_bob_mix(msgin->stack, msgin->stack_proof)))
         return res;
 
-    blob mix, proof;
-    if ((res=_r.step_final_mix(mix, proof)))
-        return res;
-    if (_p->load_stack(mix, proof))
-        return PRR_LOAD_FINAL_STACK;
-
     if ((res=deal_cards()))
         return res;
 
@@ -288,12 +327,132 @@ game_error player::handle_bob_private_cards(msg_bob_private_cards* msgin) {
     return SUCCESS;
 }
 
+game_error player::handle_short_vtmf(msg_short_vtmf* msgin, message** out) {
+    logger << "handle_short_vtmf...\n";
+    game_error res;
+    auto msgout = new msg_short_vtmf_response();
+    *out = msgout;
+    msgout->player_id = _id;
+    msgout->alice_money = _alice_money;
+    msgout->bob_money = _bob_money;
+    msgout->big_blind = _big_blind;
+
+    if ((res=load_vtmf(msgin, msgout->bob_key)))
+        return res;
+
+    // Bob already has the common key: he publishes the VSSHE group and mixes first
+    if ((res=_p->create_vsshe_group(msgout->vsshe)))
+        return res;
+    if ((res=_r.step_vsshe_group(msgout->vsshe, true)))
+        return res;
+    if (_p->create_stack())
+        return PRR_CREATE_STACK;
+
+    if (_p->shuffle_stack(msgout->stack, msgout->stack_proof))
+        return PRR_SHUFFLE_STACK;
+    if ((res=_r.step_bob_mix(msgout->stack, msgout->stack_proof)))
+        return res;
+
+    return CONTINUED;
+}
+
+game_error player::handle_short_vtmf_response(msg_short_vtmf_response* msgin, message** out) {
+    logger << "handle_short_vtmf_response...\n";
+    if (_id != ALICE)
+        return PRR_INVALID_PLAYER;
+
+    game_error res;
+    auto msgout = new msg_alice_mix();
+    *out = msgout;
+    msgout->player_id = _id;
+
+    if ((res=load_opponent_key(msgin->bob_key)))
+        return res;
+
+    if (_alice_money != msgin->alice_money)
+        return PRR_ALICE_MONEY_DIVERGES;
+    if (_bob_money != msgin->bob_money)
+        return PRR_BOB_MONEY_DIVERGES;
+    if (_big_blind != msgin->big_blind)
+        return PRR_BIG_BLIND_DIVERGES;
+
+    if ((res=_p->load_vsshe_group(msgin->vsshe)))
+        return res;
+    if ((res=_r.step_vsshe_group(msgin->vsshe, true)))
+        return res;
+    if (_p->create_stack())
+        return PRR_CREATE_STACK;
+
+    if (_p->load_stack(msgin->stack, msgin->stack_proof))
+        return PRR_LOAD_STACK;
+    if ((res=_r.step_bob_mix(msgin->stack, msgin->stack_proof)))
+        return res;
+
+    if (_p->shuffle_stack(msgout->stack, msgout->stack_proof))
+        return PRR_SHUFFLE_STACK;
+    if ((res=_r.step_alice_mix(msgout->stack, msgout->stack_proof)))
+        return res;
+
+    if ((res=deal_cards()))
+        return res;
+
+    // Alice allowing Bob to see his private cards
+    if ((res=make_card_proof(_proof_of_their_cards, private_card_index(_opponent_id, 0), NUM_PRIVATE_CARDS)))
+        return res;
+    msgout->cards_proof = _proof_of_their_cards;
+
+    return CONTINUED;
+}
+
+game_error player::handle_alice_mix(msg_alice_mix* msgin, message** out) {
+    logger << "handle_alice_mix...\n";
+    if (_id != BOB)
+        return PRR_INVALID_PLAYER;
+
+    game_error res;
+    auto msgout = new msg_alice_private_cards();
+    *out = msgout;
+    msgout->player_id = _id;
+
+    if (_p->load_stack(msgin->stack, msgin->stack_proof))
+        return PRR_LOAD_STACK;
+    if ((res=_r.step_alice_mix(msgin->stack, msgin->stack_proof)))
+        return res;
+
+    if ((res=deal_cards()))
+        return res;
+
+    // Bob opens his private cards
+    if ((res=open_private_cards(msgin->cards_proof)))
+        return res;
+
+    if ((res=make_card_proof(_proof_of_their_cards, private_card_index(_opponent_id, 0), NUM_PRIVATE_CARDS)))
+        return res;
+    msgout->cards_proof = _proof_of_their_cards;
+
+    return SUCCESS;
+}
+
+game_error player::handle_alice_private_cards(msg_alice_private_cards* msgin) {
+    logger << "handle_alice_private_cards...\n";
+    game_error res;
+    if (_id != ALICE)
+        return PRR_INVALID_PLAYER;
+
+    if ((res=open_private_cards(msgin->cards_proof)))
+        return res;
+
+    return SUCCESS;
+}
+
 game_error player::create_bet(bet_type type, money_t amt, std::string& msg_out) {
+    arena_scope scope(_arena);
     logger << _id << ": create_bet...\n";
     game_error res;
     msg_bet_request msgout;
 
     auto step = _r.step();
+    msgout.set_version(_r.game().version);
     msgout.player_id = _id;
     msgout.type = type;
     msgout.amt = amt;
@@ -308,7 +467,10 @@ game_error player::create_bet(bet_type type, money_t amt, std::string& msg_out)
             return compress_and_wrap(os.str(), msg_out);
         }
 
-        if ((_r.step() != game_step::SHOWDOWN)) {
+        if (_r.runout_pending()) {
+            if ((res = make_runout_proof(msgout.cards_proof, _public_proofs[game_step::SHOWDOWN])))
+                return res;
+        } else if ((_r.step() != game_step::SHOWDOWN)) {
             int first_card, count;
             
             if ((res = public_cards_range(_r.step(), first_card, count)))
@@ -330,13 +492,26 @@ game_error player::create_bet(bet_type type, money_t amt, std::string& msg_out)
 }
 
 game_error player::process_bet(std::string& msg_in, std::string& out, bet_type* out_type, money_t* out_amt) {
+    arena_scope scope(_arena);
     logger << _id << ": process_bet...\n";
     game_error res;
 
-    std::string decompressed;
-    if ((res=unwrap_and_decompress(msg_in, decompressed)))
+    std::vector<std::string> messages;
+    if ((res=unwrap_and_decompress_batch(msg_in, messages)))
         return res;
 
+    for (size_t i = 0; i < messages.size(); i++) {
+        res = process_bet_message(messages[i], out, out_type, out_amt);
+        if (res != SUCCESS && res != CONTINUED)
+            return res;
+        if (i + 1 < messages.size() && out.size())
+            return PRR_BATCH_INTERRUPTED;
+    }
+    return res;
+}
+
+game_error player::process_bet_message(const std::string& decompressed, std::string& out, bet_type* out_type, money_t* out_amt) {
+    game_error res;
     auto is = std::istringstream(decompressed);
     message* msgin = NULL;
     if ((res=message::decode(is, &msgin)))
@@ -344,6 +519,8 @@ game_error player::process_bet(std::string& msg_in, std::string& out, bet_type*
 
     if (msgin->player_id != opponent_id(_id))
         return PRR_INVALID_OPPONNENT;
+    if ((res=check_version(msgin, _r.game())))
+        return res;
 
     message* msgout = NULL;
     msg_bet_request* bet_msg;
@@ -369,8 +546,10 @@ game_error player::process_bet(std::string& msg_in, std::string& out, bet_type*
     if (res == SUCCESS || res == CONTINUED) {
         _r.game().next_msg_author = res == SUCCESS ? _r.game().current_player : _opponent_id;
 
-        if (msgout)
+        if (msgout) {
+            msgout->set_version(_r.game().version);
             msgout->write(os);
+        }
     }
 
     delete msgin;
@@ -390,7 +569,7 @@ game_error player::handle_bet_request(msg_bet_request* msgin, message** out) {
     game_error res;
 
     auto step = _r.step();
-    if ((_r.bet(_opponent_id, msgin->type, msgin->amt)))
+    if ((res = _r.bet(_opponent_id, msgin->type, msgin->amt)))
         return res;
 
     auto step_changed = _r.step() != step;
@@ -405,7 +584,13 @@ game_error player::handle_bet_request(msg_bet_request* msgin, message** out) {
         msgout->type = bet_type::BET_NONE;
         msgout->amt = 0;
 
-        if (_r.step() == game_step::SHOWDOWN) {
+        if (_r.runout_pending()) {
+            blob my_public_proof;
+            if ((res = make_runout_proof(msgout->cards_proof, my_public_proof)))
+                return res;
+            if ((res = runout(my_public_proof, msgin->cards_proof)))
+                return res;
+        } else if (_r.step() == game_step::SHOWDOWN) {
             if ((res = make_card_proof(msgout->cards_proof, private_card_index(_id, 0), NUM_PRIVATE_CARDS))) {
                 return res;
             }
@@ -427,7 +612,13 @@ game_error player::handle_card_proof(msg_card_proof* msgin, message** out) {
     logger << "...handle_card_proof" << std::endl;
     game_error res;
 
-    if (_r.step() == game_step::SHOWDOWN) {
+    if (_r.runout_pending()) {
+        auto p = _public_proofs.find(game_step::SHOWDOWN);
+        if (p == _public_proofs.end())
+            return PRR_PROOF_NOT_FOUND;
+        if ((res = runout(p->second, msgin->cards_proof)))
+            return res;
+    } else if (_r.step() == game_step::SHOWDOWN) {
         if (_r.game().last_aggressor == _id) {
             if ((res = showdown(msgin->cards_proof, msgin->muck)))
                 return res;
@@ -496,8 +687,15 @@ game_error player::load_opponent_key(blob &key) {
     return SUCCESS;
 }
 
+// the referee's final mix, then the cards
 game_error player::deal_cards() {
     game_error res;
+    blob mix, proof;
+    if ((res=_r.step_final_mix(mix, proof)))
+        return res;
+    if (_p->load_stack(mix, proof))
+        return PRR_LOAD_FINAL_STACK;
+
     if (_p->take_cards_from_stack(NUM_CARDS))
         return PRR_TAKE_CARDS_FROM_STACK;
     if ((res=_r.step_take_cards_from_stack()))
@@ -557,4 +755,108 @@ game_error player::showdown(blob& their_proof, bool muck) {
     return SUCCESS;
 }
 
+game_error player::make_runout_proof(blob& dst, blob& public_proof) {
+    game_error res;
+    auto first = 0;
+    while (public_card(first) != cards::uk)
+        first++;
+    blob private_proof;
+    if ((res = make_card_proof(public_proof, public_card_index(first), NUM_PUBLIC_CARDS - first)))
+        return res;
+    if ((res = make_card_proof(private_proof, private_card_index(_id, 0), NUM_PRIVATE_CARDS)))
+        return res;
+    return write_runout_proofs(dst, public_proof, private_proof);
+}
+
+game_error player::runout(blob& my_public_proof, blob& their_runout_proof) {
+    game_error res;
+    blob their_public_proof, their_private_proof;
+    if ((res = read_runout_proofs(their_runout_proof, their_public_proof, their_private_proof)))
+        return res;
+
+    // only the opponent's cards are still closed
+    blob alice_private_proofs[NUM_PLAYERS], bob_private_proofs[NUM_PLAYERS];
+    auto& alice_public_proof = _id == ALICE ? my_public_proof : their_public_proof;
+    auto& bob_public_proof = _id == BOB ? my_public_proof : their_public_proof;
+    (_id == ALICE ? alice_private_proofs : bob_private_proofs)[_opponent_id] = _proof_of_their_cards;
+    (_id == BOB ? alice_private_proofs : bob_private_proofs)[_opponent_id] = their_private_proof;
+    if ((res = _r.step_runout(alice_public_proof, bob_public_proof, alice_private_proofs, bob_private_proofs)))
+        return res;
+
+    logger << ">>> " << _id << ": " << _r.game().to_json() << std::endl;
+    return SUCCESS;
+}
+
+// snapshot: magic, compressed size (4 bytes, big endian), brotli of the codec encoded state
+static const char snapshot_magic[] = { 'P', 'K', 'S', '2' };
+
+game_error player::save(std::ostream& out) {
+    arena_scope scope(_arena);
+    game_error res;
+    std::ostringstream os;
+    encoder e(os);
+    if ((res = e.write(_id)) || (res = e.write(_alice_money)) || (res = e.write(_bob_money)) ||
+        (res = e.write(_big_blind)) || (res = e.write(_my_key)) || (res = e.write(_proof_of_their_cards)) ||
+        (res = e.write((int)_public_proofs.size())))
+        return res;
+    for (auto& p : _public_proofs)
+        if ((res = e.write((int)p.first)) || (res = e.write(p.second)))
+            return res;
+    if ((res = _p->save(os)) || (res = _r.save(os)))
+        return res;
+
+    std::string packed;
+    if ((res = compress(os.str(), packed)))
+        return res;
+    unsigned char size[4] = { (unsigned char)(packed.size() >> 24), (unsigned char)(packed.size() >> 16),
+                              (unsigned char)(packed.size() >> 8), (unsigned char)packed.size() };
+    out.write(snapshot_magic, sizeof(snapshot_magic));
+    out.write((char*)size, sizeof(size));
+    out.write(packed.data(), packed.size());
+    return out.good() ? SUCCESS : PRR_INVALID_SNAPSHOT;
+}
+
+game_error player::load(std::istream& in) {
+    arena_scope scope(_arena);
+    game_error res;
+    char magic[sizeof(snapshot_magic)];
+    unsigned char size[4];
+    if ((res = read_exactly(in, sizeof(magic), magic)) || (res = read_exactly(in, sizeof(size), (char*)size)))
+        return res;
+    if (memcmp(magic, snapshot_magic, sizeof(magic)))
+        return PRR_INVALID_SNAPSHOT;
+    std::string packed, data;
+    int packed_size = size[0] << 24 | size[1] << 16 | size[2] << 8 | size[3];
+    if (packed_size < 0)
+        return PRR_INVALID_SNAPSHOT;
+    if ((res = read_exactly(in, packed_size, packed)) || (res = decompress(packed, data)))
+        return res;
+
+    std::istringstream is(data);
+    decoder d(is);
+    int id, proof_count;
+    if ((res = d.read(id)) || (res = d.read(_alice_money)) || (res = d.read(_bob_money)) ||
+        (res = d.read(_big_blind)) || (res = d.read(_my_key)) || (res = d.read(_proof_of_their_cards)) ||
+        (res = d.read(proof_count)))
+        return res;
+    if (id != ALICE && id != BOB)
+        return PRR_INVALID_SNAPSHOT;
+    _public_proofs.clear();
+    for (auto i = 0; i < proof_count; i++) {
+        int step;
+        blob proof;
+        if ((res = d.read(step)) || (res = d.read(proof)))
+            return res;
+        _public_proofs[(game_step)step] = proof;
+    }
+    if (id != _id) {
+        _id = id;
+        _opponent_id = opponent_id(id);
+        _p->init(id, 3, false);
+    }
+    if ((res = _p->load(is)) || (res = _r.load(is)))
+        return res;
+    return SUCCESS;
+}
+
 }
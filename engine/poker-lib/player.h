@@ -3,20 +3,32 @@
 
 #include <map>
 
+#include "equity.h"
+#include "game-arena.h"
 #include "messages.h"
 #include "referee.h"
 
 namespace poker {
 
+struct poker_lib_options;
+
+/// Whether players starting a handshake use the short handshake: four
+/// messages instead of five, see msg_short_vtmf. The opponent answers in the
+/// handshake it receives. Players configured with their own options use
+/// theirs instead.
+void set_short_handshake(bool enabled);
+
 /*
 * A player of the game
 */
 class player {
    protected:
+    game_arena _arena;  // first, so that it outlives everything allocated in it
     int _id;
     int _opponent_id;
     i_participant* _p;
     referee _r;
+    bool _short_handshake;
 
     // saved initialization arguments
     money_t _alice_money, _bob_money, _big_blind;
@@ -27,8 +39,15 @@ class player {
     blob _proof_of_their_cards;
     std::map<game_step, blob> _public_proofs;
 
+    player(int id, i_participant* p, i_participant* eve, bool short_handshake);
+
    public:
     player(int id);
+    /// A player configured apart from the library and from other players:
+    /// encryption, winner and short_handshake are taken from opts, so that
+    /// tables of different configurations may run side by side. The other
+    /// options are process wide, see init_poker_lib().
+    player(int id, const poker_lib_options& opts);
     virtual ~player();
 
     game_state& game() { return _r.game(); }
@@ -71,6 +90,10 @@ class player {
     /// Upon successful return, check msg_out.empty() to determine
     /// if it must be sent to the opponent.
     /// The bet type and amount will be copied to out_type and out_amt, if they are not null
+    ///
+    /// msg_in may be a batch of the opponent's consecutive messages (see
+    /// batch_frames()). They are processed in order, the results are those
+    /// of the last one, and only the last one may call for a response.
     game_error process_bet(std::string& msg_in, std::string& msg_out, bet_type* out_type = NULL, money_t* out_amt = NULL);
 
     /// Property accessors
@@ -83,6 +106,15 @@ class player {
     int winner() { return _r.game().winner; }
     int current_player() { return _r.game().current_player; }
 
+    /// Equity of this player's hand from the cards it knows so far
+    game_error equity(const equity_options& opts, equity_result& result) { return compute_equity(_r.game(), _id, opts, result); }
+
+    /// Snapshot of the whole player state: participant secrets, referee,
+    /// saved proofs. Restoring it on another host continues the game where
+    /// it was saved. On a failed load the player must be discarded.
+    game_error save(std::ostream& out);
+    game_error load(std::istream& in);
+
    private:
     /// message handlers
     game_error handle_vtmf(msg_vtmf* msgin, message** out);
@@ -90,6 +122,12 @@ class player {
     game_error handle_vsshe(msg_vsshe* msgin, message** out);
     game_error handle_vsshe_response(msg_vsshe_response* msgin, message** out);
     game_error handle_bob_private_cards(msg_bob_private_cards* msgin);
+    game_error handle_short_vtmf(msg_short_vtmf* msgin, message** out);
+    game_error handle_short_vtmf_response(msg_short_vtmf_response* msgin, message** out);
+    game_error handle_alice_mix(msg_alice_mix* msgin, message** out);
+    game_error handle_alice_private_cards(msg_alice_private_cards* msgin);
+    game_error load_vtmf(msg_vtmf* msgin, blob& bob_key);
+    game_error process_bet_message(const std::string& decompressed, std::string& out, bet_type* out_type, money_t* out_amt);
     game_error handle_bet_request(msg_bet_request* msgin, message** out);
     game_error handle_card_proof(msg_card_proof* msgin, message** out);
 
@@ -98,6 +136,8 @@ class player {
     game_error load_opponent_key(blob& key);
     game_error make_card_proof(blob& proof, int start_card_ix, int count);
     game_error showdown(blob& their_proof, bool muck = false);
+    game_error make_runout_proof(blob& dst, blob& public_proof);
+    game_error runout(blob& my_public_proof, blob& their_runout_proof);
     game_error deal_cards();
     game_error prove_opponent_cards(blob& proofs);
     game_error open_public_cards(game_step step, blob& my_proof, blob& their_proof);
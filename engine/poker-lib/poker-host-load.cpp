@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "codec.h"
+#include "hand-driver.h"
+#include "host-protocol.h"
+#include "poker-lib.h"
+
+using namespace poker;
+
+/*
+   Load for poker-host: <pairs> simulated tables at once, each a pair of the
+   host's tables playing each other over a connection of its own. A hand is
+   a handshake and an all-in preflop, as in bench-tables. Reports hands per
+   second and the latency of turns, a turn being a request and its response.
+
+   Usage: poker-host-load [-n <pairs>] [-h <hands per pair>] [-e] <socket-path>
+
+   -e plays encrypted hands; they are unencrypted otherwise.
+*/
+
+class host_client {
+    int _fd;
+    int _next_id;
+
+public:
+    std::vector<double> latencies;  // ms, one per request
+
+    host_client() : _fd(-1), _next_id(1) {}
+    ~host_client() {
+        if (_fd >= 0)
+            close(_fd);
+    }
+
+    game_error connect(const char* path) {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+        _fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (_fd < 0 || ::connect(_fd, (sockaddr*)&addr, sizeof(addr)))
+            return HST_SOCKET_ERROR;
+        return SUCCESS;
+    }
+
+    // sends a request and waits for its response; results are what follows the result code
+    game_error call(host_op op, int table, const std::string& args, std::string& results) {
+        game_error res;
+        int id = _next_id++;
+        std::stringstream out;
+        encoder e(out);
+        e.write(id);
+        e.write(op);
+        e.write(table);
+        out << args;
+
+        auto start = std::chrono::steady_clock::now();
+        std::string payload;
+        if ((res = write_host_frame(_fd, out.str())) || (res = read_host_frame(_fd, payload)))
+            return res;
+        latencies.push_back(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+        std::stringstream in(payload);
+        decoder d(in);
+        int reply_id, result;
+        if ((res = d.read(reply_id)) || (res = d.read(result)))
+            return res;
+        if (reply_id != id)
+            return COD_ERROR;
+        auto pos = in.tellg();
+        results = pos < 0 ? "" : payload.substr(pos);
+        return (game_error)result;
+    }
+};
+
+static std::string encode(const std::string& s) {
+    std::stringstream out;
+    encoder e(out);
+    e.write(s);
+    return out.str();
+}
+
+static game_error new_table(host_client& c, int player_id, const poker_lib_options& opts, int& table) {
+    std::stringstream args;
+    encoder e(args);
+    e.write(player_id);
+    e.write(opts.encryption);
+    e.write(opts.winner);
+    e.write(opts.short_handshake);
+    e.write(money_t(100));
+    e.write(money_t(300));
+    e.write(money_t(10));
+    std::string results;
+    game_error res = c.call(HOST_NEW_TABLE, 0, args.str(), results);
+    if (res)
+        return res;
+    std::stringstream in(results);
+    return decoder(in).read(table);
+}
+
+// the message a request answers with
+static game_error call(host_client& c, host_op op, int table, const std::string& args, std::string& msg_out) {
+    std::string results;
+    game_error res = c.call(op, table, args, results);
+    if (res && res != CONTINUED)
+        return res;
+    std::stringstream in(results);
+    msg_out.clear();  // an empty message is not read into it
+    game_error err = decoder(in).read(msg_out);
+    return err ? err : res;
+}
+
+static std::string bet(bet_type type, money_t amount) {
+    std::stringstream out;
+    encoder e(out);
+    e.write(type);
+    e.write(amount);
+    return out.str();
+}
+
+// a table of the host, played like a player, see hand-driver.h
+struct host_seat {
+    host_client& c;
+    int table;
+
+    game_error create_handshake(std::string& msg_out) {
+        return call(c, HOST_CREATE_HANDSHAKE, table, "", msg_out);
+    }
+    game_error process_handshake(std::string& msg_in, std::string& msg_out) {
+        return call(c, HOST_PROCESS_HANDSHAKE, table, encode(msg_in), msg_out);
+    }
+    game_error create_bet(bet_type type, money_t amount, std::string& msg_out) {
+        return call(c, HOST_CREATE_BET, table, bet(type, amount), msg_out);
+    }
+    game_error process_bet(std::string& msg_in, std::string& msg_out) {
+        return call(c, HOST_PROCESS_BET, table, encode(msg_in), msg_out);
+    }
+};
+
+static game_error play(host_client& c, const poker_lib_options& opts) {
+    game_error res;
+    host_seat alice{c, 0}, bob{c, 0};
+    std::string ignored;
+    if ((res = new_table(c, ALICE, opts, alice.table)) || (res = new_table(c, BOB, opts, bob.table)) ||
+        (res = play_all_in(alice, bob)))
+        return res;
+    if ((res = c.call(HOST_DELETE_TABLE, alice.table, "", ignored)) ||
+        (res = c.call(HOST_DELETE_TABLE, bob.table, "", ignored)))
+        return res;
+    return SUCCESS;
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty())
+        return 0;
+    return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+}
+
+static void usage() {
+    fprintf(stderr, "Usage: poker-host-load [-n <pairs>] [-h <hands per pair>] [-e] <socket-path>\n");
+}
+
+int main(int argc, char** argv) {
+    int pairs = std::max(1, (int)std::thread::hardware_concurrency());
+    int hands = 10;
+    bool encryption = false;
+    const char* path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            pairs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-h") && i + 1 < argc)
+            hands = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-e"))
+            encryption = true;
+        else if (!path && argv[i][0] != '-')
+            path = argv[i];
+        else
+            return usage(), 1;
+    }
+    if (!path || pairs < 1 || hands < 1)
+        return usage(), 1;
+
+    std::atomic<int> errors(0);
+    std::mutex lock;
+    std::vector<double> latencies;
+    auto work = [&](int pair) {
+        host_client c;
+        game_error res = c.connect(path);
+        poker_lib_options opts;
+        opts.encryption = encryption;
+        for (int i = 0; !res && i < hands; i++) {
+            opts.winner = (pair + i) % 2 ? BOB : ALICE;
+            res = play(c, opts);
+        }
+        if (res && !errors++)
+            fprintf(stderr, "Error %d playing a hand\n", res);
+        std::lock_guard<std::mutex> l(lock);
+        latencies.insert(latencies.end(), c.latencies.begin(), c.latencies.end());
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int i = 0; i < pairs; i++)
+        pool.emplace_back(work, i);
+    for (auto& t : pool)
+        t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (errors)
+        return 1;
+
+    std::sort(latencies.begin(), latencies.end());
+    printf("%8s %8s %12s %10s %10s %10s\n", "pairs", "hands", "hands/s", "turns", "p50_ms", "p99_ms");
+    printf("%8d %8d %12.2f %10zu %10.2f %10.2f\n", pairs, pairs * hands, pairs * hands / seconds, latencies.size(),
+           percentile(latencies, 0.5), percentile(latencies, 0.99));
+    return 0;
+}
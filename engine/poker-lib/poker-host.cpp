@@ -0,0 +1,122 @@
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "host-server.h"
+#include "poker-lib.h"
+
+using namespace poker;
+
+/*
+   Plays many tables at once for its clients, one player per table, over a
+   Unix domain socket. The protocol is in host-protocol.h.
+
+   One thread does the socket I/O; the crypto of every table runs on a fixed
+   pool of workers, one request of a table at a time and in order. A table
+   holds at most <queue> pending requests; more are answered HST_TABLE_BUSY.
+   A connection is not read while <inflight> of its requests are pending or
+   its responses are not read, so clients are slowed down by their tables
+   instead of growing the queues. Tables belong to the connection that
+   created them and go away when it closes, with their requests not
+   started yet. The requests and the I/O loop are in host-server.h.
+
+   Usage: poker-host [-j <threads>] [-q <queue>] [-i <inflight>] <socket-path>
+*/
+
+static const int default_table_queue = 8;
+static const int default_inflight = 64;
+static const size_t max_unsent = 1024 * 1024;
+
+static int wake_pipe[2];
+static volatile sig_atomic_t stopping = 0;
+static int table_queue = default_table_queue;
+static int max_inflight = default_inflight;
+
+static void wake() {
+    // a full pipe is as good: the I/O thread is due to wake anyway
+    char b = 0;
+    ssize_t n = write(wake_pipe[1], &b, 1);
+    (void)n;
+}
+
+static void on_signal(int) {
+    stopping = 1;
+    wake();
+}
+
+static bool set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static int listen_on(const char* path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) || listen(fd, SOMAXCONN) || !set_nonblocking(fd)) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void usage() {
+    fprintf(stderr, "Usage: poker-host [-j <threads>] [-q <queue>] [-i <inflight>] <socket-path>\n");
+}
+
+int main(int argc, char** argv) {
+    int threads = 0;
+    const char* path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-j") && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-q") && i + 1 < argc)
+            table_queue = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-i") && i + 1 < argc)
+            max_inflight = atoi(argv[++i]);
+        else if (!path && argv[i][0] != '-')
+            path = argv[i];
+        else
+            return usage(), 1;
+    }
+    if (!path || threads < 0 || table_queue < 1 || max_inflight < 1)
+        return usage(), 1;
+
+    init_poker_lib();
+    if (pipe(wake_pipe) || !set_nonblocking(wake_pipe[0]) || !set_nonblocking(wake_pipe[1])) {
+        perror("pipe");
+        return 1;
+    }
+    int listener = listen_on(path);
+    if (listener < 0)
+        return 1;
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    fprintf(stderr, "Listening on %s\n", path);
+    {
+        host_server server(threads, table_queue, max_inflight, max_unsent, wake);
+        serve(server, listener, wake_pipe[0], {}, []() { return stopping != 0; });
+    }
+    close(listener);
+    unlink(path);
+    return 0;
+}
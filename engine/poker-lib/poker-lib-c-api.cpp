@@ -1,14 +1,87 @@
 #include <iostream>
 #include <stdio.h>
+#include <cstring>
+#include <map>
+#include <deque>
+#include <vector>
+#ifdef POKER_THREADS
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+#include "compression.h"
 #include "i_participant.h"
 #include "poker-lib.h"
 #include "player.h"
+#include "task-pool.h"
 
 #ifdef WINDOWS
   #define PAPI __declspec(dllexport)
 #endif
 #include "poker-lib-c-api.h"
 
+namespace {
+
+// what a call produces besides its error, before it is handed to the caller
+struct call_result {
+  std::string msg_out;
+  poker::bet_type type;
+  poker::money_t amt;
+  call_result() : type(poker::BET_NONE) {}
+};
+
+}  // namespace
+
+// The work of the calls made synchronously and asynchronously alike
+static poker::game_error process_handshake(poker::player* p, std::string& msg_in, call_result& r) {
+  return p->process_handshake(msg_in, r.msg_out);
+}
+
+static poker::game_error create_bet(poker::player* p, poker::bet_type type, poker::money_t amt, call_result& r) {
+  return p->create_bet(type, amt, r.msg_out);
+}
+
+static poker::game_error process_bet(poker::player* p, std::string& msg_in, call_result& r) {
+  return p->process_bet(msg_in, r.msg_out, &r.type, &r.amt);
+}
+
+static void copy_message(const std::string& src, PAPI_MESSAGE* msg_out, PAPI_INT* msg_out_len) {
+  *msg_out_len = (PAPI_INT)src.size();
+  *msg_out = NULL;
+  if (src.size()) {
+    *msg_out = new char[src.size()];
+    memcpy(*msg_out, src.data(), src.size());
+  }
+}
+
+// Messages kept for papi_read_message, by player
+namespace {
+
+struct kept_message {
+  poker::game_error res;
+  std::string msg;
+};
+
+}  // namespace
+
+static std::map<PAPI_PLAYER, kept_message> kept_messages;
+#ifdef POKER_THREADS
+static std::mutex kept_lock;
+#define LOCK_KEPT() std::lock_guard<std::mutex> lock(kept_lock)
+#else
+#define LOCK_KEPT()
+#endif
+
+static void forget_message(PAPI_PLAYER player) {
+  LOCK_KEPT();
+  kept_messages.erase(player);
+}
+
+static bool message_kept(PAPI_PLAYER player) {
+  LOCK_KEPT();
+  return kept_messages.count(player) != 0;
+}
+
 extern "C" PAPI PAPI_ERR papi_init(PAPI_BOOL encryption, PAPI_BOOL logging, PAPI_INT winner) {
   poker::poker_lib_options options;
   options.encryption = encryption;
@@ -23,7 +96,18 @@ extern "C" PAPI PAPI_ERR papi_new_player(PAPI_INT player_id, PAPI_PLAYER* player
   return PAPI_SUCCESS;
 }
 
+extern "C" PAPI PAPI_ERR papi_new_player_with_options(PAPI_INT player_id, PAPI_BOOL encryption, PAPI_INT winner, PAPI_BOOL short_handshake,
+                                                      PAPI_PLAYER* player) {
+  poker::poker_lib_options options;
+  options.encryption = encryption;
+  options.winner = winner;
+  options.short_handshake = short_handshake;
+  *player = new poker::player(player_id, options);
+  return PAPI_SUCCESS;
+}
+
 extern "C" PAPI PAPI_ERR papi_delete_player(PAPI_PLAYER player) {
+  forget_message(player);
   delete ((poker::player*)player);
   return PAPI_SUCCESS;
 }
@@ -31,10 +115,10 @@ extern "C" PAPI PAPI_ERR papi_delete_player(PAPI_PLAYER player) {
 extern "C" PAPI PAPI_ERR papi_init_player(PAPI_PLAYER player, PAPI_MONEY alice_money, PAPI_MONEY bob_money, PAPI_MONEY big_blind) {
   poker::player* p = (poker::player*)player;
   poker::money_t am, bm, bb;
-  am.parse_string(alice_money);
-  bm.parse_string(bob_money);
-  bb.parse_string(big_blind);
-  auto res = p->init(am, bm, bb);
+  poker::game_error res;
+  if ((res = am.parse_string(alice_money)) || (res = bm.parse_string(bob_money)) || (res = bb.parse_string(big_blind)))
+    return (PAPI_ERR)res;
+  res = p->init(am, bm, bb);
   return (PAPI_ERR)res;
 }
 
@@ -62,70 +146,50 @@ extern "C" PAPI PAPI_ERR papi_delete_message(PAPI_MESSAGE msg) {
 }
 
 extern "C" PAPI PAPI_ERR papi_process_handshake(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_MESSAGE* msg_out, PAPI_INT* msg_out_len) {
-  std::string tmp;
   *msg_out_len = 0;
   *msg_out = NULL;
-
-  poker::player* p = (poker::player*)player;
-  std::string mi = std::string(msg_in, msg_in_len);
-  auto res = p->process_handshake(mi, tmp);
+  call_result r;
+  std::string mi(msg_in, msg_in_len);
+  auto res = process_handshake((poker::player*)player, mi, r);
   if (res && res != poker::CONTINUED)
     return (PAPI_ERR)res;
 
-  *msg_out_len = (PAPI_INT)tmp.size();
-  if (tmp.size()) {
-    *msg_out = new char[tmp.size()];
-    memcpy(*msg_out, tmp.data(), tmp.size());
-  }
-  
+  copy_message(r.msg_out, msg_out, msg_out_len);
   return (PAPI_ERR)res;
 }
 
 extern "C" PAPI PAPI_ERR papi_create_bet(PAPI_PLAYER player, PAPI_INT bet_type, PAPI_MONEY amt, PAPI_MESSAGE* msg_out, PAPI_INT* msg_out_len) {
-  poker::player* p = (poker::player*)player;
   poker::money_t a;
-  a.parse_string(amt);
-
-  std::string tmp;
   *msg_out_len = 0;
   *msg_out = NULL;
-  auto res = p->create_bet((poker::bet_type)bet_type, a, tmp);
+  auto res = a.parse_string(amt);
+  if (res)
+    return (PAPI_ERR)res;
+  call_result r;
+  res = create_bet((poker::player*)player, (poker::bet_type)bet_type, a, r);
   if (res && res != poker::CONTINUED)
     return (PAPI_ERR)res;
 
-  *msg_out_len = tmp.size();
-  if (tmp.size()) {
-    *msg_out = new char[tmp.size()];
-    memcpy(*msg_out, tmp.data(), tmp.size());
-  }
-
+  copy_message(r.msg_out, msg_out, msg_out_len);
   return (PAPI_ERR)res;
 }
 
 extern "C" PAPI PAPI_ERR papi_process_bet(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_MESSAGE* msg_out, PAPI_INT* msg_out_len, PAPI_INT* type, PAPI_STR amt, int amt_len) {
-  poker::money_t am;
-  poker::bet_type tp;
-  std::string tmp;
   *msg_out_len = 0;
   *msg_out = NULL;
-  poker::player* p = (poker::player*)player;
-  std::string mi = std::string(msg_in, msg_in_len);
-  auto res = p->process_bet(mi, tmp, &tp, &am);
+  call_result r;
+  std::string mi(msg_in, msg_in_len);
+  auto res = process_bet((poker::player*)player, mi, r);
   if (res && res != poker::CONTINUED)
     return (PAPI_ERR)res;
 
-  *msg_out_len = tmp.size();
-  if (tmp.size()) {
-    *msg_out = new char[tmp.size()];
-    memcpy(*msg_out, tmp.data(), tmp.size());
-  }
-
+  copy_message(r.msg_out, msg_out, msg_out_len);
   if (type)
-    *type = (PAPI_INT)tp;
+    *type = (PAPI_INT)r.type;
 
   if (amt && amt_len) {
-    auto tmp2 = am.to_string();
-    strncpy(amt, tmp2.c_str(), amt_len);
+    auto tmp = r.amt.to_string();
+    strncpy(amt, tmp.c_str(), amt_len);
   }
 
   return (PAPI_ERR)res;
@@ -141,3 +205,396 @@ extern "C" PAPI PAPI_ERR papi_get_game_state(PAPI_PLAYER player, PAPI_STR json,
   return PAPI_SUCCESS;
 }
 
+extern "C" PAPI PAPI_ERR papi_batch_messages(PAPI_MESSAGE first, PAPI_INT first_len, PAPI_MESSAGE second, PAPI_INT second_len,
+                                             PAPI_MESSAGE* batch_out, PAPI_INT* batch_out_len) {
+  std::vector<std::string> frames{ std::string(first, first_len), std::string(second, second_len) };
+  std::string batch;
+  auto res = poker::batch_frames(frames, batch);
+  copy_message(batch, batch_out, batch_out_len);
+  return (PAPI_ERR)res;
+}
+
+extern "C" PAPI PAPI_ERR papi_save_player(PAPI_PLAYER player, PAPI_MESSAGE* snapshot_out, PAPI_INT* snapshot_out_len) {
+  poker::player* p = (poker::player*)player;
+  *snapshot_out = NULL;
+  *snapshot_out_len = 0;
+
+  std::ostringstream os;
+  auto res = p->save(os);
+  if (res)
+    return (PAPI_ERR)res;
+
+  auto tmp = os.str();
+  *snapshot_out_len = (PAPI_INT)tmp.size();
+  *snapshot_out = new char[tmp.size()];
+  memcpy(*snapshot_out, tmp.data(), tmp.size());
+
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_load_player(PAPI_PLAYER player, PAPI_MESSAGE snapshot, PAPI_INT snapshot_len) {
+  poker::player* p = (poker::player*)player;
+  std::istringstream is(std::string(snapshot, snapshot_len));
+  return (PAPI_ERR)p->load(is);
+}
+
+extern "C" PAPI PAPI_ERR papi_compute_equity(PAPI_PLAYER player, PAPI_INT max_samples, double precision, PAPI_INT seed, PAPI_INT threads,
+                                             double* win, double* tie, double* loss, PAPI_INT* samples) {
+  poker::player* p = (poker::player*)player;
+  poker::equity_options opts;
+  opts.max_samples = max_samples;
+  opts.precision = precision;
+  opts.seed = (uint32_t)seed;
+  opts.threads = threads;
+  poker::equity_result r;
+  auto res = p->equity(opts, r);
+  if (res)
+    return (PAPI_ERR)res;
+
+  *win = r.win;
+  *tie = r.tie;
+  *loss = r.loss;
+  *samples = (PAPI_INT)r.samples;
+  return PAPI_SUCCESS;
+}
+
+// Asynchronous calls
+
+namespace {
+
+struct pending_task {
+  PAPI_CALLBACK callback;
+  void* user_data;
+};
+
+}  // namespace
+
+static poker::task_pool* workers = NULL;
+static bool stopping = false;  // papi_stop_workers() is waiting for the running tasks
+static thread_local bool in_task = false;  // a worker running a task, callback included
+static PAPI_TASK last_task = 0;
+static std::map<PAPI_TASK, pending_task> pending;
+static std::deque<PAPI_COMPLETION> completions;
+#ifdef POKER_THREADS
+static std::mutex async_lock;
+static std::condition_variable completed;
+#define LOCK_ASYNC() std::unique_lock<std::mutex> lock(async_lock)
+#else
+#define LOCK_ASYNC()
+#endif
+
+static void deliver(PAPI_COMPLETION& c, const pending_task& t) {
+  if (t.callback) {
+    t.callback(&c, t.user_data);
+    return;
+  }
+  LOCK_ASYNC();
+  completions.push_back(c);
+#ifdef POKER_THREADS
+  completed.notify_all();
+#endif
+}
+
+static void complete(PAPI_TASK task, poker::game_error res, const call_result& r) {
+  pending_task t;
+  {
+    LOCK_ASYNC();
+    auto it = pending.find(task);
+    if (it == pending.end())
+      return;
+    t = it->second;
+    pending.erase(it);
+  }
+
+  PAPI_COMPLETION c;
+  memset(&c, 0, sizeof(c));
+  c.task = task;
+  c.result = (PAPI_ERR)res;
+  if (!res || res == poker::CONTINUED) {
+    copy_message(r.msg_out, &c.msg_out, &c.msg_out_len);
+    c.type = (PAPI_INT)r.type;
+    strncpy(c.amt, r.amt.to_string().c_str(), sizeof(c.amt) - 1);
+  }
+  deliver(c, t);
+}
+
+static void complete_cancelled(PAPI_TASK task, const pending_task& t) {
+  PAPI_COMPLETION c;
+  memset(&c, 0, sizeof(c));
+  c.task = task;
+  c.result = poker::APR_CANCELLED;
+  deliver(c, t);
+}
+
+static PAPI_ERR submit(PAPI_PLAYER player, PAPI_CALLBACK callback, void* user_data, PAPI_TASK* task,
+                       std::function<poker::game_error(call_result&)> work) {
+  PAPI_TASK id;
+  {
+    LOCK_ASYNC();
+    if (stopping)
+      return poker::APR_WORKERS_STOPPING;
+    if (!workers)
+      workers = new poker::task_pool();
+    if (++last_task <= 0)
+      last_task = 1;
+    id = last_task;
+    pending[id] = pending_task{callback, user_data};
+    *task = id;
+    // under the lock, so that papi_stop_workers() can't delete the pool meanwhile
+    workers->queue(id, player, [id, work]() {
+      in_task = true;
+      call_result r;
+      auto res = work(r);
+      complete(id, res, r);
+      in_task = false;
+    });
+  }
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_start_workers(PAPI_INT threads) {
+  LOCK_ASYNC();
+  if (stopping)
+    return poker::APR_WORKERS_STOPPING;
+  if (workers)
+    return poker::APR_WORKERS_RUNNING;
+  workers = new poker::task_pool(threads);
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_stop_workers() {
+  // the pool would wait for the very task calling
+  if (in_task)
+    return poker::APR_WORKER_THREAD;
+  poker::task_pool* pool;
+  {
+    LOCK_ASYNC();
+    if (stopping)
+      return poker::APR_WORKERS_STOPPING;
+    stopping = true;
+    pool = workers;
+  }
+  // the running tasks complete meanwhile, and can't queue others
+  delete pool;
+
+  // tasks still pending were dropped by the pool
+  std::map<PAPI_TASK, pending_task> dropped;
+  {
+    LOCK_ASYNC();
+    workers = NULL;
+    stopping = false;
+    dropped.swap(pending);
+  }
+  for (auto& t : dropped)
+    complete_cancelled(t.first, t.second);
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_process_handshake_async(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len,
+                                                      PAPI_CALLBACK callback, void* user_data, PAPI_TASK* task) {
+  poker::player* p = (poker::player*)player;
+  std::string mi(msg_in, msg_in_len);
+  return submit(player, callback, user_data, task, [p, mi](call_result& r) mutable {
+    return process_handshake(p, mi, r);
+  });
+}
+
+extern "C" PAPI PAPI_ERR papi_create_bet_async(PAPI_PLAYER player, PAPI_INT bet_type, PAPI_MONEY amt,
+                                               PAPI_CALLBACK callback, void* user_data, PAPI_TASK* task) {
+  poker::player* p = (poker::player*)player;
+  poker::money_t a;
+  auto res = a.parse_string(amt);
+  if (res)
+    return (PAPI_ERR)res;
+  return submit(player, callback, user_data, task, [p, bet_type, a](call_result& r) {
+    return create_bet(p, (poker::bet_type)bet_type, a, r);
+  });
+}
+
+extern "C" PAPI PAPI_ERR papi_process_bet_async(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len,
+                                                PAPI_CALLBACK callback, void* user_data, PAPI_TASK* task) {
+  poker::player* p = (poker::player*)player;
+  std::string mi(msg_in, msg_in_len);
+  return submit(player, callback, user_data, task, [p, mi](call_result& r) mutable {
+    return process_bet(p, mi, r);
+  });
+}
+
+extern "C" PAPI PAPI_ERR papi_cancel(PAPI_TASK task) {
+  pending_task t;
+  {
+    LOCK_ASYNC();
+    auto it = pending.find(task);
+    if (it == pending.end())
+      return poker::APR_TASK_NOT_FOUND;
+    if (stopping)
+      return poker::APR_WORKERS_STOPPING;
+    if (!workers || !workers->cancel(task))
+      return poker::APR_TASK_STARTED;
+    t = it->second;
+    pending.erase(it);
+  }
+  complete_cancelled(task, t);
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_poll_completion(PAPI_COMPLETION* completion, PAPI_INT timeout_ms) {
+  LOCK_ASYNC();
+#ifdef POKER_THREADS
+  auto ready = []() { return !completions.empty(); };
+  if (timeout_ms < 0)
+    completed.wait(lock, ready);
+  else
+    completed.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+#endif
+  if (completions.empty())
+    return poker::APR_NO_COMPLETION;
+  *completion = completions.front();
+  completions.pop_front();
+  return PAPI_SUCCESS;
+}
+
+// Calls into buffers of the caller
+
+// the same on every call of a thread, so their capacity is reused
+static thread_local std::string buf_msg_in;
+static thread_local call_result buf_result;
+
+static void clear_result() {
+  buf_result.msg_out.clear();
+  buf_result.type = poker::BET_NONE;
+  buf_result.amt = 0;
+}
+
+// into msg_out if it fits, otherwise kept for papi_read_message. The move
+// is made either way, so calls into buffers refuse to run while a message
+// is kept: it would be the only copy.
+static PAPI_ERR write_message(PAPI_PLAYER player, poker::game_error res, std::string& msg,
+                              PAPI_MESSAGE msg_out, PAPI_INT msg_out_cap, PAPI_INT* msg_out_len) {
+  *msg_out_len = (PAPI_INT)msg.size();
+  if (msg.size() <= (size_t)(msg_out_cap > 0 ? msg_out_cap : 0)) {
+    if (msg.size())
+      memcpy(msg_out, msg.data(), msg.size());
+    return (PAPI_ERR)res;
+  }
+  LOCK_KEPT();
+  auto& kept = kept_messages[player];
+  kept.res = res;
+  kept.msg.assign(msg);
+  return poker::APR_BUFFER_TOO_SMALL;
+}
+
+extern "C" PAPI PAPI_ERR papi_init_player_bin(PAPI_PLAYER player, const unsigned char* alice_money, const unsigned char* bob_money,
+                                              const unsigned char* big_blind) {
+  poker::player* p = (poker::player*)player;
+  poker::money_t am, bm, bb;
+  poker::game_error res;
+  if ((res = am.load_binary_be((const char*)alice_money, PAPI_MONEY_BYTES)) ||
+      (res = bm.load_binary_be((const char*)bob_money, PAPI_MONEY_BYTES)) ||
+      (res = bb.load_binary_be((const char*)big_blind, PAPI_MONEY_BYTES)))
+    return (PAPI_ERR)res;
+  return (PAPI_ERR)p->init(am, bm, bb);
+}
+
+extern "C" PAPI PAPI_ERR papi_create_handshake_buf(PAPI_PLAYER player, PAPI_MESSAGE msg_out, PAPI_INT msg_out_cap, PAPI_INT* msg_out_len) {
+  poker::player* p = (poker::player*)player;
+  *msg_out_len = 0;
+  if (message_kept(player))
+    return poker::APR_MESSAGE_PENDING;
+  clear_result();
+  auto res = p->create_handshake(buf_result.msg_out);
+  if (res && res != poker::CONTINUED)
+    return (PAPI_ERR)res;
+  return write_message(player, res, buf_result.msg_out, msg_out, msg_out_cap, msg_out_len);
+}
+
+extern "C" PAPI PAPI_ERR papi_process_handshake_buf(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len,
+                                                    PAPI_MESSAGE msg_out, PAPI_INT msg_out_cap, PAPI_INT* msg_out_len) {
+  *msg_out_len = 0;
+  if (message_kept(player))
+    return poker::APR_MESSAGE_PENDING;
+  clear_result();
+  buf_msg_in.assign(msg_in, msg_in_len);
+  auto res = process_handshake((poker::player*)player, buf_msg_in, buf_result);
+  if (res && res != poker::CONTINUED)
+    return (PAPI_ERR)res;
+  return write_message(player, res, buf_result.msg_out, msg_out, msg_out_cap, msg_out_len);
+}
+
+extern "C" PAPI PAPI_ERR papi_create_bet_buf(PAPI_PLAYER player, PAPI_INT bet_type, const unsigned char* amt,
+                                             PAPI_MESSAGE msg_out, PAPI_INT msg_out_cap, PAPI_INT* msg_out_len) {
+  poker::money_t a;
+  *msg_out_len = 0;
+  if (message_kept(player))
+    return poker::APR_MESSAGE_PENDING;
+  auto res = a.load_binary_be((const char*)amt, PAPI_MONEY_BYTES);
+  if (res)
+    return (PAPI_ERR)res;
+  clear_result();
+  res = create_bet((poker::player*)player, (poker::bet_type)bet_type, a, buf_result);
+  if (res && res != poker::CONTINUED)
+    return (PAPI_ERR)res;
+  return write_message(player, res, buf_result.msg_out, msg_out, msg_out_cap, msg_out_len);
+}
+
+extern "C" PAPI PAPI_ERR papi_process_bet_buf(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len,
+                                              PAPI_MESSAGE msg_out, PAPI_INT msg_out_cap, PAPI_INT* msg_out_len,
+                                              PAPI_INT* type, unsigned char* amt) {
+  *msg_out_len = 0;
+  if (message_kept(player))
+    return poker::APR_MESSAGE_PENDING;
+  clear_result();
+  buf_msg_in.assign(msg_in, msg_in_len);
+  auto res = process_bet((poker::player*)player, buf_msg_in, buf_result);
+  if (res && res != poker::CONTINUED)
+    return (PAPI_ERR)res;
+
+  if (type)
+    *type = (PAPI_INT)buf_result.type;
+  poker::game_error err;
+  if (amt && (err = buf_result.amt.store_binary_be((char*)amt, PAPI_MONEY_BYTES)))
+    return (PAPI_ERR)err;
+  return write_message(player, res, buf_result.msg_out, msg_out, msg_out_cap, msg_out_len);
+}
+
+extern "C" PAPI PAPI_ERR papi_read_message(PAPI_PLAYER player, PAPI_MESSAGE msg_out, PAPI_INT msg_out_cap, PAPI_INT* msg_out_len) {
+  LOCK_KEPT();
+  *msg_out_len = 0;
+  auto it = kept_messages.find(player);
+  if (it == kept_messages.end())
+    return poker::APR_NO_MESSAGE;
+  *msg_out_len = (PAPI_INT)it->second.msg.size();
+  if (it->second.msg.size() > (size_t)(msg_out_cap > 0 ? msg_out_cap : 0))
+    return poker::APR_BUFFER_TOO_SMALL;
+  memcpy(msg_out, it->second.msg.data(), it->second.msg.size());
+  auto res = it->second.res;
+  kept_messages.erase(it);
+  return (PAPI_ERR)res;
+}
+
+extern "C" PAPI PAPI_ERR papi_get_game_state_bin(PAPI_PLAYER player, PAPI_GAME_STATE* state) {
+  poker::player* p = (poker::player*)player;
+  auto& g = p->game();
+  poker::game_error res;
+  memset(state, 0, sizeof(*state));
+  state->step = (PAPI_INT)p->step();
+  state->phase = (PAPI_INT)g.phase;
+  state->current_player = g.current_player;
+  state->next_msg_author = g.next_msg_author;
+  state->last_aggressor = g.last_aggressor;
+  state->error = (PAPI_INT)g.error;
+  state->winner = g.winner;
+  state->muck = g.muck;
+  for (int i = 0; i < poker::NUM_PUBLIC_CARDS; i++)
+    state->public_cards[i] = g.public_cards[i];
+  for (int pl = 0; pl < poker::NUM_PLAYERS; pl++) {
+    auto& ps = g.players[pl];
+    for (int i = 0; i < poker::NUM_PRIVATE_CARDS; i++)
+      state->cards[pl][i] = ps.cards[i];
+    if ((res = ps.total_funds.store_binary_be((char*)state->total_funds[pl], PAPI_MONEY_BYTES)) ||
+        (res = ps.bets.store_binary_be((char*)state->bets[pl], PAPI_MONEY_BYTES)) ||
+        (res = g.funds_share[pl].store_binary_be((char*)state->funds_share[pl], PAPI_MONEY_BYTES)))
+      return (PAPI_ERR)res;
+  }
+  return (PAPI_ERR)g.big_blind.store_binary_be((char*)state->big_blind, PAPI_MONEY_BYTES);
+}
@@ -16,6 +16,43 @@ typedef void* PAPI_PLAYER;
 typedef char* PAPI_MESSAGE;
 typedef char* PAPI_STR;
 typedef char* PAPI_MONEY;
+typedef int32_t PAPI_TASK;
+
+// room for any amount, and its terminator
+#define PAPI_MONEY_LEN 80
+
+// What the synchronous call would have returned, for an asynchronous one
+typedef struct {
+  PAPI_TASK task;
+  PAPI_ERR result;
+  PAPI_MESSAGE msg_out;   // the receiver's, to release with papi_delete_message
+  PAPI_INT msg_out_len;
+  PAPI_INT type;          // papi_process_bet_async: the bet received and its amount
+  char amt[PAPI_MONEY_LEN];
+} PAPI_COMPLETION;
+
+// amounts in binary: unsigned, big-endian, as held by the contracts
+#define PAPI_MONEY_BYTES 32
+
+// game_state, see game-state.h; cards::uk for the cards not known yet
+typedef struct {
+  PAPI_INT step;
+  PAPI_INT phase;
+  PAPI_INT current_player;
+  PAPI_INT next_msg_author;
+  PAPI_INT last_aggressor;
+  PAPI_INT error;
+  PAPI_INT winner;
+  PAPI_BOOL muck;
+  PAPI_INT public_cards[5];
+  PAPI_INT cards[2][2];   // private cards, by player
+  unsigned char total_funds[2][PAPI_MONEY_BYTES];
+  unsigned char bets[2][PAPI_MONEY_BYTES];
+  unsigned char funds_share[2][PAPI_MONEY_BYTES];
+  unsigned char big_blind[PAPI_MONEY_BYTES];
+} PAPI_GAME_STATE;
+
+typedef void (*PAPI_CALLBACK)(const PAPI_COMPLETION* completion, void* user_data);
 
 #ifndef PAPI
   #define PAPI
@@ -25,6 +62,9 @@ extern "C" {
   
 PAPI_ERR PAPI papi_init(PAPI_BOOL encryption, PAPI_BOOL logging, PAPI_INT winner);
 PAPI_ERR PAPI papi_new_player(PAPI_INT player_id, PAPI_PLAYER* player);
+// a player of its own configuration, whatever papi_init set, so that tables may differ
+PAPI_ERR PAPI papi_new_player_with_options(PAPI_INT player_id, PAPI_BOOL encryption, PAPI_INT winner, PAPI_BOOL short_handshake,
+                                           PAPI_PLAYER* player);
 PAPI_ERR PAPI papi_delete_player(PAPI_PLAYER player);
 PAPI_ERR PAPI papi_init_player(PAPI_PLAYER player, PAPI_MONEY alice_money, PAPI_MONEY bob_money, PAPI_MONEY big_blind);
 PAPI_ERR PAPI papi_create_handshake(PAPI_PLAYER player, PAPI_MESSAGE* msg_out, PAPI_INT* msg_out_len);
@@ -32,7 +72,69 @@ PAPI_ERR PAPI papi_delete_message(PAPI_MESSAGE msg);
 PAPI_ERR PAPI papi_process_handshake(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_MESSAGE* msg_out, PAPI_INT* msg_out_len);
 PAPI_ERR PAPI papi_create_bet(PAPI_PLAYER player, PAPI_INT bet_type, PAPI_MONEY amt, PAPI_MESSAGE* msg_out, PAPI_INT* msg_out_len);
 PAPI_ERR PAPI papi_process_bet(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_MESSAGE* msg_out, PAPI_INT* msg_out_len, PAPI_INT* type, PAPI_STR amt, int amt_len);
+// first and then second, frames a player sends in a row (batches or not), as one batch frame
+// for the opponent's papi_process_bet; batch_out must be released with papi_delete_message
+PAPI_ERR PAPI papi_batch_messages(PAPI_MESSAGE first, PAPI_INT first_len, PAPI_MESSAGE second, PAPI_INT second_len,
+                                  PAPI_MESSAGE* batch_out, PAPI_INT* batch_out_len);
 PAPI_ERR PAPI papi_get_game_state(PAPI_PLAYER player, PAPI_STR json, PAPI_INT json_len);
+// snapshot_out must be released with papi_delete_message
+PAPI_ERR PAPI papi_save_player(PAPI_PLAYER player, PAPI_MESSAGE* snapshot_out, PAPI_INT* snapshot_out_len);
+PAPI_ERR PAPI papi_load_player(PAPI_PLAYER player, PAPI_MESSAGE snapshot, PAPI_INT snapshot_len);
+// win, tie and loss fractions of the player's hand; the Monte Carlo arguments as in equity.h, threads 0 for all
+PAPI_ERR PAPI papi_compute_equity(PAPI_PLAYER player, PAPI_INT max_samples, double precision, PAPI_INT seed, PAPI_INT threads,
+                                  double* win, double* tie, double* loss, PAPI_INT* samples);
+
+/*
+ * Asynchronous calls copy their input, queue the work on worker threads and
+ * return a task id at once. Every task completes exactly once: through its
+ * callback, called on a worker thread, or, when the callback is NULL, on
+ * the queue read by papi_poll_completion. The tasks of a player run in the
+ * order queued; the player must not be used otherwise, nor deleted, until
+ * they have completed. Builds without threads run the task before the call
+ * returns.
+ */
+// optional, workers start on first use otherwise; threads 0 for one per hardware thread
+PAPI_ERR PAPI papi_start_workers(PAPI_INT threads);
+// waits for the running tasks; the queued ones complete with APR_CANCELLED.
+// Until it returns, calls queuing or cancelling tasks fail with APR_WORKERS_STOPPING.
+// APR_WORKER_THREAD from a task's callback, which would wait for itself
+PAPI_ERR PAPI papi_stop_workers();
+PAPI_ERR PAPI papi_process_handshake_async(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len,
+                                           PAPI_CALLBACK callback, void* user_data, PAPI_TASK* task);
+PAPI_ERR PAPI papi_create_bet_async(PAPI_PLAYER player, PAPI_INT bet_type, PAPI_MONEY amt,
+                                    PAPI_CALLBACK callback, void* user_data, PAPI_TASK* task);
+PAPI_ERR PAPI papi_process_bet_async(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len,
+                                     PAPI_CALLBACK callback, void* user_data, PAPI_TASK* task);
+// a task not started yet completes with APR_CANCELLED before this returns;
+// APR_TASK_STARTED if too late, APR_TASK_NOT_FOUND once completed
+PAPI_ERR PAPI papi_cancel(PAPI_TASK task);
+// the next completion of a task without callback, waiting up to timeout_ms, -1 for ever;
+// APR_NO_COMPLETION if there is none by then
+PAPI_ERR PAPI papi_poll_completion(PAPI_COMPLETION* completion, PAPI_INT timeout_ms);
+
+/*
+ * Calls into buffers of the caller, with amounts in binary: nothing is
+ * allocated for the caller to release. msg_out_len is set to the length of
+ * the message. If it exceeds msg_out_cap the call returns
+ * APR_BUFFER_TOO_SMALL, its other outputs set, and the player keeps the
+ * message for papi_read_message, which returns what the call would have.
+ * The move is made all the same: a msg_out_cap of 0 makes it and gets the
+ * size of its message. Until papi_read_message takes a kept message, the
+ * player's calls into buffers return APR_MESSAGE_PENDING.
+ */
+PAPI_ERR PAPI papi_init_player_bin(PAPI_PLAYER player, const unsigned char* alice_money, const unsigned char* bob_money,
+                                   const unsigned char* big_blind);
+PAPI_ERR PAPI papi_create_handshake_buf(PAPI_PLAYER player, PAPI_MESSAGE msg_out, PAPI_INT msg_out_cap, PAPI_INT* msg_out_len);
+PAPI_ERR PAPI papi_process_handshake_buf(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len,
+                                         PAPI_MESSAGE msg_out, PAPI_INT msg_out_cap, PAPI_INT* msg_out_len);
+PAPI_ERR PAPI papi_create_bet_buf(PAPI_PLAYER player, PAPI_INT bet_type, const unsigned char* amt,
+                                  PAPI_MESSAGE msg_out, PAPI_INT msg_out_cap, PAPI_INT* msg_out_len);
+PAPI_ERR PAPI papi_process_bet_buf(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len,
+                                   PAPI_MESSAGE msg_out, PAPI_INT msg_out_cap, PAPI_INT* msg_out_len,
+                                   PAPI_INT* type, unsigned char* amt);
+// APR_NO_MESSAGE if the player keeps none
+PAPI_ERR PAPI papi_read_message(PAPI_PLAYER player, PAPI_MESSAGE msg_out, PAPI_INT msg_out_cap, PAPI_INT* msg_out_len);
+PAPI_ERR PAPI papi_get_game_state_bin(PAPI_PLAYER player, PAPI_GAME_STATE* state);
 
 } // extern "C"
 
@@ -39,6 +39,13 @@ static inline INT read_int(char*& p) {
     return res;
 }
 
+// Reads a double, sent as a string, from memory and advances pointer
+static inline double read_double(char*& p) {
+    auto res = atof(p);
+    p += 1+strlen(p);
+    return res;
+}
+
 // helper functions for sending data back to webworker
 
 static inline void worker_respond(char* data, int size, bool final) {
@@ -162,5 +169,35 @@ void API player_game_state(char* msg) {
     worker_respond(json.c_str());
 }
 
+void API player_save(char* msg) {
+    auto player = read_player(msg);
+    std::ostringstream os;
+    auto res = player->save(os);
+    worker_respond(res, false);
+    worker_respond(os.str(), true);
+}
+
+void API player_load(char* msg) {
+    auto player = read_player(msg);
+    auto len = read_int(msg);
+    std::istringstream is(std::string(msg, len));
+    auto res = player->load(is);
+    worker_respond(res);
+}
+
+void API player_equity(char* msg) {
+    auto player = read_player(msg);
+    poker::equity_options opts;
+    opts.max_samples = read_int(msg);
+    opts.precision = read_double(msg);
+    opts.seed = (uint32_t)read_int(msg);
+    poker::equity_result r = {0, 0, 0, 0, false};
+    auto res = player->equity(opts, r);
+    char json[200];
+    sprintf(json, "{\"win\": %.6f, \"tie\": %.6f, \"loss\": %.6f, \"samples\": %lld}", r.win, r.tie, r.loss, r.samples);
+    worker_respond(res, false);
+    worker_respond(std::string(json), true);
+}
+
 } // extern "C"
 
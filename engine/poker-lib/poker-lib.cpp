@@ -1,18 +1,41 @@
 #include "poker-lib.h"
 
 #include <libTMCG.hh>
+#ifdef POKER_THREADS
+#include <mutex>
+#endif
 
+#include "compression.h"
+#include "game-arena.h"
 #include "game-state.h"
+#include "player.h"
 #include "service_locator.h"
+#include "verification-cache.h"
 
 namespace poker {
 
 static poker_lib_options default_options;
+#ifdef POKER_THREADS
+static std::mutex init_lock;
+#endif
 
 int init_poker_lib(poker_lib_options* opts) {
+#ifdef POKER_THREADS
+    std::lock_guard<std::mutex> lock(init_lock);
+#endif
     if (!opts)
         opts = &default_options;
 
+    if (set_compression_options(opts->compression_quality, opts->compression_window, opts->compression_dictionary))
+        return -1;
+    set_compact_frames(opts->compact_frames);
+    set_short_handshake(opts->short_handshake);
+    set_verification_cache(opts->verification_cache);
+    if (opts->game_arenas)
+        use_game_arenas(true);
+    if (set_solver_backend(opts->solver))
+        return -1;
+
     init_libTMCG();
     logging_enabled = opts->logging;
     service_locator::load(opts);
@@ -2,6 +2,7 @@
 #define POKER_LIB_H
 
 #include <cstdlib>
+#include <string>
 
 #include "participant.h"
 #include "solver.h"
@@ -12,18 +13,41 @@
 
 namespace poker {
 
-const int poker_version = 0x010000;
-
 struct poker_lib_options {
-    poker_lib_options() : encryption(true), logging(false), winner(-1) {
+    poker_lib_options() : encryption(true), logging(false), winner(-1), compression_quality(11), compression_window(22),
+        compression_dictionary(0), compact_frames(false), game_arenas(false), solver(get_solver_backend()),
+        short_handshake(false) {
         auto env_logging = getenv("POKER_LOGGING");
         logging = env_logging && 0 == strcmp(env_logging, "1");
+        auto env_compact = getenv("POKER_COMPACT_FRAMES");
+        compact_frames = env_compact && 0 == strcmp(env_compact, "1");
+        auto env_cache = getenv("POKER_VERIFICATION_CACHE");
+        verification_cache = env_cache ? env_cache : "";
+        auto env_arenas = getenv("POKER_GAME_ARENAS");
+        game_arenas = env_arenas && 0 == strcmp(env_arenas, "1");
+        auto env_short = getenv("POKER_SHORT_HANDSHAKE");
+        short_handshake = env_short && 0 == strcmp(env_short, "1");
+        auto env_solver = getenv("POKER_SOLVER");
+        if (env_solver && 0 == strcmp(env_solver, "hand-tables"))
+            solver = SOLVER_HAND_TABLES;
+        else if (env_solver && 0 == strcmp(env_solver, "poker-eval"))
+            solver = SOLVER_POKER_EVAL;
     }
     bool encryption;
     bool logging;
     int winner;
+    int compression_quality;  // brotli quality, 0-11
+    int compression_window;   // brotli window bits, 10-24
+    int compression_dictionary;  // shared dictionary id, 0 = none; older peers only read 0
+    bool compact_frames;         // unpadded message frames, see compression.h
+    std::string verification_cache;  // directory of verified transcripts, see verification-cache.h
+    bool game_arenas;                // per-game allocation of GMP limbs and messages, see game-arena.h
+    solver_backend solver;           // hand evaluator, see solver.h
+    bool short_handshake;            // four message handshake, see set_short_handshake()
 };
 
+// Applies the options to the whole process. Players created afterwards use
+// them unless given options of their own, see player(int, const poker_lib_options&).
 int init_poker_lib(poker_lib_options* opts = NULL);
 
 }  // namespace poker
@@ -71,6 +71,32 @@ class Player {
         });
     }
 
+    async save() {
+        return this.callWorker('player_save', makeMessage(this._p), (results) => {
+            return {
+                res: parseInt(results[0]),
+                snapshot: results[1]
+            };
+        });
+    }
+
+    async load(snapshot) {
+        return this.callWorker('player_load', makeMessage(this._p, snapshot), (results) => {
+            return parseInt(results[0]);
+        });
+    }
+
+    // options: { maxSamples, precision, seed }; single threaded
+    async equity(options = {}) {
+        const { maxSamples = 1000000, precision = 0.001, seed = 1 } = options;
+        return this.callWorker('player_equity', makeMessage(this._p, maxSamples, String(precision), seed), (results) => {
+            return {
+                res: parseInt(results[0]),
+                ...JSON.parse(parseString(results[1]))
+            };
+        });
+    }
+
     registerCallback(fn) {
         const callbackId = ++this.ctr;
         this.cbks[callbackId] = { fn, results:[] };
@@ -2,10 +2,14 @@
 
 #include "validator.h"
 #include "service_locator.h"
+#include "codec.h"
 
 namespace poker {
 
-referee::referee() : _step(game_step::INIT_GAME), _eve(service_locator::instance().new_participant()) {
+referee::referee() : referee(service_locator::instance().new_participant()) {
+}
+
+referee::referee(i_participant* eve) : _step(game_step::INIT_GAME), _eve(eve) {
     _eve->init(1 + NUM_PLAYERS, NUM_PLAYERS, true);
 }
 
@@ -15,7 +19,7 @@ referee::~referee() {
 
 void referee::init_game_state(game_state& g, money_t alice_money, money_t bob_money, money_t big_blind) {
   g.players[ALICE].total_funds = alice_money;
-  g.players[ALICE].bets = big_blind/((money_t)2);
+  g.players[ALICE].bets = big_blind / 2;
   g.players[BOB].total_funds = bob_money;
   g.players[BOB].bets = big_blind;
   g.big_blind = big_blind;
@@ -65,7 +69,7 @@ game_error referee::step_load_keys(blob& alice_key, blob& bob_key, /* out */ blo
     return SUCCESS;
 }
 
-game_error referee::step_vsshe_group(blob& vsshe) {
+game_error referee::step_vsshe_group(blob& vsshe, bool bob_mixes_first) {
     logger << "step_vsshe_group..." << std::endl;
     if (_g.error) return ERR_GAME_OVER;
     if (_step != game_step::VSSHE_GROUP)
@@ -76,33 +80,33 @@ game_error referee::step_vsshe_group(blob& vsshe) {
     if (_eve->create_stack())
         return (_g.error = ERR_CREATE_STACK);
 
-    _step = game_step::ALICE_MIX;
+    _step = bob_mixes_first ? game_step::BOB_FIRST_MIX : game_step::ALICE_MIX;
     return SUCCESS;
 }
 
 game_error referee::step_alice_mix(blob& mix, blob& proof) {
     logger << "step_alice_mix..." << std::endl;
     if (_g.error) return ERR_GAME_OVER;
-    if (_step != game_step::ALICE_MIX)
+    if (_step != game_step::ALICE_MIX && _step != game_step::ALICE_LAST_MIX)
         return (_g.error = ERR_INVALID_MOVE);
 
     if (_eve->load_stack(mix, proof))
         return (_g.error = ERR_ALICE_MIX);
 
-    _step = game_step::BOB_MIX;
+    _step = _step == game_step::ALICE_MIX ? game_step::BOB_MIX : game_step::FINAL_MIX;
     return SUCCESS;
 }
 
 game_error referee::step_bob_mix(blob& mix, blob& proof) {
     logger << "step_bob_mix..." << std::endl;
     if (_g.error) return ERR_GAME_OVER;
-    if (_step != game_step::BOB_MIX)
+    if (_step != game_step::BOB_MIX && _step != game_step::BOB_FIRST_MIX)
         return (_g.error = ERR_INVALID_MOVE);
 
     if (_eve->load_stack(mix, proof))
         return (_g.error = ERR_BOB_MIX);
 
-    _step = game_step::FINAL_MIX;
+    _step = _step == game_step::BOB_MIX ? game_step::FINAL_MIX : game_step::ALICE_LAST_MIX;
     return SUCCESS;
 }
 
@@ -287,7 +291,7 @@ game_error referee::compute_bet(bet_type type, money_t& amt, game_step next_step
     } else {
         auto phs_changed = phs != _g.phase;
         if (phs_changed)
-            _step = next_step;
+            _step = _g.phase == PHS_SHOWDOWN ? game_step::SHOWDOWN : next_step;
     }
     return SUCCESS;
 }
@@ -320,6 +324,39 @@ game_error referee::step_showdown(int player_id, blob& alice_proofs, blob& bob_p
     return SUCCESS;
 }
 
+bool referee::runout_pending() {
+    return _g.version >= runout_version && _step == game_step::SHOWDOWN && _g.public_cards[NUM_PUBLIC_CARDS - 1] == cards::uk;
+}
+
+game_error referee::step_runout(blob& alice_public_proofs, blob& bob_public_proofs,
+                                blob (&alice_private_proofs)[NUM_PLAYERS], blob (&bob_private_proofs)[NUM_PLAYERS]) {
+    logger << "step_runout..." << std::endl;
+    game_error res;
+    if (_g.error) return ERR_GAME_OVER;
+    if (!runout_pending())
+        return (_g.error = ERR_INVALID_MOVE);
+
+    auto first = 0;
+    while (_g.public_cards[first] != cards::uk)
+        first++;
+    if ((res = open_public_cards(alice_public_proofs, bob_public_proofs, public_card_index(first),
+                                 NUM_PUBLIC_CARDS - first)))
+        return res;
+
+    for (auto p = 0; p < NUM_PLAYERS; p++) {
+        if (_g.players[p].cards[0] != cards::uk)
+            continue;
+        if ((res = open_private_cards(p, alice_private_proofs[p], bob_private_proofs[p])))
+            return res;
+    }
+
+    if ((res = decide_winner()))
+        return res;
+
+    _step = game_step::GAME_OVER;
+    return SUCCESS;
+}
+
 game_error referee::open_public_cards(blob& alice_proofs, blob& bob_proofs, int first_card_index, int card_count) {
     logger << "open_public_cards(" << first_card_index << "," << card_count << ") ..." << std::endl;
     alice_proofs.set_auto_rewind(false);
@@ -390,5 +427,24 @@ game_error referee::decide_winner() {
     return poker::decide_winner(_g);
 }
 
+game_error referee::save(std::ostream& out) {
+    game_error res;
+    encoder e(out);
+    if ((res = e.write((int)_step)) || (res = _g.save(e)))
+        return res;
+    return _eve->save(out);
+}
+
+game_error referee::load(std::istream& in) {
+    game_error res;
+    decoder d(in);
+    int step;
+    if ((res = d.read(step)) || (res = _g.load(d)))
+        return res;
+    if (step < INIT_GAME || step > ALICE_LAST_MIX)
+        return PLB_INVALID_CHECKPOINT;
+    _step = (game_step)step;
+    return _eve->load(in);
+}
 
 } // namespace poker
\ No newline at end of file
@@ -16,6 +16,8 @@ class referee {
     game_step   _step;
 public:    
     referee();
+    // takes ownership of eve
+    referee(i_participant* eve);
     virtual ~referee();
 
     game_step step() { return _step; }
@@ -25,7 +27,8 @@ public:
     game_error step_init_game(money_t alice_money, money_t bob_money, money_t big_blind);
     game_error step_vtmf_group(blob& g);
     game_error step_load_keys(blob& bob_key, blob& alice_key, /* out */ blob& eve_key);
-    game_error step_vsshe_group(blob& vsshe);
+    // in the short handshake bob mixes the stack first, then alice
+    game_error step_vsshe_group(blob& vsshe, bool bob_mixes_first = false);
     game_error step_alice_mix(blob& mix, blob& proof);
     game_error step_bob_mix(blob& mix, blob& proof);
     game_error step_final_mix(blob& mix, blob& proof);
@@ -40,6 +43,14 @@ public:
     game_error step_river_bet(int player_id, bet_type type, money_t amt);
     game_error step_showdown(int player_id, blob& alice_proofs, blob& bob_proofs, bool muck);
 
+    // From runout_version on, a bet leaving a player all in ends the betting
+    // before the river. The public cards still closed and the private cards
+    // are then opened in a single step: x_private_proofs[p] holds x's proofs
+    // of p's cards, only needed for cards not opened yet.
+    bool runout_pending();
+    game_error step_runout(blob& alice_public_proofs, blob& bob_public_proofs,
+                           blob (&alice_private_proofs)[NUM_PLAYERS], blob (&bob_private_proofs)[NUM_PLAYERS]);
+
     game_error bet(int player_id, bet_type type, money_t amt);
     
     game_error open_public_cards(game_step step, blob& alice_proof, blob bob_proof);
@@ -47,6 +58,10 @@ public:
 
     static void init_game_state(game_state& g, money_t alice_money, money_t bob_money, money_t big_blind);
 
+    // Checkpoint of the game, step and participant state
+    game_error save(std::ostream& out);
+    game_error load(std::istream& in);
+
   private:
     game_error compute_bet(bet_type type, money_t& amt, game_step next_step);
     game_error open_public_cards(blob& alice_proofs, blob& bob_proofs, int first_card_index, int card_count);
@@ -1,6 +1,10 @@
 #ifndef SERVICE_LOCATOR_H
 #define SERVICE_LOCATOR_H
 
+#ifdef POKER_THREADS
+#include <mutex>
+#endif
+
 #include "participant.h"
 #include "poker-lib.h"
 #include "unencrypted_participant.h"
@@ -9,6 +13,9 @@ namespace poker {
 
 class service_locator {
     poker_lib_options _opts;
+#ifdef POKER_THREADS
+    std::mutex _lock;  // options may be loaded again while players are created
+#endif
     service_locator() {}
 
    public:
@@ -21,14 +28,33 @@ class service_locator {
     }
 
     static void load(poker_lib_options* opts) {
-        instance()._opts = *opts;
+        auto& i = instance();
+#ifdef POKER_THREADS
+        std::lock_guard<std::mutex> lock(i._lock);
+#endif
+        i._opts = *opts;
     }
 
+    // as configured by init_poker_lib()
     i_participant* new_participant() {
-        if (_opts.encryption) {
+        bool encryption;
+        int winner;
+        {
+#ifdef POKER_THREADS
+            std::lock_guard<std::mutex> lock(_lock);
+#endif
+            encryption = _opts.encryption;
+            winner = _opts.winner;
+        }
+        return new_participant(encryption, winner);
+    }
+
+    // for a player configured apart from the library, see player(int, const poker_lib_options&)
+    static i_participant* new_participant(bool encryption, int winner) {
+        if (encryption) {
             return new participant();
         } else {
-            return new unencrypted_participant(_opts.winner);
+            return new unencrypted_participant(winner);
         }
     }
 };
@@ -1,42 +1,67 @@
 #include <iostream>
+#ifndef POKER_NO_POKER_EVAL
 #include <poker_defs.h>
 #include <inlines/eval.h>
 #include <inlines/eval_type.h>
+#endif
+#include <atomic>
 #include <cstdint>
 
 #include "solver.h"
+#include "hand-evaluator.h"
 
 namespace poker {
 
+#ifdef POKER_NO_POKER_EVAL
+    static std::atomic<solver_backend> backend(SOLVER_HAND_TABLES);
+#else
+    static std::atomic<solver_backend> backend(SOLVER_POKER_EVAL);
+#endif
+
+    static const char* hand_names[hand_categories] = {
+        "NoPair", "OnePair", "TwoPair", "Trips", "Straight", "Flush", "FlHouse", "Quads", "StFlush"
+    };
+
+    static const int deck_size = 52;
+
+    game_error set_solver_backend(solver_backend b) {
+#ifdef POKER_NO_POKER_EVAL
+        if (b == SOLVER_POKER_EVAL)
+            return SRR_BACKEND_UNAVAILABLE;
+#endif
+        backend = b;
+        return SUCCESS;
+    }
+
+    solver_backend get_solver_backend() {
+        return backend;
+    }
+
     solver::solver() {}
 
     solver::~solver(){}
 
-    game_error convert_hand_to_mask(const card_t *hand, int hand_size, CardMask& mask) {
-        CardMask_RESET(mask);
+    game_error check_hand(const card_t *hand, int hand_size) {
+        uint64_t seen = 0;
 
         for (auto i=0; i < hand_size; i++) {
             card_t card = hand[i];
 
-            if (card >= Deck_N_CARDS) {
-                printf("*** [convert_hand_to_mask] Error: unrecognized card \"%d\" was found.\n", card);
+            if (card < 0 || card >= deck_size) {
+                printf("*** [check_hand] Error: unrecognized card \"%d\" was found.\n", card);
                 return SRR_UNKNOWN_CARD;
             }
 
-            if (!CardMask_CARD_IS_SET(mask, card)) {
-                CardMask_SET(mask, card);
-            } else {
-                printf("*** [convert_hand_to_mask] Error: found duplicated card on hand\n");
+            if (seen & (1ULL << card)) {
+                printf("*** [check_hand] Error: found duplicated card on hand\n");
                 return SRR_DUPLICATE_CARD;
             }
+            seen |= 1ULL << card;
         }
         return SUCCESS;
     }
 
-    int eval(const CardMask& hand1, const CardMask& hand2, int hand_size) {
-        int value1 = StdDeck_StdRules_EVAL_N(hand1, hand_size);
-        int value2 = StdDeck_StdRules_EVAL_N(hand2, hand_size);
-
+    static int compare_ratings(int value1, int value2) {
         if (value1 > value2) {
             return 1;
         } else if (value1 < value2) {
@@ -46,28 +71,64 @@ namespace poker {
         }
     }
 
+#ifndef POKER_NO_POKER_EVAL
+    void convert_hand_to_mask(const card_t *hand, int hand_size, CardMask& mask) {
+        CardMask_RESET(mask);
+
+        for (auto i=0; i < hand_size; i++)
+            CardMask_SET(mask, hand[i]);
+    }
+
+    int eval(const CardMask& hand1, const CardMask& hand2, int hand_size) {
+        int value1 = StdDeck_StdRules_EVAL_N(hand1, hand_size);
+        int value2 = StdDeck_StdRules_EVAL_N(hand2, hand_size);
+        return compare_ratings(value1, value2);
+    }
+#endif
+
     game_error solver::compare_hands(const card_t *hand1, const card_t *hand2, int hand_size, int* result) {
-        CardMask hand1_mask, hand2_mask;
         game_error res;
 
-        if ((res = convert_hand_to_mask(hand1, hand_size, hand1_mask)))
+        if ((res = check_hand(hand1, hand_size)))
             return res;
 
-        if ((res = convert_hand_to_mask(hand2, hand_size, hand2_mask)))
+        if ((res = check_hand(hand2, hand_size)))
             return res;
-        
+
+        if (backend == SOLVER_HAND_TABLES) {
+            int value1 = evaluate_hand(hand1, hand_size);
+            int value2 = evaluate_hand(hand2, hand_size);
+            if (!value1 || !value2)
+                return SRR_UNSUPPORTED_HAND_SIZE;
+            *result = compare_ratings(value1, value2);
+            return SUCCESS;
+        }
+
+#ifndef POKER_NO_POKER_EVAL
+        CardMask hand1_mask, hand2_mask;
+        convert_hand_to_mask(hand1, hand_size, hand1_mask);
+        convert_hand_to_mask(hand2, hand_size, hand2_mask);
         *result = eval(hand1_mask, hand2_mask, hand_size);
+#endif
         return SUCCESS;
     }
 
     const char* solver::get_hand_name(const card_t *hand, int hand_size) {
-        CardMask mask;
-
-        if (convert_hand_to_mask(hand, hand_size, mask) == SUCCESS) {
-            int type = StdDeck_StdRules_EVAL_TYPE(mask, hand_size);
-            return handTypeNames[type];
-        } else {
+        if (check_hand(hand, hand_size) != SUCCESS)
             return 0;
+
+        if (backend == SOLVER_HAND_TABLES) {
+            int value = evaluate_hand(hand, hand_size);
+            return value ? hand_names[get_hand_category(value)] : 0;
         }
+
+#ifndef POKER_NO_POKER_EVAL
+        CardMask mask;
+        convert_hand_to_mask(hand, hand_size, mask);
+        int type = StdDeck_StdRules_EVAL_TYPE(mask, hand_size);
+        return handTypeNames[type];
+#else
+        return 0;
+#endif
     }
 } // namespace poker
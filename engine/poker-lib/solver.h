@@ -6,6 +6,14 @@
 
 namespace poker {
 
+/*
+* Hand evaluators the solver can use
+*/
+enum solver_backend {
+    SOLVER_POKER_EVAL,   // the poker-eval library
+    SOLVER_HAND_TABLES,  // built-in perfect hash tables, hands of 5 to 7 cards; see hand-evaluator.h
+};
+
 /*
 * Poker hand evaluator
 */
@@ -17,6 +25,10 @@ public:
 	const char* get_hand_name(const card_t *hand, int hand_size);
 };
 
+// Backend of all solvers. Without poker-eval (POKER_NO_POKER_EVAL) only the hand tables are available
+game_error set_solver_backend(solver_backend backend);
+solver_backend get_solver_backend();
+
 } // namespace poker
 
 #endif // SOLVER_H
@@ -0,0 +1,99 @@
+#ifndef STREAMS_H
+#define STREAMS_H
+
+#include <algorithm>
+#include <istream>
+#include <streambuf>
+
+namespace poker {
+
+/*
+ * Read-only stream buffer over memory owned by someone else (e.g. a mapped
+ * file). Reads are served straight from that memory.
+ */
+class memory_streambuf : public std::streambuf {
+public:
+    memory_streambuf(const char* data, size_t size) {
+        auto p = const_cast<char*>(data);
+        setg(p, p, p + size);
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        char* base = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+        if (off < eback() - base || off > egptr() - base)
+            return pos_type(off_type(-1));
+        setg(eback(), base + off, egptr());
+        return pos_type(gptr() - eback());
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+/*
+ * Exposes the next 'limit' bytes of another stream buffer, without buffering
+ * them again. Positions (tellg) are relative to where it started.
+ */
+class bounded_streambuf : public std::streambuf {
+    std::streambuf* _src;
+    std::streamsize _remaining;
+    std::streamsize _consumed;
+    bool _truncated;  // source ended before the limit
+
+public:
+    bounded_streambuf(std::streambuf* src, std::streamsize limit)
+        : _src(src), _remaining(limit), _consumed(0), _truncated(false) { }
+
+    // consumes what is left, returns false if the source was shorter than the limit
+    bool drain() {
+        char tmp[4096];
+        while (_remaining && !_truncated)
+            xsgetn(tmp, std::min<std::streamsize>(_remaining, sizeof(tmp)));
+        return !_truncated;
+    }
+
+protected:
+    int_type underflow() override {
+        if (!_remaining)
+            return traits_type::eof();
+        auto c = _src->sgetc();
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+            _truncated = true;
+        return c;
+    }
+
+    int_type uflow() override {
+        if (!_remaining)
+            return traits_type::eof();
+        auto c = _src->sbumpc();
+        if (traits_type::eq_int_type(c, traits_type::eof())) {
+            _truncated = true;
+            return c;
+        }
+        _remaining--;
+        _consumed++;
+        return c;
+    }
+
+    std::streamsize xsgetn(char* s, std::streamsize n) override {
+        n = std::min(n, _remaining);
+        auto got = _src->sgetn(s, n);
+        if (got < n)
+            _truncated = true;
+        _remaining -= got;
+        _consumed += got;
+        return got;
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        if (off != 0 || dir != std::ios_base::cur)
+            return pos_type(off_type(-1));
+        return pos_type(_consumed);
+    }
+};
+
+}  // namespace poker
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef STRUCTURAL_PARTICIPANT_H
+#define STRUCTURAL_PARTICIPANT_H
+
+#include "i_participant.h"
+
+namespace poker {
+
+/*
+ * Stand-in for the referee's participant that accepts every group, key,
+ * shuffle and card proof without checking it. Playing a game back with it
+ * follows the betting and the game steps only; opened cards are
+ * placeholders (card i is card type i).
+ */
+class structural_participant : public i_participant {
+    int _id;
+    int _num_participants;
+    bool _predictable;
+
+   public:
+    structural_participant() : _id(-1), _num_participants(0), _predictable(false) {}
+
+    void init(int id, int num_participants, bool predictable) override {
+        _id = id;
+        _num_participants = num_participants;
+        _predictable = predictable;
+    }
+    int id() override { return _id; }
+    int num_participants() override { return _num_participants; }
+    bool predictable() override { return _predictable; }
+
+    game_error create_group(blob& group) override { return SUCCESS; }
+    game_error load_group(blob& group) override { return SUCCESS; }
+
+    game_error generate_key(blob& key) override { return SUCCESS; }
+    game_error load_their_key(blob& key) override { return SUCCESS; }
+    game_error finalize_key_generation() override { return SUCCESS; }
+
+    game_error create_vsshe_group(blob& group) override { return SUCCESS; }
+    game_error load_vsshe_group(blob& group) override { return SUCCESS; }
+
+    game_error create_stack() override { return SUCCESS; }
+    game_error shuffle_stack(blob& mixed_stack, blob& stack_proof) override { return SUCCESS; }
+    game_error load_stack(blob& mixed_stack, blob& mixed_stack_proof) override { return SUCCESS; }
+
+    game_error take_cards_from_stack(int count) override { return SUCCESS; }
+    game_error prove_card_secret(int card_index, blob& my_proof) override { return SUCCESS; }
+    game_error self_card_secret(int card_index) override { return SUCCESS; }
+    game_error verify_card_secret(int card_index, blob& their_proof) override { return SUCCESS; }
+    game_error open_card(int card_index) override { return SUCCESS; }
+    size_t get_open_card(int card_index) override { return card_index; }
+
+    game_error save(std::ostream& out) override { return SUCCESS; }
+    game_error load(std::istream& in) override { return SUCCESS; }
+};
+
+}  // namespace poker
+
+#endif
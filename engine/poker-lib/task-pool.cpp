@@ -0,0 +1,121 @@
+#include "task-pool.h"
+
+#include <cstddef>
+
+#ifdef POKER_THREADS
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#endif
+
+namespace poker {
+
+#ifdef POKER_THREADS
+
+struct task_pool::impl {
+    struct entry {
+        int id;
+        const void* owner;
+        task run;
+    };
+
+    std::deque<entry> queued;
+    std::set<const void*> busy;  // owners with a task running
+    std::mutex lock;
+    std::condition_variable changed;
+    bool stop;
+    std::vector<std::thread> workers;
+
+    // the oldest task whose owner is idle
+    std::deque<entry>::iterator runnable() {
+        for (auto it = queued.begin(); it != queued.end(); it++)
+            if (!busy.count(it->owner))
+                return it;
+        return queued.end();
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> l(lock);
+        for (;;) {
+            auto next = queued.end();
+            changed.wait(l, [&]() { return stop || (next = runnable()) != queued.end(); });
+            if (stop)
+                return;
+            entry e = std::move(*next);
+            queued.erase(next);
+            busy.insert(e.owner);
+            l.unlock();
+            e.run();
+            e.run = NULL;
+            l.lock();
+            busy.erase(e.owner);
+            // a task of the same owner may have been waiting
+            changed.notify_all();
+        }
+    }
+};
+
+task_pool::task_pool(int threads) : _impl(new impl) {
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+    _impl->stop = false;
+    for (int i = 0; i < threads; i++)
+        _impl->workers.emplace_back(&impl::work, _impl);
+}
+
+task_pool::~task_pool() {
+    {
+        std::lock_guard<std::mutex> l(_impl->lock);
+        _impl->stop = true;
+        _impl->queued.clear();
+    }
+    _impl->changed.notify_all();
+    for (auto& w : _impl->workers)
+        w.join();
+    delete _impl;
+}
+
+void task_pool::queue(int id, const void* owner, task run) {
+    {
+        std::lock_guard<std::mutex> l(_impl->lock);
+        _impl->queued.push_back(impl::entry{id, owner, std::move(run)});
+    }
+    _impl->changed.notify_all();
+}
+
+bool task_pool::cancel(int id) {
+    std::lock_guard<std::mutex> l(_impl->lock);
+    for (auto it = _impl->queued.begin(); it != _impl->queued.end(); it++)
+        if (it->id == id) {
+            _impl->queued.erase(it);
+            return true;
+        }
+    return false;
+}
+
+#else
+
+struct task_pool::impl {};
+
+task_pool::task_pool(int threads) : _impl(NULL) {
+}
+
+task_pool::~task_pool() {
+}
+
+void task_pool::queue(int id, const void* owner, task run) {
+    run();
+}
+
+bool task_pool::cancel(int id) {
+    return false;
+}
+
+#endif
+
+}  // namespace poker
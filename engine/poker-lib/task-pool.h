@@ -0,0 +1,38 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <functional>
+
+namespace poker {
+
+/*
+ * Worker threads for long computations, such as shuffles and proofs.
+ * Tasks of the same owner, e.g. a player, run one at a time in the order
+ * they were queued; tasks of different owners run in parallel. A task may
+ * be cancelled until a worker picks it up.
+ * Without POKER_THREADS there are no workers: queue() runs the task before
+ * returning.
+ */
+class task_pool {
+    struct impl;
+    impl* _impl;
+
+public:
+    typedef std::function<void()> task;
+
+    // threads 0 for one per hardware thread
+    explicit task_pool(int threads = 0);
+    // waits for the running tasks; the queued ones are dropped
+    ~task_pool();
+    task_pool(const task_pool&) = delete;
+    task_pool& operator=(const task_pool&) = delete;
+
+    // id is the caller's, to cancel the task with
+    void queue(int id, const void* owner, task run);
+    // true if the task was dropped before it started
+    bool cancel(int id);
+};
+
+}  // namespace poker
+
+#endif  // TASK_POOL_H
@@ -2,6 +2,7 @@
 #include <sstream>
 #include <memory.h>
 #include <inttypes.h>
+#include <cstdlib>
 #include "poker-lib.h"
 #include "common.h"
 #include "test-util.h"
@@ -69,9 +70,60 @@ void the_happy_path() {
     assert_eql(true, std::string("\x01\x02\x03") == ss.str());
 }
 
+// byte at a time, as the conversions used to be done
+static void reference_load(mpz_t n, const unsigned char* data, int len) {
+    mpz_set_ui(n, 0);
+    for(int i=0; i<len; i++) {
+        mpz_mul_ui(n, n, 256);
+        mpz_add_ui(n, n, data[i]);
+    }
+}
+
+static void reference_store(mpz_t n, unsigned char* data, int len) {
+    mpz_t t;
+    mpz_init_set(t, n);
+    for(int i=len-1; i>=0; i--) {
+        data[i] = (unsigned char)mpz_fdiv_ui(t, 256);
+        mpz_fdiv_q_ui(t, t, 256);
+    }
+    mpz_clear(t);
+}
+
+void test_binary_conversions() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - test_binary_conversions" << std::endl;
+
+    srand(1);
+    mpz_t ref;
+    mpz_init(ref);
+    for(int len=0; len<=40; len++) {
+        for(int k=0; k<16; k++) {
+            unsigned char data[40];
+            for(int i=0; i<len; i++)
+                data[i] = k == 0 ? 0 : k == 1 ? 0xff : rand();
+            bignumber x;
+            x.load_binary_be((char*)data, len);
+            reference_load(ref, data, len);
+            char hex[100];
+            assert_eql(std::string(mpz_get_str(hex, 16, ref)), x.to_string(16));
+
+            // narrower, equal and wider fields
+            for(int out_len=0; out_len<=36; out_len+=4) {
+                unsigned char expected[40], actual[40];
+                memset(actual, 0xaa, sizeof(actual));
+                reference_store(ref, expected, out_len);
+                x.store_binary_be((char*)actual, out_len);
+                assert_eql(0, memcmp(expected, actual, out_len));
+                assert_eql(0xaa, (int)actual[out_len]);
+            }
+        }
+    }
+    mpz_clear(ref);
+}
+
 int main(int argc, char** argv) {
     init_poker_lib();
     the_happy_path();
+    test_binary_conversions();
     std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
     return 0;
 }
@@ -6,11 +6,21 @@
 #include "compression.h"
 #include "common.h"
 #include "test-util.h"
+#include "streams.h"
 
 #define TEST_SUITE_NAME "Test compress"
 
 using namespace poker;
 
+// a stream that can't tell its position, like a pipe
+class unseekable_streambuf : public std::streambuf {
+    std::string _data;
+public:
+    unseekable_streambuf(const std::string& data) : _data(data) {
+        setg(&_data[0], &_data[0], &_data[0] + _data.size());
+    }
+};
+
 void test_the_naive_happy_path() {
     std::vector<std::string> test_cases{
         "1",
@@ -55,9 +65,190 @@ void test_the_naive_happy_path() {
     std::cout <<  "---- " TEST_SUITE_NAME << " - the_happy_path" << std::endl;
 }
 
+void test_dictionaries() {
+    std::string msg = "#5|#65536|#0|#4|%1|0$0|";
+    std::string compressed, wrapped, out;
+
+    // frames carry the dictionary id, plain frames read as NO_DICTIONARY
+    int dictionary = -1;
+    assert_eql(SUCCESS, compress(msg, compressed));
+    assert_eql(SUCCESS, unwrap(wrap(compressed), out, dictionary));
+    assert_eql(NO_DICTIONARY, dictionary);
+    assert_eql(compressed, out);
+    assert_eql(SUCCESS, unwrap(wrap(compressed, 7), out, dictionary));
+    assert_eql(7, dictionary);
+    assert_eql(compressed, out);
+
+    // unknown ids are rejected
+    assert_eql(CPR_UNKNOWN_DICTIONARY, unwrap_and_decompress(wrap(compressed, 7), out));
+
+    // messages compressed with a dictionary decode and are smaller; without
+    // brotli dictionaries the option falls back to NO_DICTIONARY
+    assert_eql(SUCCESS, set_compression_options(11, 22, LATEST_DICTIONARY));
+    if (default_compression_dictionary() != NO_DICTIONARY) {
+        std::string with_dictionary;
+        assert_eql(SUCCESS, compress(msg, with_dictionary, default_compression_dictionary()));
+        assert_eql(true, with_dictionary.size() < compressed.size());
+        assert_eql(SUCCESS, decompress(with_dictionary, out, default_compression_dictionary()));
+        assert_eql(msg, out);
+        assert_eql(SUCCESS, compress_and_wrap(msg, wrapped));
+        assert_eql(SUCCESS, unwrap_and_decompress(wrapped, out));
+        assert_eql(msg, out);
+    }
+    assert_eql(SUCCESS, set_compression_options(11, 22, NO_DICTIONARY));
+
+    std::cout <<  "---- " TEST_SUITE_NAME << " - dictionaries" << std::endl;
+}
+
+void test_compact_frames() {
+    std::string s1 = "#5|#65536|#0|#4|%1|0$0|";
+    std::string s2 = std::string(5000, '2');
+    std::string s3 = std::string(30, '3');
+    std::string m1, m2, m3, out;
+
+    set_compact_frames(true);
+    assert_eql(SUCCESS, compress_and_wrap(s1, m1));
+    assert_eql(SUCCESS, compress_and_wrap(s2, m2));
+    set_compact_frames(false);
+    assert_eql(SUCCESS, compress_and_wrap(s3, m3));
+
+    assert_eql(compact_frame_magic, (unsigned char)m1[0]);
+    assert_eql(true, m1.size() < 64);
+    assert_eql(SUCCESS, unwrap_and_decompress(m1, out));
+    assert_eql(s1, out);
+    assert_eql(CPR_INSUFFICIENT_DATA, unwrap(m1.substr(0, m1.size() - 1), out));
+
+    // tightly packed frames
+    std::istringstream packed(m1 + m2 + m1);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(packed, out));
+    assert_eql(s1, out);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(packed, out));
+    assert_eql(s2, out);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(packed, out));
+    assert_eql(s1, out);
+    assert_eql(END_OF_STREAM, unwrap_and_decompress_next(packed, out));
+
+    // drive layout: page-aligned turns, mixing both layouts
+    std::string drive = m1;
+    pad_to_page(drive);
+    assert_eql(wrap_padding_size, drive.size());
+    drive += m3 + m2;
+    pad_to_page(drive);
+    drive += std::string(2 * wrap_padding_size, '\0');
+    std::istringstream is(drive);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(is, out));
+    assert_eql(s1, out);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(is, out));
+    assert_eql(s3, out);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(is, out));
+    assert_eql(s2, out);
+
+    std::cout <<  "---- " TEST_SUITE_NAME << " - compact frames" << std::endl;
+}
+
+void test_batch_frames() {
+    std::vector<std::string> batch{ "#5|#65536|#1|#1|#0|", "", "#6|#65536|#1|$2|%ab|" };
+    std::vector<std::string> out;
+    std::string frame, single, msg;
+
+    assert_eql(SUCCESS, compress_and_wrap_batch(batch, frame));
+    assert_eql(compact_batch_magic, (unsigned char)frame[0]);
+    assert_eql(SUCCESS, unwrap_and_decompress_batch(frame, out));
+    assert_eql(3, out.size());
+    for (size_t i = 0; i < batch.size(); i++)
+        assert_eql(batch[i], out[i]);
+    assert_eql(CPR_UNEXPECTED_BATCH, unwrap_and_decompress(frame, msg));
+
+    // single-message frames read as batches of one
+    assert_eql(SUCCESS, compress_and_wrap(batch[0], single));
+    assert_eql(SUCCESS, unwrap_and_decompress_batch(single, out));
+    assert_eql(1, out.size());
+    assert_eql(batch[0], out[0]);
+
+    // frames sent in a row, batches or not, merge into one batch
+    std::string merged;
+    assert_eql(SUCCESS, batch_frames({ frame, single }, merged));
+    assert_eql(SUCCESS, unwrap_and_decompress_batch(merged, out));
+    assert_eql(4, out.size());
+    assert_eql(batch[2], out[2]);
+    assert_eql(batch[0], out[3]);
+    assert_eql(CPR_INVALID_DATA_LENGTH, batch_frames({}, merged));
+
+    std::string drive = frame;
+    pad_to_page(drive);
+    drive += single;
+    std::istringstream is(drive);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(is, out));
+    assert_eql(3, out.size());
+    assert_eql(batch[2], out[2]);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(is, out));
+    assert_eql(1, out.size());
+    assert_eql(batch[0], out[0]);
+    assert_eql(END_OF_STREAM, unwrap_and_decompress_next(is, out));
+
+    std::cout <<  "---- " TEST_SUITE_NAME << " - batch frames" << std::endl;
+}
+
+void test_streamed_frames() {
+    std::string s1 = std::string(30, '1');
+    std::string s2 = std::string(6000, '2');
+    std::string m1, m2, out;
+    set_compact_frames(true);
+    assert_eql(SUCCESS, compress_and_wrap(s1, m1));
+    set_compact_frames(false);
+    assert_eql(SUCCESS, compress_and_wrap(s2, m2));
+
+    std::string drive = m1;
+    pad_to_page(drive);
+    drive += m2;
+    drive += std::string(wrap_padding_size, '\0');
+
+    // frames read in place from memory
+    memory_streambuf mem(drive.data(), drive.size());
+    std::istream is(&mem);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(is, out));
+    assert_eql(s1, out);
+    assert_eql(wrap_padding_size, (int)is.tellg());
+    assert_eql(SUCCESS, unwrap_and_decompress_next(is, out));
+    assert_eql(s2, out);
+
+    // bounded view over the turns, the trailing page is not part of it
+    std::istringstream src(drive);
+    bounded_streambuf turns(src.rdbuf(), wrap_padding_size + m2.size());
+    std::istream bis(&turns);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(bis, out));
+    assert_eql(s1, out);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(bis, out));
+    assert_eql(s2, out);
+    assert_eql(END_OF_STREAM, unwrap_and_decompress_next(bis, out));
+    assert_eql(true, turns.drain());
+
+    // a source shorter than announced is reported
+    std::istringstream short_src(m1);
+    bounded_streambuf truncated(short_src.rdbuf(), wrap_padding_size);
+    assert_eql(false, truncated.drain());
+
+    // without a position, a padded frame right after a compact one keeps
+    // its header
+    unseekable_streambuf pipe(m1 + m2);
+    std::istream pis(&pipe);
+    assert_eql(-1, (int)pis.tellg());
+    assert_eql(SUCCESS, unwrap_and_decompress_next(pis, out));
+    assert_eql(s1, out);
+    assert_eql(SUCCESS, unwrap_and_decompress_next(pis, out));
+    assert_eql(s2, out);
+    assert_eql(END_OF_STREAM, unwrap_and_decompress_next(pis, out));
+
+    std::cout <<  "---- " TEST_SUITE_NAME << " - streamed frames" << std::endl;
+}
+
 int main(int argc, char** argv) {
     init_poker_lib();
     test_the_naive_happy_path();
+    test_dictionaries();
+    test_compact_frames();
+    test_batch_frames();
+    test_streamed_frames();
     std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
     return 0;
 }
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "hand-driver.h"
+#include "poker-lib.h"
+#include "player.h"
+#include "test-util.h"
+
+#define TEST_SUITE_NAME "Test concurrent tables"
+
+using namespace poker;
+
+/*
+ * Hundreds of tables, each a pair of players of its own configuration,
+ * played on every core at once. A table must end as it does when played
+ * alone, whatever the library options and the tables around it.
+ */
+
+static const int num_tables = 256;
+static const int encrypted_every = 32;
+
+struct table {
+    poker_lib_options opts;
+    game_error error;
+    bool agree;  // both players see the same end of the game
+    int messages;
+    int winner;
+    card_t cards[NUM_CARDS];  // as seen by alice
+};
+
+// the hand of hand-driver.h, on players of the table's options
+static void play(table& t) {
+    player alice(ALICE, t.opts), bob(BOB, t.opts);
+    t.messages = 0;
+    t.agree = false;
+    if ((t.error = alice.init(100, 300, 10)) || (t.error = bob.init(100, 300, 10)) ||
+        (t.error = play_all_in(alice, bob, &t.messages)))
+        return;
+
+    t.agree = alice.step() == GAME_OVER && bob.step() == GAME_OVER && alice.winner() == bob.winner();
+    for (int i = 0; i < NUM_PRIVATE_CARDS; i++) {
+        t.cards[private_card_index(ALICE, i)] = alice.private_card(i);
+        t.cards[private_card_index(BOB, i)] = alice.opponent_card(i);
+        t.agree = t.agree && bob.private_card(i) == alice.opponent_card(i) && alice.private_card(i) == bob.opponent_card(i);
+    }
+    for (int i = 0; i < NUM_PUBLIC_CARDS; i++) {
+        t.cards[public_card_index(i)] = alice.public_card(i);
+        t.agree = t.agree && alice.public_card(i) == bob.public_card(i);
+    }
+    t.winner = alice.winner();
+}
+
+static std::vector<table> make_tables() {
+    std::vector<table> tables(num_tables);
+    for (int i = 0; i < num_tables; i++) {
+        auto& o = tables[i].opts;
+        o.encryption = i % encrypted_every == 0;
+        o.winner = i % 2 ? BOB : ALICE;
+        o.short_handshake = (i / 2) % 2;
+    }
+    return tables;
+}
+
+static void play_all(std::vector<table>& tables, int threads) {
+    std::atomic<int> next(0);
+    auto work = [&]() {
+        for (int i; (i = next++) < (int)tables.size();)
+            play(tables[i]);
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; i++)
+        pool.emplace_back(work);
+    for (auto& t : pool)
+        t.join();
+}
+
+void test_isolation() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - test_isolation" << std::endl;
+
+    // library options the tables must not pick up
+    poker_lib_options lib_opts;
+    lib_opts.encryption = false;
+    lib_opts.winner = TIE;
+    lib_opts.short_handshake = true;
+    assert_eql(0, init_poker_lib(&lib_opts));
+
+    int threads = std::max(2, (int)std::thread::hardware_concurrency());
+    auto alone = make_tables();
+    play_all(alone, 1);
+    auto together = make_tables();
+    play_all(together, threads);
+
+    for (int i = 0; i < num_tables; i++) {
+        auto& one = alone[i];
+        auto& all = together[i];
+        assert_eql(SUCCESS, one.error);
+        assert_eql(SUCCESS, all.error);
+        assert_eql(true, all.agree);
+        assert_eql(all.opts.short_handshake ? 7 : 8, all.messages);
+        if (all.opts.encryption)
+            continue;
+        // the unencrypted deal only depends on the table's own winner
+        assert_eql(all.opts.winner, all.winner);
+        for (int c = 0; c < NUM_CARDS; c++)
+            assert_eql(one.cards[c], all.cards[c]);
+    }
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    test_isolation();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
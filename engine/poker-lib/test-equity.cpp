@@ -0,0 +1,169 @@
+#include <iostream>
+#include <cmath>
+#include "poker-lib.h"
+#include "common.h"
+#include "test-util.h"
+#include "equity.h"
+#include "hand-evaluator.h"
+
+#define TEST_SUITE_NAME "Test equity"
+
+using namespace poker;
+using namespace poker::cards;
+
+static equity_result equity(std::vector<card_t> hand, std::vector<card_t> opponent, std::vector<card_t> board,
+                            const equity_options& opts = equity_options()) {
+    equity_result r;
+    assert_eql(SUCCESS, compute_equity(hand.data(), opponent.data(), board.data(), board.size(), opts, r));
+    assert_eql(true, std::fabs(r.win + r.tie + r.loss - 1) < 1e-9);
+    return r;
+}
+
+void test_exhaustive() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - test_exhaustive" << std::endl;
+
+    auto r = equity({hA, sA}, {dK, cK}, {c2, d7, h9, cJ, s3});
+    assert_eql(true, r.exact);
+    assert_eql(1, r.samples);
+    assert_eql(1.0, r.win);
+
+    r = equity({h2, h3}, {d4, d5}, {cT, dJ, hQ, sK, cA});
+    assert_eql(1.0, r.tie);
+
+    // every opponent hand on the river, every river and opponent hand on the turn
+    r = equity({hA, sA}, {uk, uk}, {c2, d7, h9, cJ, s3});
+    assert_eql(true, r.exact);
+    assert_eql(990, r.samples);
+    r = equity({hA, sA}, {uk, uk}, {c2, d7, h9, cJ});
+    assert_eql(true, r.exact);
+    assert_eql(45540, r.samples);
+    // a set of aces
+    r = equity({hA, sA}, {uk, uk}, {cA, d7, h2, cJ});
+    assert_eql(true, r.win > 0.9);
+
+    // few outcomes are enumerated before the turn too
+    r = equity({hA, sA}, {dK, cK}, {c2, d7, h9});
+    assert_eql(true, r.exact);
+    assert_eql(990, r.samples);
+    assert_eql(83.0 / 990, r.loss);  // a king without an ace
+}
+
+// exact preflop equity, the slow way
+static equity_result reference(card_t h1, card_t h2, card_t o1, card_t o2) {
+    long long win = 0, tie = 0, loss = 0;
+    std::vector<card_t> deck;
+    for (card_t c = 0; c < 52; c++)
+        if (c != h1 && c != h2 && c != o1 && c != o2)
+            deck.push_back(c);
+    int n = deck.size();
+    for (int a = 0; a < n; a++)
+    for (int b = a + 1; b < n; b++)
+    for (int c = b + 1; c < n; c++)
+    for (int d = c + 1; d < n; d++)
+    for (int e = d + 1; e < n; e++) {
+        card_t hand[] = {h1, h2, deck[a], deck[b], deck[c], deck[d], deck[e]};
+        card_t opponent[] = {o1, o2, deck[a], deck[b], deck[c], deck[d], deck[e]};
+        int diff = evaluate_hand(hand, 7) - evaluate_hand(opponent, 7);
+        (diff > 0 ? win : diff < 0 ? loss : tie)++;
+    }
+    double total = win + tie + loss;
+    return equity_result{win / total, tie / total, loss / total, (long long)total, true};
+}
+
+void test_monte_carlo() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - test_monte_carlo" << std::endl;
+
+    equity_options opts;
+    opts.max_samples = 200000;
+    opts.precision = 0;
+    auto r = equity({hA, sA}, {dK, cK}, {}, opts);
+    assert_eql(false, r.exact);
+    assert_eql(200000, r.samples);
+    auto exact = reference(hA, sA, dK, cK);
+    double error = std::sqrt(exact.win * (1 - exact.win) / r.samples);
+    assert_eql(true, std::fabs(r.win - exact.win) < 5 * error);
+    assert_eql(true, std::fabs(r.tie - exact.tie) < 0.002);
+
+    // flop against any hand
+    r = equity({hA, sA}, {uk, uk}, {c2, d7, h9}, opts);
+    assert_eql(false, r.exact);
+    assert_eql(true, r.win > 0.75 && r.win < 0.95);
+}
+
+void test_determinism() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - test_determinism" << std::endl;
+
+    equity_options opts;
+    opts.max_samples = 100000;
+    opts.precision = 0;
+    opts.seed = 42;
+    opts.threads = 1;
+    auto r1 = equity({hQ, hJ}, {uk, uk}, {}, opts);
+    opts.threads = 3;
+    auto r2 = equity({hQ, hJ}, {uk, uk}, {}, opts);
+    assert_eql(r1.win, r2.win);
+    assert_eql(r1.tie, r2.tie);
+    assert_eql(r1.samples, r2.samples);
+    opts.seed = 43;
+    auto r3 = equity({hQ, hJ}, {uk, uk}, {}, opts);
+    assert_neq(r1.win, r3.win);
+
+    // stops once precise enough
+    opts.precision = 0.005;
+    auto r4 = equity({hQ, hJ}, {uk, uk}, {}, opts);
+    assert_eql(true, r4.samples < opts.max_samples);
+    assert_eql(true, std::fabs(r4.win + r4.tie / 2 - (r1.win + r1.tie / 2)) < 0.02);
+}
+
+void test_errors() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - test_errors" << std::endl;
+
+    equity_options opts;
+    equity_result r;
+    card_t hand[] = {hA, sA};
+    card_t unknown[] = {uk, uk};
+    card_t board[] = {c2, d7, h9, cJ, sA};
+    assert_eql(SRR_DUPLICATE_CARD, compute_equity(hand, unknown, board, 5, opts, r));
+    assert_eql(SRR_UNSUPPORTED_HAND_SIZE, compute_equity(hand, unknown, board, 2, opts, r));
+    assert_eql(SRR_UNKNOWN_CARD, compute_equity(unknown, hand, board, 3, opts, r));
+    card_t bad[] = {hA, 52};
+    assert_eql(SRR_UNKNOWN_CARD, compute_equity(bad, unknown, board, 3, opts, r));
+    opts.max_samples = 0;
+    assert_eql(SRR_INVALID_EQUITY_OPTIONS, compute_equity(hand, unknown, board, 3, opts, r));
+}
+
+void test_game_state() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - test_game_state" << std::endl;
+
+    game_state g;
+    equity_options opts;
+    equity_result r;
+    g.players[ALICE].cards[0] = hA;
+    g.players[ALICE].cards[1] = sA;
+    g.public_cards[0] = c2;
+    g.public_cards[1] = d7;
+    g.public_cards[2] = h9;
+    g.public_cards[3] = cJ;
+    assert_eql(SUCCESS, compute_equity(g, ALICE, opts, r));
+    assert_eql(45540, r.samples);
+    // the opponent's cards before they are opened
+    assert_eql(SRR_UNKNOWN_CARD, compute_equity(g, BOB, opts, r));
+    assert_eql(GRR_INVALID_PLAYER, compute_equity(g, 2, opts, r));
+
+    g.players[BOB].cards[0] = dK;
+    g.players[BOB].cards[1] = cK;
+    g.public_cards[4] = s3;
+    assert_eql(SUCCESS, compute_equity(g, BOB, opts, r));
+    assert_eql(1.0, r.loss);
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    test_exhaustive();
+    test_monte_carlo();
+    test_determinism();
+    test_errors();
+    test_game_state();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
@@ -1,6 +1,8 @@
 #include <fstream>
 #include <iostream>
 
+#include "compression.h"
+#include "game-arena.h"
 #include "game-generator.h"
 #include "game-playback.h"
 #include "poker-lib.h"
@@ -55,6 +57,185 @@ void test_the_happy_path() {
     assert_eql(g.funds_share[BOB], vg.funds_share[BOB]);
 }
 
+void test_checkpoint_resume() {
+    game_generator gen;
+    assert_eql(SUCCESS, gen.generate());
+    const size_t first_turns = 6;  // up to the private cards
+
+    std::string head;
+    for (size_t i = 0; i < first_turns; i++) {
+        head += std::get<1>(gen.turns[i]);
+        pad_to_page(head);
+    }
+    std::istringstream is(head);
+    game_playback first;
+    assert_eql(SUCCESS, first.playback(is));
+    assert_eql((std::streamoff)head.size(), first.frame_offset());
+    std::stringstream checkpoint;
+    assert_eql(SUCCESS, first.save_checkpoint(checkpoint));
+
+    // the remaining turns are played back from the checkpoint
+    std::istringstream all(gen.raw_turn_data);
+    game_playback resumed;
+    size_t visited_count = 0;
+    auto visitor = [&](message* msg) {
+      visited_count += 1;
+      return SUCCESS;
+    };
+    assert_eql(SUCCESS, resumed.resume(checkpoint, all, first.frame_offset(), visitor));
+    assert_eql(gen.turns.size() - first_turns, visited_count);
+
+    auto& g = gen.bob_game.muck ? gen.bob_game : gen.alice_game;
+    auto& vg = resumed.game();
+    assert_eql(g.winner, vg.winner);
+    for (int i = 0; i < NUM_PUBLIC_CARDS; i++)
+        assert_eql(g.public_cards[i], vg.public_cards[i]);
+    assert_eql(g.funds_share[ALICE], vg.funds_share[ALICE]);
+    assert_eql(g.funds_share[BOB], vg.funds_share[BOB]);
+}
+
+void test_all_in() {
+    game_generator gen;
+    gen.all_in = true;
+    assert_eql(SUCCESS, gen.generate());
+    // 5 for the handshake, then the raise, the call and the response opening every card
+    assert_eql(8, gen.turns.size());
+
+    std::istringstream is(gen.raw_turn_data);
+    game_playback vcr;
+    assert_eql(SUCCESS, vcr.playback(is));
+    assert_eql(game_step::GAME_OVER, vcr.step());
+
+    auto& g = gen.alice_game;
+    auto& vg = vcr.game();
+    assert_eql(g.winner, vg.winner);
+    for (int i = 0; i < NUM_PUBLIC_CARDS; i++)
+        assert_eql(g.public_cards[i], vg.public_cards[i]);
+    for (int p = 0; p < NUM_PLAYERS; p++)
+        for (int i = 0; i < NUM_PRIVATE_CARDS; i++)
+            assert_eql(g.players[p].cards[i], vg.players[p].cards[i]);
+    assert_eql(g.funds_share[ALICE], vg.funds_share[ALICE]);
+    assert_eql(g.funds_share[BOB], vg.funds_share[BOB]);
+}
+
+void test_short_handshake() {
+    game_generator gen;
+    assert_eql(SUCCESS, gen.generate());
+    set_short_handshake(true);
+    game_generator short_gen;
+    auto res = short_gen.generate();
+    set_short_handshake(false);
+    assert_eql(SUCCESS, res);
+    assert_eql(gen.turns.size() - 1, short_gen.turns.size());
+
+    turn_data_index index;
+    assert_eql(SUCCESS, index.build(short_gen.raw_turn_data.data(), short_gen.raw_turn_data.size()));
+    assert_eql(2, index.find(game_step::ALICE_LAST_MIX));
+    assert_eql(4, index.find(game_step::PREFLOP_BET));
+
+    std::istringstream is(short_gen.raw_turn_data);
+    game_playback vcr;
+    assert_eql(SUCCESS, vcr.playback(is));
+    auto& g = short_gen.bob_game.muck ? short_gen.bob_game : short_gen.alice_game;
+    auto& vg = vcr.game();
+    assert_eql(g.winner, vg.winner);
+    for (int i = 0; i < NUM_PUBLIC_CARDS; i++)
+        assert_eql(g.public_cards[i], vg.public_cards[i]);
+    assert_eql(g.funds_share[ALICE], vg.funds_share[ALICE]);
+    assert_eql(g.funds_share[BOB], vg.funds_share[BOB]);
+}
+
+void test_pipelined_playback() {
+    game_generator gen;
+    assert_eql(SUCCESS, gen.generate());
+
+    std::istringstream sequential_is(gen.raw_turn_data), pipelined_is(gen.raw_turn_data);
+    game_playback sequential, pipelined;
+    pipelined.set_pipeline_depth(2);
+    std::vector<int> sequential_frames, pipelined_frames;
+    assert_eql(SUCCESS, sequential.playback(sequential_is, [&](message* msg) {
+        sequential_frames.push_back(sequential.frame_index());
+        return SUCCESS;
+    }));
+    assert_eql(SUCCESS, pipelined.playback(pipelined_is, [&](message* msg) {
+        pipelined_frames.push_back(pipelined.frame_index());
+        return SUCCESS;
+    }));
+    assert_eql(gen.turns.size(), pipelined_frames.size());
+    assert_eql(true, sequential_frames == pipelined_frames);
+    assert_eql(true, sequential.transcript_hashes() == pipelined.transcript_hashes());
+    assert_eql(sequential.frame_offset(), pipelined.frame_offset());
+    assert_eql(sequential.game().winner, pipelined.game().winner);
+    assert_eql(sequential.game().funds_share[ALICE], pipelined.game().funds_share[ALICE]);
+    assert_eql(sequential.game().funds_share[BOB], pipelined.game().funds_share[BOB]);
+
+    // a visitor error stops the playback while frames are still being decoded
+    std::istringstream stopped_is(gen.raw_turn_data);
+    game_playback stopped;
+    stopped.set_pipeline_depth(2);
+    assert_eql(VRF_TURN_PLAYER_MISMATCH, stopped.playback(stopped_is, [&](message* msg) {
+        return stopped.frame_index() == 3 ? VRF_TURN_PLAYER_MISMATCH : SUCCESS;
+    }));
+    assert_eql(3, stopped.messages_handled());
+}
+
+void test_turn_data_index(bool batch_turns) {
+    game_generator gen;
+    gen.batch_turns = batch_turns;
+    assert_eql(SUCCESS, gen.generate());
+
+    turn_data_index index;
+    assert_eql(SUCCESS, index.build(gen.raw_turn_data.data(), gen.raw_turn_data.size()));
+    assert_eql(gen.turns.size(), index.size());
+
+    std::istringstream is(gen.raw_turn_data);
+    game_playback vcr;
+    assert_eql(SUCCESS, vcr.playback(is, [&](message* msg) {
+        if (vcr.frame_message_index() > 0)
+            return SUCCESS;
+        auto& f = index[vcr.frame_index()];
+        assert_eql(msg->type(), f.type);
+        assert_eql(msg->player_id, f.player_id);
+        assert_eql(vcr.step(), f.step);
+        return SUCCESS;
+    }));
+
+    // frames are read straight from their offset
+    std::istringstream log(gen.raw_turn_data);
+    assert_eql(SUCCESS, vcr.seek_step(log, index, FLOP_BET));
+    assert_eql(index.find(FLOP_BET), vcr.frame_index() + 1);
+    std::vector<std::string> frame;
+    assert_eql(SUCCESS, unwrap_and_decompress_next(log, frame));
+    message* msg = NULL;
+    std::istringstream msg_is(frame[0]);
+    assert_eql(SUCCESS, message::decode(msg_is, &msg));
+    assert_eql(MSG_BET_REQUEST, msg->type());
+    assert_eql((std::streamoff)log.tellg(), index[index.find(FLOP_BET)].next);
+    delete msg;
+
+    assert_eql(PLB_FRAME_NOT_FOUND, vcr.seek_frame(log, index, (int)index.size()));
+}
+
+void test_game_arenas() {
+    use_game_arenas(true);
+    auto& counters = thread_allocation_counters();
+    counters = allocation_counters{0, 0};
+    {
+        game_generator gen;
+        assert_eql(SUCCESS, gen.generate());
+        std::istringstream is(gen.raw_turn_data);
+        game_playback vcr;
+        assert_eql(SUCCESS, vcr.playback(is));
+
+        auto& g = gen.bob_game.muck ? gen.bob_game : gen.alice_game;
+        assert_eql(g.winner, vcr.game().winner);
+        assert_eql(g.funds_share[ALICE], vcr.game().funds_share[ALICE]);
+        assert_eql(g.funds_share[BOB], vcr.game().funds_share[BOB]);
+    }
+    assert_neq(0, (int)counters.arena);
+    use_game_arenas(false);
+}
+
 game_state playback_fixture(const std::string game) {
     std::cout << "Replaying game: " << game << std::endl;
     std::string path = base_dir + "/" + game + "/turn-data.raw";
@@ -112,6 +293,13 @@ int main(int argc, char** argv) {
     init_poker_lib();
 
     test_the_happy_path();
+    test_checkpoint_resume();
+    test_all_in();
+    test_short_handshake();
+    test_pipelined_playback();
+    test_turn_data_index(false);
+    test_turn_data_index(true);
+    test_game_arenas();
     test_tie();
     test_alice_last_aggressor();
     test_bob_last_aggressor();
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <sstream>
+#include <memory.h>
+#include "poker-lib.h"
+#include "common.h"
+#include "test-util.h"
+#include "money.h"
+#include "game-state.h"
+
+#define TEST_SUITE_NAME "Test money"
+
+using namespace poker;
+
+static const char* max_hex = "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff";
+
+void the_happy_path() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - the_happy_path" << std::endl;
+
+    money_t two = 2;
+    std::ostringstream ss2;
+    assert_eql(SUCCESS, two.write_binary_be(ss2, 4));
+    assert_eql(std::string("\x00\x00\x00\x02",4), ss2.str());
+    std::istringstream ss22(ss2.str());
+    money_t two2;
+    assert_eql(SUCCESS, two2.read_binary_be(ss22, ss2.str().size()));
+    assert_eql(two, two2);
+
+    money_t x = 1, y = 2;
+    assert_eql(true, checked_add(x, y, x));
+    assert_eql(3, x);
+    assert_eql(true, checked_sub(x, y, x));
+    assert_eql(1, x);
+    assert_eql(true, x < y);
+    assert_eql(5, money_t(10) / 2);
+    assert_eql(0, money_t(1) / 2);
+
+    x = 10;
+    assert_eql("10", x.to_string());
+    assert_eql("a", x.to_string(16));
+    assert_eql("0", money_t().to_string());
+
+    char data[32] = {(char)0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+    assert_eql(SUCCESS, x.load_binary_be(data, sizeof(data)));
+    char data2[32];
+    memset(data2, 0xff, 32);
+    assert_eql(SUCCESS, x.store_binary_be(data2, sizeof(data2)));
+    assert_eql(0, memcmp(data, data2, 32));
+    assert_eql("8000000000000000000000000000000000000000000000000000000000000001", x.to_string(16));
+
+    money_t z;
+    assert_eql(SUCCESS, z.parse_string("115792089237316195423570985008687907853269984665640564039457584007913129639935"));
+    assert_eql(max_hex, z.to_string(16));
+    uint64_t v;
+    assert_eql(false, z.to_uint64(v));
+    assert_eql(SUCCESS, z.parse_string("18446744073709551615"));
+    assert_eql(true, z.to_uint64(v));
+    assert_eql(18446744073709551615ull, v);
+
+    std::istringstream is("\x01\x02\x03");
+    assert_eql(SUCCESS, z.read_binary_be(is, 3));
+    assert_eql(0x010203, z);
+    std::stringstream ss;
+    assert_eql(SUCCESS, z.write_binary_be(ss, 3));
+    assert_eql(true, std::string("\x01\x02\x03") == ss.str());
+}
+
+void test_checked() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - test_checked" << std::endl;
+
+    money_t max, one = 1, r = 7;
+    assert_eql(SUCCESS, max.parse_string(max_hex, 16));
+    assert_eql(false, checked_add(max, one, r));
+    assert_eql(7, r);
+    assert_eql(false, checked_sub(one, money_t(2), r));
+    assert_eql(7, r);
+    assert_eql(true, checked_sub(max, max, r));
+    assert_eql(0, r);
+
+    // no silent truncation on the way in or out
+    assert_eql(BIG_OVERFLOW, r.parse_string("1" "0000000000000000000000000000000000000000000000000000000000000000", 16));
+    assert_eql(BIG_UNPARSEABLE, r.parse_string("-1"));
+    assert_eql(BIG_UNPARSEABLE, r.parse_string(""));
+    char data[4];
+    assert_eql(BIG_OVERFLOW, money_t(0x100000000ull).store_binary_be(data, 4));
+    char wide[33] = {1};
+    assert_eql(BIG_OVERFLOW, r.load_binary_be(wide, sizeof(wide)));
+
+    // game states copy as plain memory
+    game_state g;
+    g.funds_share[BOB] = max;
+    game_state copy;
+    memcpy((void*)&copy, (const void*)&g, sizeof(g));
+    assert_eql(max, copy.funds_share[BOB]);
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    the_happy_path();
+    test_checked();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
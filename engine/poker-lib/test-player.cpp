@@ -225,6 +225,238 @@ void test_fold() {
     assert_eql(BOB, bob.winner());
 }
 
+void test_short_handshake() {
+    set_short_handshake(true);
+    player alice(ALICE);
+    assert_eql(SUCCESS, alice.init(100, 300, 10));
+    player bob(BOB);
+    assert_eql(SUCCESS, bob.init(100, 300, 10));
+
+    std::map<int, std::string> msg; // messages exchanged during game
+
+    assert_eql(SUCCESS, alice.create_handshake(msg[0]));
+    assert_eql(CONTINUED, bob.process_handshake(msg[0], msg[1]));
+    assert_eql(CONTINUED, alice.process_handshake(msg[1], msg[2]));
+    assert_eql(SUCCESS, bob.process_handshake(msg[2], msg[3]));
+    assert_eql(ALICE, bob.game().next_msg_author);
+    assert_neq(uk, bob.private_card(0));
+    assert_neq(uk, bob.private_card(1));
+    assert_eql(SUCCESS, alice.process_handshake(msg[3], msg[4]));
+    assert_eql(true, msg[4].size()==0);
+    assert_neq(uk, alice.private_card(0));
+    assert_neq(uk, alice.private_card(1));
+    assert_eql(uk, alice.opponent_card(0));
+    assert_eql(uk, bob.opponent_card(0));
+    assert_eql(game_step::PREFLOP_BET, alice.step());
+    assert_eql(game_step::PREFLOP_BET, bob.step());
+    set_short_handshake(false);
+
+    // the game goes on as after the long handshake
+    assert_eql(SUCCESS, alice.create_bet(BET_CALL, 0, msg[4]));
+    assert_eql(SUCCESS, bob.process_bet(msg[4], msg[5]));
+    assert_eql(CONTINUED, bob.create_bet(BET_CHECK, 0, msg[5]));
+    assert_eql(SUCCESS, alice.process_bet(msg[5], msg[6]));
+    assert_eql(SUCCESS, bob.process_bet(msg[6], msg[7]));
+    assert_eql(game_step::FLOP_BET, alice.step());
+    for (int i = 0; i < NUM_FLOP_CARDS; i++) {
+        assert_neq(uk, alice.public_card(FLOP(i)));
+        assert_eql(alice.public_card(FLOP(i)), bob.public_card(FLOP(i)));
+    }
+}
+
+void test_all_in() {
+    player alice(ALICE);
+    assert_eql(SUCCESS, alice.init(100, 300, 10));
+    player bob(BOB);
+    assert_eql(SUCCESS, bob.init(100, 300, 10));
+
+    std::map<int, std::string> msg; // messages exchanged during game
+
+    assert_eql(SUCCESS, alice.create_handshake(msg[0]));
+    assert_eql(CONTINUED, bob.process_handshake(msg[0], msg[1]));
+    assert_eql(CONTINUED, alice.process_handshake(msg[1], msg[2]));
+    assert_eql(CONTINUED, bob.process_handshake(msg[2], msg[3]));
+    assert_eql(SUCCESS, alice.process_handshake(msg[3], msg[4]));
+    assert_eql(SUCCESS, bob.process_handshake(msg[4], msg[5]));
+
+    // Preflop: Alice goes all in
+    assert_eql(SUCCESS, alice.create_bet(BET_RAISE, 90, msg[5]));
+    assert_eql(SUCCESS, bob.process_bet(msg[5], msg[6]));
+    assert_eql(true, msg[6].size()==0);
+
+    // Bob calls: the whole board and both hands open in one exchange
+    assert_eql(CONTINUED, bob.create_bet(BET_CALL, 0, msg[6]));
+    assert_eql(game_step::SHOWDOWN, bob.step());
+    assert_eql(SUCCESS, alice.process_bet(msg[6], msg[7]));
+    assert_eql(game_step::GAME_OVER, alice.step());
+    assert_eql(SUCCESS, bob.process_bet(msg[7], msg[8]));
+    assert_eql(true, msg[8].size()==0);
+    assert_eql(game_step::GAME_OVER, bob.step());
+
+    for (int i = 0; i < NUM_PUBLIC_CARDS; i++) {
+        assert_neq(uk, alice.public_card(i));
+        assert_eql(alice.public_card(i), bob.public_card(i));
+    }
+    assert_eql(bob.private_card(0), alice.opponent_card(0));
+    assert_eql(bob.private_card(1), alice.opponent_card(1));
+    assert_eql(alice.private_card(0), bob.opponent_card(0));
+    assert_eql(alice.private_card(1), bob.opponent_card(1));
+    assert_neq(-1, alice.winner());
+    assert_eql(alice.winner(), bob.winner());
+    assert_eql(alice.game().funds_share[ALICE], bob.game().funds_share[ALICE]);
+    assert_eql(alice.game().funds_share[BOB], bob.game().funds_share[BOB]);
+}
+
+void test_all_in_older_version() {
+    player alice(ALICE);
+    assert_eql(SUCCESS, alice.init(100, 300, 10));
+    player bob(BOB);
+    assert_eql(SUCCESS, bob.init(100, 300, 10));
+
+    std::map<int, std::string> msg; // messages exchanged during game
+
+    // Alice plays a version before the runout: Bob follows her
+    alice.game().version = min_poker_version;
+    assert_eql(SUCCESS, alice.create_handshake(msg[0]));
+    assert_eql(CONTINUED, bob.process_handshake(msg[0], msg[1]));
+    assert_eql(min_poker_version, bob.game().version);
+    assert_eql(CONTINUED, alice.process_handshake(msg[1], msg[2]));
+    assert_eql(CONTINUED, bob.process_handshake(msg[2], msg[3]));
+    assert_eql(SUCCESS, alice.process_handshake(msg[3], msg[4]));
+    assert_eql(SUCCESS, bob.process_handshake(msg[4], msg[5]));
+
+    // Preflop: Alice goes all in, Bob calls
+    assert_eql(SUCCESS, alice.create_bet(BET_RAISE, 90, msg[5]));
+    assert_eql(SUCCESS, bob.process_bet(msg[5], msg[6]));
+    assert_eql(CONTINUED, bob.create_bet(BET_CALL, 0, msg[6]));
+    assert_eql(game_step::OPEN_FLOP, bob.step());
+    assert_eql(SUCCESS, alice.process_bet(msg[6], msg[7]));
+    assert_eql(SUCCESS, bob.process_bet(msg[7], msg[8]));
+    assert_eql(uk, bob.public_card(TURN));
+
+    // every street is still checked through
+    assert_eql(game_step::FLOP_BET, bob.step());
+    assert_eql(SUCCESS, bob.create_bet(BET_CHECK, 0, msg[8]));
+    assert_eql(SUCCESS, alice.process_bet(msg[8], msg[9]));
+    assert_eql(CONTINUED, alice.create_bet(BET_CHECK, 0, msg[9]));
+    assert_eql(SUCCESS, bob.process_bet(msg[9], msg[10]));
+    assert_eql(SUCCESS, alice.process_bet(msg[10], msg[11]));
+
+    assert_eql(game_step::TURN_BET, bob.step());
+    assert_eql(SUCCESS, bob.create_bet(BET_CHECK, 0, msg[11]));
+    assert_eql(SUCCESS, alice.process_bet(msg[11], msg[12]));
+    assert_eql(CONTINUED, alice.create_bet(BET_CHECK, 0, msg[12]));
+    assert_eql(SUCCESS, bob.process_bet(msg[12], msg[13]));
+    assert_eql(SUCCESS, alice.process_bet(msg[13], msg[14]));
+
+    assert_eql(game_step::RIVER_BET, bob.step());
+    assert_eql(SUCCESS, bob.create_bet(BET_CHECK, 0, msg[14]));
+    assert_eql(SUCCESS, alice.process_bet(msg[14], msg[15]));
+    assert_eql(CONTINUED, alice.create_bet(BET_CHECK, 0, msg[15]));
+    assert_eql(CONTINUED, bob.process_bet(msg[15], msg[16]));
+    assert_eql(SUCCESS, alice.process_bet(msg[16], msg[17]));
+    assert_eql(SUCCESS, bob.process_bet(msg[17], msg[18]));
+    assert_eql(game_step::GAME_OVER, alice.step());
+    assert_eql(game_step::GAME_OVER, bob.step());
+    assert_eql(alice.winner(), bob.winner());
+    assert_eql(alice.game().funds_share[ALICE], bob.game().funds_share[ALICE]);
+}
+
+void test_save_load() {
+    player alice(ALICE);
+    assert_eql(SUCCESS, alice.init(100, 300, 10));
+    player bob(BOB);
+    assert_eql(SUCCESS, bob.init(100, 300, 10));
+
+    std::map<int, std::string> msg; // messages exchanged during game
+
+    assert_eql(SUCCESS, alice.create_handshake(msg[0]));
+    assert_eql(CONTINUED, bob.process_handshake(msg[0], msg[1]));
+    assert_eql(CONTINUED, alice.process_handshake(msg[1], msg[2]));
+    assert_eql(CONTINUED, bob.process_handshake(msg[2], msg[3]));
+    assert_eql(SUCCESS, alice.process_handshake(msg[3], msg[4]));
+    assert_eql(SUCCESS, bob.process_handshake(msg[4], msg[5]));
+
+    // both players move to new instances
+    std::stringstream alice_snapshot, bob_snapshot;
+    assert_eql(SUCCESS, alice.save(alice_snapshot));
+    assert_eql(SUCCESS, bob.save(bob_snapshot));
+    player alice2(ALICE);
+    player bob2(ALICE);
+    assert_eql(SUCCESS, alice2.load(alice_snapshot));
+    assert_eql(SUCCESS, bob2.load(bob_snapshot));
+    assert_eql(alice.private_card(0), alice2.private_card(0));
+    assert_eql(alice.private_card(1), alice2.private_card(1));
+    assert_eql(bob.private_card(0), bob2.private_card(0));
+    assert_eql(bob.private_card(1), bob2.private_card(1));
+    assert_eql(game_step::PREFLOP_BET, bob2.step());
+
+    // the game goes on with the restored secrets
+    assert_eql(SUCCESS, alice2.create_bet(BET_CALL, 0, msg[5]));
+    assert_eql(SUCCESS, bob2.process_bet(msg[5], msg[6]));
+    assert_eql(CONTINUED, bob2.create_bet(BET_CHECK, 0, msg[6]));
+    assert_eql(SUCCESS, alice2.process_bet(msg[6], msg[7]));
+    assert_eql(SUCCESS, bob2.process_bet(msg[7], msg[8]));
+    assert_eql(game_step::FLOP_BET, alice2.step());
+    assert_eql(game_step::FLOP_BET, bob2.step());
+    for (int i = 0; i < NUM_FLOP_CARDS; i++) {
+        assert_neq(uk, alice2.public_card(FLOP(i)));
+        assert_eql(alice2.public_card(FLOP(i)), bob2.public_card(FLOP(i)));
+    }
+
+    std::stringstream garbage("not a snapshot");
+    player carol(BOB);
+    assert_eql(PRR_INVALID_SNAPSHOT, carol.load(garbage));
+}
+
+void test_batched_bets() {
+    player alice(ALICE);
+    assert_eql(SUCCESS, alice.init(100, 300, 10));
+    player bob(BOB);
+    assert_eql(SUCCESS, bob.init(100, 300, 10));
+
+    std::map<int, std::string> msg; // messages exchanged during game
+
+    assert_eql(SUCCESS, alice.create_handshake(msg[0]));
+    assert_eql(CONTINUED, bob.process_handshake(msg[0], msg[1]));
+    assert_eql(CONTINUED, alice.process_handshake(msg[1], msg[2]));
+    assert_eql(CONTINUED, bob.process_handshake(msg[2], msg[3]));
+    assert_eql(SUCCESS, alice.process_handshake(msg[3], msg[4]));
+    assert_eql(SUCCESS, bob.process_handshake(msg[4], msg[5]));
+
+    assert_eql(SUCCESS, alice.create_bet(BET_CALL, 0, msg[5]));
+    assert_eql(SUCCESS, bob.process_bet(msg[5], msg[6]));
+    assert_eql(CONTINUED, bob.create_bet(BET_CHECK, 0, msg[6]));
+    assert_eql(SUCCESS, alice.process_bet(msg[6], msg[7]));
+    assert_eql(SUCCESS, bob.process_bet(msg[7], msg[8]));
+    assert_eql(SUCCESS, bob.create_bet(BET_CHECK, 0, msg[8]));
+    assert_eql(SUCCESS, alice.process_bet(msg[8], msg[9]));
+
+    // Flop: Alice checks; Bob's turn proofs and his raise go in one frame
+    assert_eql(CONTINUED, alice.create_bet(BET_CHECK, 0, msg[9]));
+    assert_eql(SUCCESS, bob.process_bet(msg[9], msg[10]));
+    assert_eql(BOB, bob.current_player());
+    assert_eql(SUCCESS, bob.create_bet(BET_RAISE, 30, msg[11]));
+    std::string batch;
+    assert_eql(SUCCESS, batch_frames({ msg[10], msg[11] }, batch));
+
+    bet_type type;
+    money_t amt;
+    assert_eql(SUCCESS, alice.process_bet(batch, msg[12], &type, &amt));
+    assert_eql(true, msg[12].empty());
+    assert_eql(BET_RAISE, type);
+    assert_eql(30, amt);
+    assert_eql(40, alice.game().players[BOB].bets);
+    assert_neq(uk, alice.public_card(TURN));
+    assert_eql(bob.public_card(TURN), alice.public_card(TURN));
+    assert_eql(ALICE, alice.current_player());
+
+    // a message calling for a response can only end a batch
+    assert_eql(CONTINUED, alice.create_bet(BET_CALL, 0, msg[12]));
+    assert_eql(SUCCESS, batch_frames({ msg[12], msg[12] }, batch));
+    assert_eql(PRR_BATCH_INTERRUPTED, bob.process_bet(batch, msg[13]));
+}
+
 void test_next_msg_author() {
     player alice(ALICE);
     assert_eql(SUCCESS, alice.init(100, 300, 10));
@@ -396,6 +628,11 @@ int main(int argc, char** argv) {
     init_poker_lib();
     test_the_happy_path();
     test_fold();
+    test_short_handshake();
+    test_all_in();
+    test_all_in_older_version();
+    test_save_load();
+    test_batched_bets();
     test_next_msg_author();
     test_invalid_messages();
     std::cout << "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
@@ -0,0 +1,345 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "codec.h"
+#include "host-server.h"
+#include "poker-lib.h"
+#include "test-util.h"
+
+#define TEST_SUITE_NAME "Test poker host"
+
+using namespace poker;
+
+/*
+ * The requests of poker-host without its sockets: frames are put in a
+ * connection's in and the responses are taken from its out. test_serve
+ * runs the I/O loop over a socketpair.
+ */
+
+static const int threads = 2;
+
+struct response {
+    int id;
+    int result;
+    std::string results;
+};
+
+// holds the workers, so that requests stay queued until it opens
+struct gate {
+    std::mutex lock;
+    std::condition_variable changed;
+    bool closed = true;
+
+    void hold(host_server& server) {
+        for (int i = 0; i < threads; i++)
+            server.workers().queue(-1 - i, (char*)this + i, [this]() {
+                std::unique_lock<std::mutex> l(lock);
+                changed.wait(l, [this]() { return !closed; });
+            });
+    }
+    void open() {
+        std::lock_guard<std::mutex> l(lock);
+        closed = false;
+        changed.notify_all();
+    }
+};
+
+static std::string request(int id, host_op op, int table, const std::string& args = "") {
+    std::stringstream out;
+    encoder e(out);
+    e.write(id);
+    e.write(op);
+    e.write(table);
+    out << args;
+    return host_frame(out.str());
+}
+
+static std::string new_table(int id, int player_id) {
+    std::stringstream args;
+    encoder e(args);
+    e.write(player_id);
+    e.write(false);  // encryption
+    e.write(-1);     // winner
+    e.write(false);  // short_handshake
+    e.write(money_t(100));
+    e.write(money_t(300));
+    e.write(money_t(10));
+    return request(id, HOST_NEW_TABLE, 0, args.str());
+}
+
+static response decode_response(const std::string& payload) {
+    std::stringstream in(payload);
+    decoder d(in);
+    response r;
+    assert_eql(SUCCESS, d.read(r.id));
+    assert_eql(SUCCESS, d.read(r.result));
+    auto pos = in.tellg();
+    r.results = pos < 0 ? "" : payload.substr(pos);
+    return r;
+}
+
+// the next n responses written to c
+static std::vector<response> responses(host_server& server, host_connection& c, size_t n) {
+    std::vector<response> found;
+    while (found.size() < n) {
+        std::string payload;
+        bool whole;
+        {
+            std::lock_guard<std::mutex> l(server.lock());
+            assert_eql(SUCCESS, next_host_frame(c.out, payload, whole));
+        }
+        if (!whole) {
+            std::this_thread::yield();
+            continue;
+        }
+        found.push_back(decode_response(payload));
+    }
+    return found;
+}
+
+static int open_table(host_server& server, const std::shared_ptr<host_connection>& c, int player_id) {
+    c->in += new_table(0, player_id);
+    assert_eql(true, server.dispatch(c));
+    auto r = responses(server, *c, 1);
+    assert_eql(SUCCESS, r[0].result);
+    std::stringstream in(r[0].results);
+    int table;
+    assert_eql(SUCCESS, decoder(in).read(table));
+    return table;
+}
+
+void test_frames() {
+    std::cout << "---- " TEST_SUITE_NAME << " - test_frames" << std::endl;
+    std::string payload;
+    bool found;
+
+    // a partial header, then a partial frame
+    std::string buffer = host_frame("hello").substr(0, 2);
+    assert_eql(SUCCESS, next_host_frame(buffer, payload, found));
+    assert_eql(false, found);
+    buffer = host_frame("hello") + host_frame("x");
+    buffer.pop_back();
+    assert_eql(SUCCESS, next_host_frame(buffer, payload, found));
+    assert_eql(true, found);
+    assert_eql("hello", payload);
+    assert_eql(SUCCESS, next_host_frame(buffer, payload, found));
+    assert_eql(false, found);
+    assert_eql((size_t)host_frame_header, buffer.size());
+    buffer += "x";
+    assert_eql(SUCCESS, next_host_frame(buffer, payload, found));
+    assert_eql(true, found);
+    assert_eql("x", payload);
+    assert_eql(true, buffer.empty());
+
+    // empty payloads are frames too
+    buffer = host_frame("");
+    assert_eql(SUCCESS, next_host_frame(buffer, payload, found));
+    assert_eql(true, found);
+    assert_eql(true, payload.empty());
+
+    // a length above the maximum, before the frame is all there
+    buffer = std::string("\x7f\0\0\0", 4);
+    assert_eql(HST_FRAME_TOO_BIG, next_host_frame(buffer, payload, found));
+    assert_eql(false, found);
+}
+
+void test_table_busy() {
+    std::cout << "---- " TEST_SUITE_NAME << " - test_table_busy" << std::endl;
+    host_server server(threads, 2, 64, 1024 * 1024, []() {});
+    std::shared_ptr<host_connection> c(new host_connection(-1));
+    int table = open_table(server, c, ALICE);
+
+    gate g;
+    g.hold(server);
+    for (int id = 1; id <= 3; id++)
+        c->in += request(id, HOST_GAME_STATE, table);
+    c->in += request(4, HOST_DELETE_TABLE, table);
+    assert_eql(true, server.dispatch(c));
+
+    // the third is over the table's queue; deleting is always taken
+    auto busy = responses(server, *c, 1);
+    assert_eql(3, busy[0].id);
+    assert_eql(HST_TABLE_BUSY, busy[0].result);
+    g.open();
+    auto r = responses(server, *c, 3);
+    for (int i = 0; i < 3; i++)
+        assert_eql(SUCCESS, r[i].result);
+    assert_eql(1, r[0].id);
+    assert_eql(2, r[1].id);
+    assert_eql(4, r[2].id);
+}
+
+void test_table_order() {
+    std::cout << "---- " TEST_SUITE_NAME << " - test_table_order" << std::endl;
+    host_server server(threads, 64, 64, 1024 * 1024, []() {});
+    std::shared_ptr<host_connection> c(new host_connection(-1));
+    int tables[] = { open_table(server, c, ALICE), open_table(server, c, BOB) };
+    char initial_step[100];
+    sprintf(initial_step, "\"step\": %d", (int)c->tables[tables[0]]->p.step());
+
+    // requests of both tables interleaved, answered in order per table
+    gate g;
+    g.hold(server);
+    const int per_table = 20;
+    for (int i = 0; i < per_table; i++)
+        for (int t = 0; t < 2; t++)
+            c->in += request(2 * i + t, i == 0 && t == 0 ? HOST_CREATE_HANDSHAKE : HOST_GAME_STATE, tables[t]);
+    assert_eql(true, server.dispatch(c));
+    g.open();
+
+    int last[] = { -1, -1 };
+    for (auto& r : responses(server, *c, 2 * per_table)) {
+        assert_eql(SUCCESS, r.result);
+        int t = r.id % 2;
+        assert_eql(true, r.id > last[t]);
+        last[t] = r.id;
+        // alice's state is read after her handshake was created
+        if (t == 0 && r.id > 0)
+            assert_eql(std::string::npos, r.results.find(initial_step));
+    }
+}
+
+void test_table_owner() {
+    std::cout << "---- " TEST_SUITE_NAME << " - test_table_owner" << std::endl;
+    host_server server(threads, 8, 64, 1024 * 1024, []() {});
+    std::shared_ptr<host_connection> first(new host_connection(-1)), second(new host_connection(-1));
+    int table = open_table(server, first, ALICE);
+
+    // another connection doesn't see the table
+    second->in += request(1, HOST_GAME_STATE, table);
+    assert_eql(true, server.dispatch(second));
+    assert_eql(HST_TABLE_NOT_FOUND, responses(server, *second, 1)[0].result);
+
+    // nor does its owner, once deleted
+    first->in += request(2, HOST_DELETE_TABLE, table);
+    assert_eql(true, server.dispatch(first));
+    assert_eql(SUCCESS, responses(server, *first, 1)[0].result);
+    first->in += request(3, HOST_GAME_STATE, table);
+    assert_eql(true, server.dispatch(first));
+    assert_eql(HST_TABLE_NOT_FOUND, responses(server, *first, 1)[0].result);
+}
+
+void test_close() {
+    std::cout << "---- " TEST_SUITE_NAME << " - test_close" << std::endl;
+    host_server server(threads, 8, 64, 1024 * 1024, []() {});
+    std::shared_ptr<host_connection> first(new host_connection(-1)), second(new host_connection(-1));
+    int table_a = open_table(server, first, ALICE);
+    int table_b = open_table(server, second, ALICE);
+    auto initial_step = first->tables[table_a]->p.step();
+
+    // the requests of a closed connection don't run
+    gate g;
+    g.hold(server);
+    for (int id = 1; id <= 3; id++)
+        first->in += request(id, HOST_CREATE_HANDSHAKE, table_a);
+    second->in += request(4, HOST_GAME_STATE, table_b);
+    assert_eql(true, server.dispatch(first));
+    assert_eql(true, server.dispatch(second));
+    server.close(*first);
+    {
+        std::lock_guard<std::mutex> l(server.lock());
+        assert_eql(0, first->pending);
+        assert_eql(true, first->tasks.empty());
+        assert_eql(0, first->tables[table_a]->pending);
+    }
+    g.open();
+    auto r = responses(server, *second, 1);
+    assert_eql(4, r[0].id);
+    assert_eql(SUCCESS, r[0].result);
+    assert_eql(initial_step, first->tables[table_a]->p.step());
+    std::lock_guard<std::mutex> l(server.lock());
+    assert_eql(true, first->out.empty());
+}
+
+static void write_all(int fd, const std::string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        assert_eql(true, n > 0);
+        done += n;
+    }
+}
+
+static response read_response(int fd) {
+    std::string payload;
+    assert_eql(SUCCESS, read_host_frame(fd, payload));
+    return decode_response(payload);
+}
+
+void test_serve() {
+    std::cout << "---- " TEST_SUITE_NAME << " - test_serve" << std::endl;
+    int wake_pipe[2], client[2], bad_client[2];
+    assert_eql(0, pipe(wake_pipe));
+    assert_eql(0, fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK));
+    assert_eql(0, socketpair(AF_UNIX, SOCK_STREAM, 0, client));
+    assert_eql(0, socketpair(AF_UNIX, SOCK_STREAM, 0, bad_client));
+
+    // few requests in flight, so that the connection is read as they complete
+    host_server server(threads, 64, 2, 1024 * 1024, [&]() {
+        ssize_t n = write(wake_pipe[1], "", 1);
+        (void)n;
+    });
+    std::atomic<bool> stop(false);
+    std::thread io([&]() {
+        serve(server, -1, wake_pipe[0], { client[0], bad_client[0] }, [&]() { return stop.load(); });
+    });
+
+    write_all(client[1], new_table(0, ALICE));
+    auto r = read_response(client[1]);
+    assert_eql(SUCCESS, r.result);
+    std::stringstream results(r.results);
+    int table;
+    assert_eql(SUCCESS, decoder(results).read(table));
+
+    // many more requests than in flight, written at once, answered in order
+    const int requests = 50;
+    std::string frames;
+    for (int id = 1; id <= requests; id++)
+        frames += request(id, HOST_GAME_STATE, table);
+    std::thread writer([&]() { write_all(client[1], frames); });
+    for (int id = 1; id <= requests; id++) {
+        r = read_response(client[1]);
+        assert_eql(id, r.id);
+        assert_eql(SUCCESS, r.result);
+    }
+    writer.join();
+
+    // a frame too big closes its connection, not the others
+    write_all(bad_client[1], std::string("\x7f\0\0\0", 4));
+    std::string payload;
+    assert_eql(HST_CONNECTION_CLOSED, read_host_frame(bad_client[1], payload));
+    write_all(client[1], request(requests + 1, HOST_DELETE_TABLE, table));
+    assert_eql(SUCCESS, read_response(client[1]).result);
+
+    // stopping closes the connections left
+    stop = true;
+    ssize_t n = write(wake_pipe[1], "", 1);
+    (void)n;
+    io.join();
+    assert_eql(HST_CONNECTION_CLOSED, read_host_frame(client[1], payload));
+
+    close(client[1]);
+    close(bad_client[1]);
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    test_frames();
+    test_table_busy();
+    test_table_order();
+    test_table_owner();
+    test_close();
+    test_serve();
+    std::cout << "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
@@ -5,6 +5,10 @@
 #include "test-util.h"
 #include "common.h"
 #include "poker-lib-c-api.h"
+#ifdef POKER_THREADS
+#include <mutex>
+#include <thread>
+#endif
 
 #define FLOP(n) (n)
 #define TURN    FLOP(2)+1
@@ -29,6 +33,22 @@ void test_the_happy_path() {
     assert_eql(PAPI_SUCCESS, papi_process_handshake(bob, msg[4], len, &msg[5], &len));
     assert_eql(true, len==0);
 
+    // Alice moves to a new player instance
+    PAPI_MESSAGE snapshot;
+    PAPI_INT snapshot_len;
+    assert_eql(PAPI_SUCCESS, papi_save_player(alice, &snapshot, &snapshot_len));
+    assert_eql(PAPI_SUCCESS, papi_delete_player(alice));
+    assert_eql(PAPI_SUCCESS, papi_new_player(0, &alice));
+    assert_eql(PAPI_SUCCESS, papi_load_player(alice, snapshot, snapshot_len));
+    assert_eql(PAPI_SUCCESS, papi_delete_message(snapshot));
+
+    // Alice's preflop equity, by Monte Carlo
+    double win, tie, loss;
+    PAPI_INT samples;
+    assert_eql(PAPI_SUCCESS, papi_compute_equity(alice, 10000, 0, 1, 2, &win, &tie, &loss, &samples));
+    assert_eql(10000, samples);
+    assert_eql(true, win > 0 && loss > 0 && win + tie + loss > 0.999);
+
     // Preflop: Alice calls
     assert_eql(PAPI_SUCCESS, papi_create_bet(alice, poker::BET_CALL, (PAPI_MONEY)"0", &msg[5], &len));
 
@@ -46,8 +66,305 @@ void test_the_happy_path() {
     assert_eql(PAPI_SUCCESS, papi_delete_player(bob));
 }
 
+static PAPI_COMPLETION next_completion() {
+    PAPI_COMPLETION c;
+    assert_eql(PAPI_SUCCESS, papi_poll_completion(&c, -1));
+    return c;
+}
+
+// Alice's bet completes on a worker, which passes it on to Bob
+static void on_bet(const PAPI_COMPLETION* c, void* user_data) {
+    PAPI_PLAYER bob = *(PAPI_PLAYER*)user_data;
+    PAPI_TASK task;
+    assert_eql(PAPI_SUCCESS, c->result);
+    assert_eql(PAPI_SUCCESS, papi_process_bet_async(bob, c->msg_out, c->msg_out_len, NULL, NULL, &task));
+    assert_eql(PAPI_SUCCESS, papi_delete_message(c->msg_out));
+}
+
+void test_async() {
+    assert_eql(PAPI_SUCCESS, papi_init(true, true, -1));
+    PAPI_PLAYER alice, bob;
+    assert_eql(PAPI_SUCCESS, papi_new_player(0, &alice));
+    assert_eql(PAPI_SUCCESS, papi_new_player(1, &bob));
+    assert_eql(PAPI_SUCCESS, papi_init_player(alice, (PAPI_MONEY)"100", (PAPI_MONEY)"300", (PAPI_MONEY)"10"));
+    assert_eql(PAPI_SUCCESS, papi_init_player(bob, (PAPI_MONEY)"100", (PAPI_MONEY)"300", (PAPI_MONEY)"10"));
+    assert_eql(PAPI_SUCCESS, papi_start_workers(2));
+    assert_eql(poker::APR_WORKERS_RUNNING, papi_start_workers(2));
+
+    PAPI_MESSAGE msg;
+    PAPI_INT len;
+    PAPI_TASK task;
+    assert_eql(PAPI_SUCCESS, papi_create_handshake(alice, &msg, &len));
+    PAPI_ERR expected[] = {PAPI_CONTINUED, PAPI_CONTINUED, PAPI_CONTINUED, PAPI_SUCCESS, PAPI_SUCCESS};
+    PAPI_PLAYER receiver = bob;
+    for (auto e : expected) {
+        assert_eql(PAPI_SUCCESS, papi_process_handshake_async(receiver, msg, len, NULL, NULL, &task));
+        assert_eql(PAPI_SUCCESS, papi_delete_message(msg));
+        auto c = next_completion();
+        assert_eql(task, c.task);
+        assert_eql(e, c.result);
+        msg = c.msg_out;
+        len = c.msg_out_len;
+        receiver = receiver == bob ? alice : bob;
+    }
+    assert_eql(0, len);
+
+    // Preflop: Alice calls, Bob receives the call
+    assert_eql(PAPI_SUCCESS, papi_create_bet_async(alice, poker::BET_CALL, (PAPI_MONEY)"0", on_bet, &bob, &task));
+    auto c = next_completion();
+    assert_eql(true, c.task != task);
+    assert_eql(PAPI_SUCCESS, c.result);
+    assert_eql(true, (int)c.type == (int)poker::BET_CALL);
+    assert_eql(0, strcmp(c.amt, "0"));
+    assert_eql(PAPI_SUCCESS, papi_delete_message(c.msg_out));
+    assert_eql(poker::APR_NO_COMPLETION, papi_poll_completion(&c, 0));
+
+#ifdef POKER_THREADS
+    // A task waits while another of the same player runs, and may be cancelled meanwhile
+    static std::mutex gate;
+    static PAPI_ERR gated_result, queued_when_stopping;
+    static PAPI_PLAYER idle;
+    assert_eql(PAPI_SUCCESS, papi_new_player(0, &idle));
+    gate.lock();
+    PAPI_TASK running, waiting;
+    assert_eql(PAPI_SUCCESS, papi_process_handshake_async(idle, (PAPI_MESSAGE)"x", 1, [](const PAPI_COMPLETION* c, void*) {
+        std::lock_guard<std::mutex> lock(gate);
+        gated_result = c->result;
+        PAPI_TASK next;
+        queued_when_stopping = papi_process_bet_async(idle, (PAPI_MESSAGE)"x", 1, NULL, NULL, &next);
+    }, NULL, &running));
+    assert_eql(PAPI_SUCCESS, papi_process_bet_async(idle, (PAPI_MESSAGE)"x", 1, NULL, NULL, &waiting));
+    assert_eql(PAPI_SUCCESS, papi_cancel(waiting));
+    c = next_completion();
+    assert_eql(waiting, c.task);
+    assert_eql(poker::APR_CANCELLED, c.result);
+    assert_eql(true, c.msg_out == NULL);
+    assert_eql(poker::APR_TASK_NOT_FOUND, papi_cancel(waiting));
+
+    // Stopping waits for the running task, which can't queue another meanwhile
+    std::thread stopper([]() { assert_eql(PAPI_SUCCESS, papi_stop_workers()); });
+    while (papi_start_workers(2) != poker::APR_WORKERS_STOPPING)
+        std::this_thread::yield();
+    assert_eql(poker::APR_WORKERS_STOPPING, papi_stop_workers());
+    gate.unlock();
+    stopper.join();
+    assert_eql(true, gated_result != PAPI_SUCCESS && gated_result != PAPI_CONTINUED);
+    assert_eql(poker::APR_WORKERS_STOPPING, queued_when_stopping);
+    assert_eql(poker::APR_NO_COMPLETION, papi_poll_completion(&c, 0));
+    assert_eql(poker::APR_TASK_NOT_FOUND, papi_cancel(running));
+
+    // A callback can't stop the workers, which would wait for it
+    static PAPI_ERR stopped_from_callback;
+    assert_eql(PAPI_SUCCESS, papi_process_handshake_async(idle, (PAPI_MESSAGE)"x", 1, [](const PAPI_COMPLETION* c, void*) {
+        stopped_from_callback = papi_stop_workers();
+        PAPI_TASK next;
+        assert_eql(PAPI_SUCCESS, papi_process_bet_async(idle, (PAPI_MESSAGE)"x", 1, NULL, NULL, &next));
+    }, NULL, &running));
+    c = next_completion();
+    assert_eql(poker::APR_WORKER_THREAD, stopped_from_callback);
+    assert_eql(PAPI_SUCCESS, papi_delete_player(idle));
+#endif
+
+    assert_eql(PAPI_SUCCESS, papi_stop_workers());
+    assert_eql(PAPI_SUCCESS, papi_delete_player(alice));
+    assert_eql(PAPI_SUCCESS, papi_delete_player(bob));
+}
+
+void test_batches() {
+    PAPI_PLAYER alice, bob;
+    assert_eql(PAPI_SUCCESS, papi_new_player_with_options(0, false, -1, false, &alice));
+    assert_eql(PAPI_SUCCESS, papi_new_player_with_options(1, false, -1, false, &bob));
+    assert_eql(PAPI_SUCCESS, papi_init_player(alice, (PAPI_MONEY)"100", (PAPI_MONEY)"300", (PAPI_MONEY)"10"));
+    assert_eql(PAPI_SUCCESS, papi_init_player(bob, (PAPI_MONEY)"100", (PAPI_MONEY)"300", (PAPI_MONEY)"10"));
+
+    std::map<int, PAPI_MESSAGE> msg; // messages exchanged during game
+    std::map<int, PAPI_INT> len;
+    PAPI_INT type;
+    char amt[10];
+
+    assert_eql(PAPI_SUCCESS, papi_create_handshake(alice, &msg[0], &len[0]));
+    assert_eql(PAPI_CONTINUED, papi_process_handshake(bob, msg[0], len[0], &msg[1], &len[1]));
+    assert_eql(PAPI_CONTINUED, papi_process_handshake(alice, msg[1], len[1], &msg[2], &len[2]));
+    assert_eql(PAPI_CONTINUED, papi_process_handshake(bob, msg[2], len[2], &msg[3], &len[3]));
+    assert_eql(PAPI_SUCCESS, papi_process_handshake(alice, msg[3], len[3], &msg[4], &len[4]));
+    assert_eql(PAPI_SUCCESS, papi_process_handshake(bob, msg[4], len[4], &msg[5], &len[5]));
+
+    // Preflop: Alice calls, Bob checks
+    assert_eql(PAPI_SUCCESS, papi_create_bet(alice, poker::BET_CALL, (PAPI_MONEY)"0", &msg[5], &len[5]));
+    assert_eql(PAPI_SUCCESS, papi_process_bet(bob, msg[5], len[5], &msg[6], &len[6], &type, amt, sizeof(amt)));
+    assert_eql(PAPI_CONTINUED, papi_create_bet(bob, poker::BET_CHECK, (PAPI_MONEY)"0", &msg[6], &len[6]));
+    assert_eql(PAPI_SUCCESS, papi_process_bet(alice, msg[6], len[6], &msg[7], &len[7], &type, amt, sizeof(amt)));
+    assert_eql(PAPI_SUCCESS, papi_process_bet(bob, msg[7], len[7], &msg[8], &len[8], &type, amt, sizeof(amt)));
+
+    // Flop: Bob checks, Alice checks; Bob's turn proofs and his raise go in one frame
+    assert_eql(PAPI_SUCCESS, papi_create_bet(bob, poker::BET_CHECK, (PAPI_MONEY)"0", &msg[8], &len[8]));
+    assert_eql(PAPI_SUCCESS, papi_process_bet(alice, msg[8], len[8], &msg[9], &len[9], &type, amt, sizeof(amt)));
+    assert_eql(PAPI_CONTINUED, papi_create_bet(alice, poker::BET_CHECK, (PAPI_MONEY)"0", &msg[9], &len[9]));
+    assert_eql(PAPI_SUCCESS, papi_process_bet(bob, msg[9], len[9], &msg[10], &len[10], &type, amt, sizeof(amt)));
+    assert_eql(PAPI_SUCCESS, papi_create_bet(bob, poker::BET_RAISE, (PAPI_MONEY)"30", &msg[11], &len[11]));
+    assert_eql(PAPI_SUCCESS, papi_batch_messages(msg[10], len[10], msg[11], len[11], &msg[12], &len[12]));
+    assert_eql(PAPI_SUCCESS, papi_process_bet(alice, msg[12], len[12], &msg[13], &len[13], &type, amt, sizeof(amt)));
+    assert_eql(0, len[13]);
+    assert_eql(true, (int)type == (int)poker::BET_RAISE);
+    assert_eql(0, strcmp(amt, "30"));
+
+    // not a frame
+    assert_neq(PAPI_SUCCESS, papi_batch_messages(msg[10], 1, msg[11], len[11], &msg[14], &len[14]));
+    assert_eql(0, len[14]);
+
+    for(auto m: msg)
+      if (m.second)
+        assert_eql(PAPI_SUCCESS, papi_delete_message(m.second));
+
+    assert_eql(PAPI_SUCCESS, papi_delete_player(alice));
+    assert_eql(PAPI_SUCCESS, papi_delete_player(bob));
+}
+
+// a message and the ones it brings in return, until neither player answers
+static void deliver(PAPI_PLAYER* players, int to, PAPI_MESSAGE msg, PAPI_INT len) {
+    while (len) {
+        PAPI_MESSAGE out = NULL;
+        PAPI_INT out_len = 0, type;
+        char amt[10];
+        auto res = papi_process_bet(players[to], msg, len, &out, &out_len, &type, amt, sizeof(amt));
+        assert_eql(true, res == PAPI_SUCCESS || res == PAPI_CONTINUED);
+        assert_eql(PAPI_SUCCESS, papi_delete_message(msg));
+        msg = out;
+        len = out_len;
+        to = 1 - to;
+    }
+    if (msg)
+        assert_eql(PAPI_SUCCESS, papi_delete_message(msg));
+}
+
+void test_player_options() {
+    assert_eql(PAPI_SUCCESS, papi_init(true, true, -1));
+    PAPI_PLAYER players[2];
+    assert_eql(PAPI_SUCCESS, papi_new_player_with_options(0, false, poker::BOB, true, &players[poker::ALICE]));
+    assert_eql(PAPI_SUCCESS, papi_new_player_with_options(1, false, poker::BOB, true, &players[poker::BOB]));
+    // setting the library up again leaves the players' options alone
+    assert_eql(PAPI_SUCCESS, papi_init(true, true, poker::ALICE));
+    for (auto p : players)
+        assert_eql(PAPI_SUCCESS, papi_init_player(p, (PAPI_MONEY)"100", (PAPI_MONEY)"300", (PAPI_MONEY)"10"));
+
+    // the short handshake
+    PAPI_MESSAGE msg[5];
+    PAPI_INT len[5];
+    assert_eql(PAPI_SUCCESS, papi_create_handshake(players[poker::ALICE], &msg[0], &len[0]));
+    assert_eql(PAPI_CONTINUED, papi_process_handshake(players[poker::BOB], msg[0], len[0], &msg[1], &len[1]));
+    assert_eql(PAPI_CONTINUED, papi_process_handshake(players[poker::ALICE], msg[1], len[1], &msg[2], &len[2]));
+    assert_eql(PAPI_SUCCESS, papi_process_handshake(players[poker::BOB], msg[2], len[2], &msg[3], &len[3]));
+    assert_eql(PAPI_SUCCESS, papi_process_handshake(players[poker::ALICE], msg[3], len[3], &msg[4], &len[4]));
+    assert_eql(0, len[4]);
+    for (auto m : msg)
+        if (m)
+            assert_eql(PAPI_SUCCESS, papi_delete_message(m));
+
+    // checked down, the showdown goes to the players' winner
+    PAPI_GAME_STATE state;
+    for (;;) {
+        assert_eql(PAPI_SUCCESS, papi_get_game_state_bin(players[poker::ALICE], &state));
+        if (state.winner != -1)
+            break;
+        int p = state.current_player;
+        bool behind = memcmp(state.bets[p], state.bets[1 - p], PAPI_MONEY_BYTES) < 0;
+        PAPI_MESSAGE bet;
+        PAPI_INT bet_len;
+        auto res = papi_create_bet(players[p], behind ? poker::BET_CALL : poker::BET_CHECK, (PAPI_MONEY)"0", &bet, &bet_len);
+        assert_eql(true, res == PAPI_SUCCESS || res == PAPI_CONTINUED);
+        deliver(players, 1 - p, bet, bet_len);
+    }
+    assert_eql((int)poker::BOB, state.winner);
+
+    for (auto p : players)
+        assert_eql(PAPI_SUCCESS, papi_delete_player(p));
+}
+
+static void to_binary(unsigned v, unsigned char* dst) {
+    memset(dst, 0, PAPI_MONEY_BYTES);
+    for (int i = PAPI_MONEY_BYTES - 1; v; i--, v >>= 8)
+        dst[i] = v & 0xff;
+}
+
+void test_buffers() {
+    assert_eql(PAPI_SUCCESS, papi_init(true, true, -1));
+    PAPI_PLAYER alice, bob;
+    unsigned char alice_money[PAPI_MONEY_BYTES], bob_money[PAPI_MONEY_BYTES], big_blind[PAPI_MONEY_BYTES];
+    to_binary(100, alice_money);
+    to_binary(300, bob_money);
+    to_binary(10, big_blind);
+    assert_eql(PAPI_SUCCESS, papi_new_player(0, &alice));
+    assert_eql(PAPI_SUCCESS, papi_new_player(1, &bob));
+    assert_eql(PAPI_SUCCESS, papi_init_player_bin(alice, alice_money, bob_money, big_blind));
+    assert_eql(PAPI_SUCCESS, papi_init_player_bin(bob, alice_money, bob_money, big_blind));
+
+    // the size first, then the message kept
+    std::string msg, response;
+    PAPI_INT len;
+    assert_eql(poker::APR_NO_MESSAGE, papi_read_message(alice, NULL, 0, &len));
+    assert_eql(poker::APR_BUFFER_TOO_SMALL, papi_create_handshake_buf(alice, NULL, 0, &len));
+    assert_eql(true, len > 0);
+    msg.resize(len);
+    assert_eql(poker::APR_BUFFER_TOO_SMALL, papi_read_message(alice, &msg[0], len - 1, &len));
+    assert_eql(PAPI_SUCCESS, papi_read_message(alice, &msg[0], len, &len));
+    assert_eql(poker::APR_NO_MESSAGE, papi_read_message(alice, &msg[0], len, &len));
+
+    // then a buffer large enough for every message
+    PAPI_ERR expected[] = {PAPI_CONTINUED, PAPI_CONTINUED, PAPI_CONTINUED, PAPI_SUCCESS, PAPI_SUCCESS};
+    PAPI_PLAYER receiver = bob;
+    for (auto e : expected) {
+        response.resize(1 << 20);
+        assert_eql(e, papi_process_handshake_buf(receiver, &msg[0], (PAPI_INT)msg.size(), &response[0], (PAPI_INT)response.size(), &len));
+        msg.assign(response, 0, len);
+        receiver = receiver == bob ? alice : bob;
+    }
+    assert_eql(0, len);
+
+    // Preflop: Alice calls
+    unsigned char amt[PAPI_MONEY_BYTES];
+    to_binary(0, amt);
+    assert_eql(PAPI_SUCCESS, papi_create_bet_buf(alice, poker::BET_CALL, amt, &response[0], (PAPI_INT)response.size(), &len));
+    msg.assign(response, 0, len);
+    PAPI_INT type;
+    to_binary(1, amt);
+    assert_eql(PAPI_SUCCESS, papi_process_bet_buf(bob, &msg[0], (PAPI_INT)msg.size(), &response[0], (PAPI_INT)response.size(), &len, &type, amt));
+    assert_eql(true, (int)type == (int)poker::BET_CALL);
+    to_binary(0, alice_money);
+    assert_eql(0, memcmp(amt, alice_money, PAPI_MONEY_BYTES));
+
+    PAPI_GAME_STATE state;
+    assert_eql(PAPI_SUCCESS, papi_get_game_state_bin(bob, &state));
+    assert_eql((int)poker::PREFLOP_BET, state.step);
+    assert_eql(-1, state.winner);
+    assert_eql(300, state.total_funds[poker::BOB][PAPI_MONEY_BYTES - 1] + 256 * state.total_funds[poker::BOB][PAPI_MONEY_BYTES - 2]);
+    assert_eql(10, state.bets[poker::ALICE][PAPI_MONEY_BYTES - 1]);
+    assert_eql(10, state.big_blind[PAPI_MONEY_BYTES - 1]);
+    assert_eql(true, state.public_cards[0] == poker::cards::uk);
+    assert_eql(true, state.cards[poker::BOB][0] != poker::cards::uk);
+    assert_eql(true, state.cards[poker::ALICE][0] == poker::cards::uk);
+
+    // the move is made with a buffer too small, its message kept until read
+    to_binary(0, amt);
+    assert_eql(poker::APR_BUFFER_TOO_SMALL, papi_create_bet_buf(bob, poker::BET_CHECK, amt, NULL, 0, &len));
+    assert_eql(poker::APR_MESSAGE_PENDING, papi_create_bet_buf(bob, poker::BET_CHECK, amt, &response[0], (PAPI_INT)response.size(), &len));
+    assert_eql(0, len);
+    assert_eql(PAPI_CONTINUED, papi_read_message(bob, &response[0], (PAPI_INT)response.size(), &len));
+    assert_eql(true, len > 0);
+    msg.assign(response, 0, len);
+    assert_eql(PAPI_SUCCESS, papi_process_bet_buf(alice, &msg[0], (PAPI_INT)msg.size(), &response[0], (PAPI_INT)response.size(), &len, &type, amt));
+    assert_eql(true, len > 0);
+    assert_eql(poker::APR_NO_MESSAGE, papi_read_message(bob, &response[0], (PAPI_INT)response.size(), &len));
+
+    assert_eql(PAPI_SUCCESS, papi_delete_player(alice));
+    assert_eql(PAPI_SUCCESS, papi_delete_player(bob));
+}
+
 int main(int argc, char** argv) {
     test_the_happy_path();
+    test_batches();
+    test_async();
+    test_buffers();
+    test_player_options();
     std::cout << "---- SUCCESS" << std::endl;
     return 0;
 }
@@ -3,10 +3,16 @@
 #include <cstring>
 #include <cstdint>
 #include <vector>
+#include <random>
+#ifndef POKER_NO_POKER_EVAL
+#include <poker_defs.h>
+#include <inlines/eval.h>
+#endif
 
 #include "poker-lib.h"
 #include "common.h"
 #include "solver.h"
+#include "hand-evaluator.h"
 
 using namespace poker;
 using namespace poker::cards;
@@ -59,12 +65,8 @@ bool assert_hand_name(
   return true;
 }
 
-int main(int argc, char **argv) {
-  init_poker_lib();
-  solver sol;
-  failures = 0;
-  testCount = 0;
-  
+// hands of 5 to 7 cards, and others if the backend supports them
+void test_hands(bool any_size) {
   assert_compare_n(5, "5_NOPAIR_with_NOPAIR",   2, {c7, s6, c4, d3, h2}, {c8, s6, c4, d3, h2});
   assert_compare_n(5, "5_NOPAIR_with_PAIR",     2, {c7, s6, c4, d3, h2}, {d2, s6, c4, d3, h2});
   assert_compare_n(5, "5_PAIR_with_TWOPAIR",    1, {d2, h4, c4, d3, h2}, {d2, s6, c4, d3, h2});
@@ -85,10 +87,15 @@ int main(int argc, char **argv) {
   assert_compare_n(7, "7_FULLHOUSE_with_QUADS", 1, {s3, h3, c7, s6, c4, c3, d3}, {s7, d7, c7, s6, c4, c3, d3});
   assert_compare_n(7, "7_QUADS_with_STFLUSH",   2, {s3, h3, d7, d6, d4, c3, d3}, {d8, d5, d7, d6, d4, c3, d3});
   
-  assert_compare_n(4, "4_NOPAIR_with_NOPAIR",           2, {c7, s6, c4, d3}, {c3, s6, c4, d3});
+  if (any_size) {
+    assert_compare_n(4, "4_NOPAIR_with_NOPAIR",           2, {c7, s6, c4, d3}, {c3, s6, c4, d3});
+    assert_compare_n(8, "8_PAIR_with_NOPAIR",             1, {d2, hJ, h9, c7, s6, c4, d3, h2}, {sK, hA, dQ, c7, s6, c4, d3, h2});
+    assert_compare_n(4, "5_PAIR_with_NOPAIR_wrong_size",  2, {d2, hJ, h9, c7, s2}, {sK, hA, dQ, c7, s6});
+  } else {
+    assert_compare_n(4, "4_unsupported_size",             SRR_UNSUPPORTED_HAND_SIZE, {c7, s6, c4, d3}, {c3, s6, c4, d3});
+    assert_compare_n(8, "8_unsupported_size",             SRR_UNSUPPORTED_HAND_SIZE, {d2, hJ, h9, c7, s6, c4, d3, h2}, {sK, hA, dQ, c7, s6, c4, d3, h2});
+  }
   assert_compare_n(6, "6_NOPAIR_with_NOPAIR",           1, {s2, c7, s6, c4, d3, h2}, {c8, c7, s6, c4, d3, h2});
-  assert_compare_n(8, "8_PAIR_with_NOPAIR",             1, {d2, hJ, h9, c7, s6, c4, d3, h2}, {sK, hA, dQ, c7, s6, c4, d3, h2});
-  assert_compare_n(4, "5_PAIR_with_NOPAIR_wrong_size",  2, {d2, hJ, h9, c7, s2}, {sK, hA, dQ, c7, s6});
   assert_compare_n(7, "7_non_existing_card",            SRR_UNKNOWN_CARD, {s3, h3, uk, s6, c4, c3, d3}, {s7, d7, c7, s6, c4, c3, d3});
   assert_compare_n(7, "7_duplicate_card",               SRR_DUPLICATE_CARD, {d3, h3, c7, s6, c4, c3, d3}, {s7, d7, c7, s6, c4, c3, d3});
   assert_compare_n(7, "7_tie",                          0, {s3, h2, cJ, sT, c9, d3, h3}, {s4, c3, cJ, sT, c9, d3, h3});
@@ -102,7 +109,172 @@ int main(int argc, char **argv) {
   assert_hand_name(7, "hand_name_FULLHOUSE",  "FlHouse",  {s7, d7, c7, s6, c4, c3, d3});
   assert_hand_name(7, "hand_name_QUADS",      "Quads",    {s3, h3, c7, s6, c4, c3, d3});
   assert_hand_name(7, "hand_name_STFLUSH",    "StFlush",  {d8, d5, d7, d6, d4, c3, d3});
-  
+  assert_hand_name(5, "hand_name_WHEEL",      "Straight", {hA, d2, c3, s4, h5});
+  assert_hand_name(6, "hand_name_STFLUSH_6",  "StFlush",  {hA, hK, hQ, hJ, hT, d2});
+}
+
+static bool assert_batch(const char* name, const std::vector<uint64_t>& hands, const std::vector<unsigned short>& expected, const std::vector<unsigned short>& actual) {
+  testCount++;
+  for (size_t i = 0; i < hands.size(); i++) {
+    if (expected[i] != actual[i]) {
+      printf("assertion failed - %s - hand %lx, expected %d, actual %d\n", name, (unsigned long)hands[i], expected[i], actual[i]);
+      failures++;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Batches of card masks, rated like single hands by both implementations
+void test_batch() {
+  std::mt19937 rng(1);
+  std::vector<uint64_t> hands;
+  std::vector<unsigned short> expected;
+  card_t deck[52];
+  for (int c = 0; c < 52; c++)
+    deck[c] = c;
+  // a length that leaves a partial block
+  for (int i = 0; i < 10003; i++) {
+    for (int j = 0; j < 7; j++)
+      std::swap(deck[j], deck[j + rng() % (52 - j)]);
+    hands.push_back(hand_mask(deck, 7));
+    expected.push_back(evaluate_hand(deck, 7));
+  }
+
+  std::vector<unsigned short> ratings(hands.size());
+  evaluate_hands_scalar(hands.data(), hands.size(), ratings.data());
+  assert_batch("batch_scalar", hands, expected, ratings);
+  ratings.assign(hands.size(), 0);
+  if (evaluate_hands_avx2(hands.data(), hands.size(), ratings.data()))
+    assert_batch("batch_avx2", hands, expected, ratings);
+  else
+    printf("AVX2 not available\n");
+  ratings.assign(hands.size(), 0);
+  testCount++;
+  if (evaluate_hands(hands.data(), hands.size(), ratings.data()) != SUCCESS) {
+    printf("assertion failed - batch - evaluate_hands failed\n");
+    failures++;
+  }
+  assert_batch("batch", hands, expected, ratings);
+
+  uint64_t six[] = { hand_mask(std::vector<int>({c7, s6, c4, d3, h2, hA}).data(), 6) };
+  uint64_t beyond[] = { hand_mask(std::vector<int>({c7, s6, c4, d3, h2, hA}).data(), 6) | (1ULL << 52) };
+  unsigned short rating;
+  testCount += 2;
+  if (evaluate_hands(six, 1, &rating) != SRR_UNSUPPORTED_HAND_SIZE) {
+    printf("assertion failed - batch_six_cards\n");
+    failures++;
+  }
+  if (evaluate_hands(beyond, 1, &rating) != SRR_UNKNOWN_CARD) {
+    printf("assertion failed - batch_unknown_card\n");
+    failures++;
+  }
+}
+
+#ifndef POKER_NO_POKER_EVAL
+const int cross_check_samples = 200000;
+
+struct cross_check_state {
+  int n;
+  card_t hand[7];
+  CardMask mask;
+  std::vector<int> eval_of_rating;  // poker-eval value of each rating
+  long hands;
+  long mismatches;
+};
+
+static void check_hand(cross_check_state& s) {
+  int value = StdDeck_StdRules_EVAL_N(s.mask, s.n);
+  int rating = evaluate_hand(s.hand, s.n);
+  s.hands++;
+  auto& e = s.eval_of_rating[rating];
+  if (!rating || (e != -1 && e != value))
+    s.mismatches++;
+  e = value;
+}
+
+static void cross_check_hands(cross_check_state& s, int depth, int first) {
+  if (depth == s.n) {
+    check_hand(s);
+    return;
+  }
+  for (int c = first; c <= 52 - (s.n - depth); c++) {
+    CardMask saved = s.mask;
+    s.hand[depth] = c;
+    CardMask_SET(s.mask, c);
+    cross_check_hands(s, depth + 1, c + 1);
+    s.mask = saved;
+  }
+}
+
+static void sample_hands(cross_check_state& s, int samples) {
+  std::mt19937 rng(s.n);
+  card_t deck[52];
+  for (int c = 0; c < 52; c++)
+    deck[c] = c;
+  for (int i = 0; i < samples; i++) {
+    CardMask_RESET(s.mask);
+    for (int j = 0; j < s.n; j++) {
+      std::swap(deck[j], deck[j + rng() % (52 - j)]);
+      s.hand[j] = deck[j];
+      CardMask_SET(s.mask, deck[j]);
+    }
+    check_hand(s);
+  }
+}
+
+// Hands of n cards, every one or random samples: both backends must agree on
+// which hands are equal and on their order. Hands of a rating must have a
+// single poker-eval value, increasing with the rating
+void cross_check(int n, int samples) {
+  testCount++;
+  cross_check_state s;
+  s.n = n;
+  CardMask_RESET(s.mask);
+  s.eval_of_rating.assign(7463, -1);
+  s.hands = 0;
+  s.mismatches = 0;
+  if (samples)
+    sample_hands(s, samples);
+  else
+    cross_check_hands(s, 0, 0);
+
+  int previous = -1, classes = 0;
+  for (auto value : s.eval_of_rating) {
+    if (value == -1)
+      continue;
+    if (value <= previous)
+      s.mismatches++;
+    previous = value;
+    classes++;
+  }
+  printf("cross-checked %ld hands of %d cards, %d classes\n", s.hands, n, classes);
+  if (s.mismatches) {
+    printf("assertion failed - cross_check_%d - %ld mismatches\n", n, s.mismatches);
+    failures++;
+  }
+}
+#endif
+
+int main(int argc, char **argv) {
+  init_poker_lib();
+  failures = 0;
+  testCount = 0;
+
+  if (get_solver_backend() == SOLVER_POKER_EVAL)
+    test_hands(true);
+  set_solver_backend(SOLVER_HAND_TABLES);
+  test_hands(false);
+  test_batch();
+
+#ifndef POKER_NO_POKER_EVAL
+  // every hand with --exhaustive (make check-hand-tables), a sample otherwise
+  int samples = argc > 1 && !strcmp(argv[1], "--exhaustive") ? 0 : cross_check_samples;
+  cross_check(5, samples);
+  cross_check(6, samples);
+  cross_check(7, samples);
+#endif
+
   printf("Executed %d tests, with %d failures.\n.", testCount, std::abs(failures));
 
   return failures ? 1 : 0;
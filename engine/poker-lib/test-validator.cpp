@@ -20,6 +20,18 @@ using namespace poker::cards;
 #define BOB_FUNDS(f) f.bob[0]
 #define BOB_BETS(f) f.bob[1]
 
+static money_t sum(const money_t& x, const money_t& y) {
+    money_t s;
+    assert_eql(true, checked_add(x, y, s));
+    return s;
+}
+
+static money_t difference(const money_t& x, const money_t& y) {
+    money_t d;
+    assert_eql(true, checked_sub(x, y, d));
+    return d;
+}
+
 struct card_fixture {
     vector<card_t> alice, bob, community;
 };
@@ -41,6 +53,7 @@ struct bet_fixtures {
     bet_fixture alice_higher_bet_bob_no_funds{{100, 20}, {10, 10}};
     bet_fixture bob_higher_bet{{100, 10}, {100, 20}};
     bet_fixture first_action{{100, 5}, {100, 10}};
+    bet_fixture alice_all_in{{100, 100}, {200, 10}};
 } bf;
 
 void setup_cards(game_state &g, card_fixture cards) {
@@ -105,8 +118,8 @@ int main(int argc, char **argv) {
     assert_eql(ALICE, g.winner);
     assert_eql(PHS_GAME_OVER, g.phase);
     assert_eql(NONE, g.current_player);
-    assert_eql(g.funds_share[ALICE], ALICE_FUNDS(bf.equal_bets) + BOB_BETS(bf.equal_bets));
-    assert_eql(g.funds_share[BOB], BOB_FUNDS(bf.equal_bets) - BOB_BETS(bf.equal_bets));
+    assert_eql(g.funds_share[ALICE], sum(ALICE_FUNDS(bf.equal_bets), BOB_BETS(bf.equal_bets)));
+    assert_eql(g.funds_share[BOB], difference(BOB_FUNDS(bf.equal_bets), BOB_BETS(bf.equal_bets)));
 
     // Given BOB's hand is better
     // When deciding winner
@@ -120,8 +133,8 @@ int main(int argc, char **argv) {
     assert_eql(BOB, g.winner);
     assert_eql(PHS_GAME_OVER, g.phase);
     assert_eql(NONE, g.current_player);
-    assert_eql(g.funds_share[ALICE], ALICE_FUNDS(bf.equal_bets) - ALICE_BETS(bf.equal_bets));
-    assert_eql(g.funds_share[BOB], BOB_FUNDS(bf.equal_bets) + ALICE_BETS(bf.equal_bets));
+    assert_eql(g.funds_share[ALICE], difference(ALICE_FUNDS(bf.equal_bets), ALICE_BETS(bf.equal_bets)));
+    assert_eql(g.funds_share[BOB], sum(BOB_FUNDS(bf.equal_bets), ALICE_BETS(bf.equal_bets)));
 
     // Given ALICE's and BOB's hands are the same
     // When deciding winner
@@ -179,8 +192,8 @@ int main(int argc, char **argv) {
     assert_eql(BOB, g.winner);
     assert_eql(PHS_GAME_OVER, g.phase);
     assert_eql(NONE, g.current_player);
-    assert_eql(g.funds_share[ALICE], ALICE_FUNDS(bf.first_action) - ALICE_BETS(bf.first_action));
-    assert_eql(g.funds_share[BOB], BOB_FUNDS(bf.first_action) + ALICE_BETS(bf.first_action));
+    assert_eql(g.funds_share[ALICE], difference(ALICE_FUNDS(bf.first_action), ALICE_BETS(bf.first_action)));
+    assert_eql(g.funds_share[BOB], sum(BOB_FUNDS(bf.first_action), ALICE_BETS(bf.first_action)));
 
     // Given BOB's bet is higher and ALICE already called the big blind
     // When ALICE calls
@@ -194,6 +207,29 @@ int main(int argc, char **argv) {
     assert_eql(PHS_FLOP, g.phase);
     assert_eql(BOB, g.current_player);
 
+    // Given ALICE is all in
+    // When BOB calls
+    // Game advances to SHOWDOWN
+    // And nobody is the current player
+    set_state(PHS_PREFLOP, BOB, bf.alice_all_in);
+
+    err = place_bet(g, BET_CALL);
+
+    assert_eql(SUCCESS, err);
+    assert_eql(PHS_SHOWDOWN, g.phase);
+    assert_eql(NONE, g.current_player);
+
+    // Given ALICE is all in in a game played before the runout
+    // When BOB calls
+    // Game advances to FLOP
+    set_state(PHS_PREFLOP, BOB, bf.alice_all_in);
+    g.version = min_poker_version;
+
+    err = place_bet(g, BET_CALL);
+
+    assert_eql(SUCCESS, err);
+    assert_eql(PHS_FLOP, g.phase);
+
     /**
      *
      * After PREFLOP
@@ -245,8 +281,8 @@ int main(int argc, char **argv) {
     assert_eql(ALICE, g.winner);
     assert_eql(PHS_GAME_OVER, g.phase);
     assert_eql(NONE, g.current_player);
-    assert_eql(g.funds_share[ALICE], ALICE_FUNDS(bf.equal_bets) + BOB_BETS(bf.equal_bets));
-    assert_eql(g.funds_share[BOB], BOB_FUNDS(bf.equal_bets) - BOB_BETS(bf.equal_bets));
+    assert_eql(g.funds_share[ALICE], sum(ALICE_FUNDS(bf.equal_bets), BOB_BETS(bf.equal_bets)));
+    assert_eql(g.funds_share[BOB], difference(BOB_FUNDS(bf.equal_bets), BOB_BETS(bf.equal_bets)));
 
     // Given bets are equal
     // When ALICE checks
@@ -293,6 +329,17 @@ int main(int argc, char **argv) {
     assert_eql(PHS_TURN, g.phase);
     assert_eql(BOB, g.current_player);
 
+    // Given ALICE is all in
+    // When BOB calls
+    // Game advances to SHOWDOWN, skipping TURN and RIVER
+    set_state(PHS_FLOP, BOB, bf.alice_all_in);
+
+    err = place_bet(g, BET_CALL);
+
+    assert_eql(SUCCESS, err);
+    assert_eql(PHS_SHOWDOWN, g.phase);
+    assert_eql(NONE, g.current_player);
+
     // Given ALICE's bet is higher
     // When BOB raises
     // Game remains in FLOP
@@ -326,8 +373,8 @@ int main(int argc, char **argv) {
     assert_eql(ALICE, g.winner);
     assert_eql(PHS_GAME_OVER, g.phase);
     assert_eql(NONE, g.current_player);
-    assert_eql(g.funds_share[ALICE], ALICE_FUNDS(bf.alice_higher_bet) + BOB_BETS(bf.alice_higher_bet));
-    assert_eql(g.funds_share[BOB], BOB_FUNDS(bf.alice_higher_bet) - BOB_BETS(bf.alice_higher_bet));
+    assert_eql(g.funds_share[ALICE], sum(ALICE_FUNDS(bf.alice_higher_bet), BOB_BETS(bf.alice_higher_bet)));
+    assert_eql(g.funds_share[BOB], difference(BOB_FUNDS(bf.alice_higher_bet), BOB_BETS(bf.alice_higher_bet)));
 
     // Given ALICE's bet is higher and BOB doesn't have funds
     // When BOB calls
@@ -390,8 +437,8 @@ int main(int argc, char **argv) {
     assert_eql(ALICE, g.winner);
     assert_eql(PHS_GAME_OVER, g.phase);
     assert_eql(NONE, g.current_player);
-    assert_eql(g.funds_share[ALICE], ALICE_FUNDS(bf.bob_higher_bet) + BOB_BETS(bf.bob_higher_bet));
-    assert_eql(g.funds_share[BOB], BOB_FUNDS(bf.bob_higher_bet) - BOB_BETS(bf.bob_higher_bet));
+    assert_eql(g.funds_share[ALICE], sum(ALICE_FUNDS(bf.bob_higher_bet), BOB_BETS(bf.bob_higher_bet)));
+    assert_eql(g.funds_share[BOB], difference(BOB_FUNDS(bf.bob_higher_bet), BOB_BETS(bf.bob_higher_bet)));
 
     cout << "---- SUCCESS - " TEST_SUITE_NAME << endl;
     return 0;
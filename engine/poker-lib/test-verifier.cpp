@@ -3,11 +3,16 @@
 #include <fstream>
 #include <memory.h>
 #include <inttypes.h>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
 #include "poker-lib.h"
 #include "common.h"
 #include "test-util.h"
 #include "game-generator.h"
 #include "verifier.h"
+#include "verification-cache.h"
 
 using namespace poker;
 
@@ -31,7 +36,7 @@ void test_the_happy_path() {
     std::istringstream is(output.str());
     assert_eql(128, output.str().size());
 
-    bignumber filler, funds1, funds2;
+    money_t filler, funds1, funds2;
     assert_eql(SUCCESS, funds1.read_binary_be(is, 32));
     assert_eql(SUCCESS, funds2.read_binary_be(is, 32));
     assert_eql(SUCCESS, filler.read_binary_be(is, 64));
@@ -43,16 +48,117 @@ void test_the_happy_path() {
     std::cout << output.str() << std::endl;
 }
 
+void test_batched_turns() {
+    game_generator gen;
+    gen.batch_turns = true;
+    assert_eql(SUCCESS, gen.generate());
+    for (size_t i = 1; i < gen.turns.size(); i++)
+        assert_neq(std::get<0>(gen.turns[i-1]), std::get<0>(gen.turns[i]));
+
+    std::istringstream turns(gen.raw_turn_data);
+    std::istringstream turns_meta(gen.raw_turn_metadata);
+    std::istringstream player_info(gen.raw_player_info);
+    std::istringstream  verification_info(gen.raw_verification_info);
+
+    std::ostringstream output;
+    verifier ver(player_info, turns_meta, verification_info, turns, output);
+    assert_eql(SUCCESS, ver.verify());
+    assert_eql(gen.alice_game.winner, ver.game().winner);
+    assert_eql(SUCCESS, ver.game().error);
+}
+
+// overwrites the stake declared for a turn in the raw turn metadata
+static void corrupt_stake(std::string& metadata, int turn_count, int turn) {
+    std::ostringstream os;
+    money_t(12345).write_binary_be(os, 32);
+    metadata.replace(4 + 40*turn_count + 32*turn, 32, os.str());
+}
+
+void test_structural_decision() {
+    game_generator gen;
+    assert_eql(SUCCESS, gen.generate());
+    int turn_count = gen.turns.size();
+
+    // first turn rejected before any crypto is checked: decided by the pre-pass
+    auto metadata = gen.raw_turn_metadata;
+    corrupt_stake(metadata, turn_count, 0);
+    {
+        std::istringstream turns(gen.raw_turn_data);
+        std::istringstream turns_meta(metadata);
+        std::istringstream player_info(gen.raw_player_info);
+        std::istringstream verification_info(gen.raw_verification_info);
+        std::ostringstream output;
+        verifier ver(player_info, turns_meta, verification_info, turns, output);
+        assert_eql(SUCCESS, ver.verify());
+        assert_eql(true, ver.decided_structurally());
+        assert_eql(RULE_STAKE_MISMATCH, ver.applied_rule());
+        assert_eql(money_t(0), ver.results()[ALICE]);
+    }
+
+    // last turn rejected after both players sent proofs: needs the full playback
+    metadata = gen.raw_turn_metadata;
+    corrupt_stake(metadata, turn_count, turn_count - 1);
+    {
+        std::istringstream turns(gen.raw_turn_data);
+        std::istringstream turns_meta(metadata);
+        std::istringstream player_info(gen.raw_player_info);
+        std::istringstream verification_info(gen.raw_verification_info);
+        std::ostringstream output;
+        verifier ver(player_info, turns_meta, verification_info, turns, output);
+        assert_eql(SUCCESS, ver.verify());
+        assert_eql(false, ver.decided_structurally());
+        assert_eql(RULE_STAKE_MISMATCH, ver.applied_rule());
+    }
+}
+
+static char cache_dir[] = "/tmp/test-verifier-XXXXXX";
+
+// at exit, so that a failed assertion doesn't leave a cache for the next run
+static void remove_cache_dir() {
+    DIR* dir = opendir(cache_dir);
+    if (!dir)
+        return;
+    while (auto entry = readdir(dir))
+        if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, ".."))
+            unlink((std::string(cache_dir) + "/" + entry->d_name).c_str());
+    closedir(dir);
+    rmdir(cache_dir);
+}
+
+void test_verification_cache() {
+    game_generator gen;
+    assert_eql(SUCCESS, gen.generate());
+    assert_eql(true, mkdtemp(cache_dir) != NULL);
+    atexit(remove_cache_dir);
+    set_verification_cache(cache_dir);
+
+    std::string results[2];
+    for (int i = 0; i < 2; i++) {
+        std::istringstream turns(gen.raw_turn_data);
+        std::istringstream turns_meta(gen.raw_turn_metadata);
+        std::istringstream player_info(gen.raw_player_info);
+        std::istringstream verification_info(gen.raw_verification_info);
+        std::ostringstream output;
+        verifier ver(player_info, turns_meta, verification_info, turns, output);
+        assert_eql(SUCCESS, ver.verify());
+        assert_eql(i == 1, ver.proofs_cached());
+        assert_eql(gen.alice_game.winner, ver.game().winner);
+        results[i] = output.str();
+    }
+    assert_eql(results[0], results[1]);
+    set_verification_cache("");
+}
+
 void test_punish() {
     verification_results_t funds{ 100, 200 };
-    verifier::punish(ALICE, funds);
-    assert_eql(0,   (int)funds[ALICE]);
-    assert_eql(300, (int)funds[BOB]);
+    assert_eql(SUCCESS, verifier::punish(ALICE, funds));
+    assert_eql(0,   funds[ALICE]);
+    assert_eql(300, funds[BOB]);
 
     funds = { 100, 200 };
-    verifier::punish(BOB, funds);
-    assert_eql(300,   (int)funds[ALICE]);
-    assert_eql(0,   (int)funds[BOB]);
+    assert_eql(SUCCESS, verifier::punish(BOB, funds));
+    assert_eql(300,   funds[ALICE]);
+    assert_eql(0,   funds[BOB]);
 
 }
 
@@ -95,8 +201,8 @@ void test_compute_result() {
                        player_info_t{ bob_addr,   200} }
     ));
     assert_eql(RULE_NO_CLAIMER, applied_rule);
-    assert_eql(bignumber(0), out_results[ALICE]);
-    assert_eql(bignumber(300), out_results[BOB]);    
+    assert_eql(money_t(0), out_results[ALICE]);
+    assert_eql(money_t(300), out_results[BOB]);    
 
     // 2 -- game over, Alice wins, Bob challenges, no claimer  => punish challenger
     out_results = {0, 0};
@@ -118,8 +224,8 @@ void test_compute_result() {
                        player_info_t{ bob_addr,   200} }
     ));
     assert_eql(RULE_NO_CLAIMER, applied_rule);
-    assert_eql(bignumber(300), out_results[ALICE]);
-    assert_eql(bignumber(0), out_results[BOB]);    
+    assert_eql(money_t(300), out_results[ALICE]);
+    assert_eql(money_t(0), out_results[BOB]);    
 
     // 3 -- game over, Alice wins, Bob challenges, Alice claims claimed results match => punish challenger
     out_results = {0, 0};
@@ -142,8 +248,8 @@ void test_compute_result() {
     ));
 
     assert_eql(RULE_CLAIM_IS_TRUE, applied_rule);
-    assert_eql(bignumber(300), out_results[ALICE]);
-    assert_eql(bignumber(0), out_results[BOB]);    
+    assert_eql(money_t(300), out_results[ALICE]);
+    assert_eql(money_t(0), out_results[BOB]);    
 
     // 4 -- game over, Alice wins, Bob challenges, Alice claims claimed results don't match => punish claimer
     out_results = {0, 0};
@@ -164,8 +270,8 @@ void test_compute_result() {
                        player_info_t{ bob_addr,   200} }
     ));
     assert_eql(RULE_CLAIM_IS_FALSE, applied_rule);
-    assert_eql(bignumber(0), out_results[ALICE]);
-    assert_eql(bignumber(300), out_results[BOB]);    
+    assert_eql(money_t(0), out_results[ALICE]);
+    assert_eql(money_t(300), out_results[BOB]);    
 
     // 5 -- game is not over, no error, Alice challenges => punish Alice
     out_results = {0, 0};
@@ -186,8 +292,8 @@ void test_compute_result() {
                        player_info_t{ bob_addr,   200} }
     ));
     assert_eql(RULE_GAME_IS_NOT_OVER, applied_rule);
-    assert_eql(bignumber(0), out_results[ALICE]);
-    assert_eql(bignumber(300), out_results[BOB]);    
+    assert_eql(money_t(0), out_results[ALICE]);
+    assert_eql(money_t(300), out_results[BOB]);    
 
     // 6 -- playback failed, Bob is owner of last msg => punish Bob
     out_results = {0, 0};
@@ -208,8 +314,8 @@ void test_compute_result() {
                        player_info_t{ bob_addr,   200} }
     ));
     assert_eql(RULE_PLAYBACK_FAILED, applied_rule);
-    assert_eql(bignumber(300), out_results[ALICE]);
-    assert_eql(bignumber(0), out_results[BOB]);    
+    assert_eql(money_t(300), out_results[ALICE]);
+    assert_eql(money_t(0), out_results[BOB]);    
 
 
     // 7 -- turn author (ALICE) disagrees with metadata
@@ -231,8 +337,8 @@ void test_compute_result() {
                        player_info_t{ bob_addr,   200} }
     ));
     assert_eql(RULE_TURN_PLAYER_MISMATCH, applied_rule);
-    assert_eql(bignumber(300), out_results[ALICE]);
-    assert_eql(bignumber(0), out_results[BOB]);    
+    assert_eql(money_t(300), out_results[ALICE]);
+    assert_eql(money_t(0), out_results[BOB]);    
 
     // 8 -- turn stake disagrees with metadata
     out_results = {0, 0};
@@ -253,8 +359,8 @@ void test_compute_result() {
                        player_info_t{ bob_addr,   200} }
     ));
     assert_eql(RULE_STAKE_MISMATCH, applied_rule);
-    assert_eql(bignumber(300), out_results[BOB]);
-    assert_eql(bignumber(0), out_results[ALICE]);
+    assert_eql(money_t(300), out_results[BOB]);
+    assert_eql(money_t(0), out_results[ALICE]);
 
     // 9 - there is no metadata available for the current turn
     out_results = {0, 0};
@@ -275,14 +381,17 @@ void test_compute_result() {
                        player_info_t{ bob_addr,   200} }
     ));
     assert_eql(RULE_TURN_METADATA_MISSING, applied_rule);
-    assert_eql(bignumber(300), out_results[BOB]);
-    assert_eql(bignumber(0), out_results[ALICE]);
+    assert_eql(money_t(300), out_results[BOB]);
+    assert_eql(money_t(0), out_results[ALICE]);
   }
 
 int main(int argc, char** argv) {
     init_poker_lib();
 
     test_the_happy_path();
+    test_batched_turns();
+    test_structural_decision();
+    test_verification_cache();
     test_punish();
     test_compute_result();
 
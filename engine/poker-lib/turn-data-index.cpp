@@ -0,0 +1,91 @@
+#include "turn-data-index.h"
+
+#include <sstream>
+
+#include "compression.h"
+#include "streams.h"
+
+namespace poker {
+
+// a batch frame starts with the 32-bit length of its first message
+static const size_t batch_length_size = 4;
+// "#type|#version|#player_id|" with room to spare
+static const size_t message_prefix_size = 64;
+
+static game_error read_prefix(const std::string& compressed, frame_info& f) {
+    game_error res;
+    std::string prefix;
+    if ((res = decompress_prefix(compressed, prefix, message_prefix_size + batch_length_size, f.dictionary)))
+        return res;
+    std::istringstream is(prefix.substr(f.batch ? batch_length_size : 0));
+    decoder in(is);
+    int version;
+    if ((res = in.read(f.type)) || (res = in.read(version)) || (res = in.read(f.player_id)))
+        return res;
+    return SUCCESS;
+}
+
+static game_step step_of(message_type type, int card_proofs) {
+    switch (type) {
+        case MSG_VTMF:
+            return INIT_GAME;
+        case MSG_VTMF_RESPONSE:
+            return LOAD_KEYS;
+        case MSG_VSSHE:
+            return VSSHE_GROUP;
+        case MSG_VSSHE_RESPONSE:
+            return BOB_MIX;
+        case MSG_BOB_PRIVATE_CARDS:
+            return OPEN_PRIVATE_CARDS;
+        case MSG_SHORT_VTMF:
+            return INIT_GAME;
+        case MSG_SHORT_VTMF_RESPONSE:
+            return LOAD_KEYS;
+        case MSG_ALICE_MIX:
+            return ALICE_LAST_MIX;
+        case MSG_ALICE_PRIVATE_CARDS:
+            return OPEN_PRIVATE_CARDS;
+        case MSG_BET_REQUEST:
+            return (game_step)std::min(PREFLOP_BET + 2 * card_proofs, (int)RIVER_BET);
+        default:
+            return (game_step)std::min(OPEN_FLOP + 2 * card_proofs, (int)SHOWDOWN);
+    }
+}
+
+game_error turn_data_index::build(std::istream& logfile) {
+    game_error res;
+    _frames.clear();
+    int card_proofs = 0;
+    while (true) {
+        frame_info f;
+        std::string compressed;
+        f.offset = logfile.rdbuf()->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+        if (f.offset < 0)
+            return CPR_READ_ERROR;
+        res = unwrap_next(logfile, compressed, f.dictionary, f.batch);
+        if (res == END_OF_STREAM || (!res && compressed.empty()))
+            return SUCCESS;
+        if (res || (res = read_prefix(compressed, f)))
+            return res;
+        f.next = logfile.rdbuf()->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+        f.step = step_of(f.type, card_proofs);
+        if (f.type == MSG_CARD_PROOF)
+            card_proofs++;
+        _frames.push_back(f);
+    }
+}
+
+game_error turn_data_index::build(const char* data, size_t size) {
+    memory_streambuf buf(data, size);
+    std::istream is(&buf);
+    return build(is);
+}
+
+int turn_data_index::find(game_step step) const {
+    for (size_t i = 0; i < _frames.size(); i++)
+        if (_frames[i].step == step)
+            return (int)i;
+    return -1;
+}
+
+}  // namespace poker
@@ -0,0 +1,47 @@
+#ifndef TURN_DATA_INDEX_H
+#define TURN_DATA_INDEX_H
+
+#include <istream>
+#include <vector>
+
+#include "common.h"
+#include "codec.h"
+
+namespace poker {
+
+struct frame_info {
+    std::streamoff offset;  // of the frame header
+    std::streamoff next;    // of the following frame, past any padding
+    int dictionary;
+    bool batch;
+    message_type type;      // of the (first) message
+    int player_id;          // author of the frame
+    game_step step;         // referee step the frame is played back in
+};
+
+/*
+ * Offsets, authors and message types of the frames of a turn data log.
+ * Building it reads the frame headers and decompresses only the first bytes
+ * of each payload, enough for the message type and author. Steps follow from
+ * the order of the message types: bets belong to the round opened by the
+ * card proofs before them. The card proof of an all-in runout is labelled
+ * by that order too, although the referee plays it back in the showdown.
+ */
+class turn_data_index {
+    std::vector<frame_info> _frames;
+
+public:
+    // the log must be seekable; it ends with the data or with an empty frame
+    game_error build(std::istream& logfile);
+    // over memory, e.g. a mapped_file
+    game_error build(const char* data, size_t size);
+
+    size_t size() const { return _frames.size(); }
+    const frame_info& operator[](size_t frame) const { return _frames[frame]; }
+    // first frame played back in step, -1 if none
+    int find(game_step step) const;
+};
+
+}  // namespace poker
+
+#endif
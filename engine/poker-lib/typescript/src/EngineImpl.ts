@@ -1,5 +1,5 @@
 import { BigNumber } from "ethers";
-import { Engine, EngineBetType, EngineResult, EngineState, StatusCode } from "./Engine";
+import { Engine, EngineBetType, EngineEquity, EngineResult, EngineState, EquityOptions, StatusCode } from "./Engine";
 
 export class EngineImpl implements Engine {
     _player: number; //Player* address in C++ memory
@@ -105,6 +105,28 @@ export class EngineImpl implements Engine {
         });
     }
 
+    async save(): Promise<Uint8Array> {
+        return this._callWorker("player_save", makeMessage(this._player), (results) => {
+            return parseInt(results[0]) == StatusCode.SUCCESS ? results[1] : null;
+        });
+    }
+
+    // restores a snapshot taken by save(), on an engine set up with init()
+    async load(snapshot: Uint8Array): Promise<EngineResult> {
+        return this._callWorker("player_load", makeMessage(this._player, snapshot), (results) => {
+            return { status: parseInt(results[0]) };
+        });
+    }
+
+    // single threaded in the worker: options.threads is ignored
+    async equity(options: EquityOptions = {}): Promise<EngineEquity> {
+        const { maxSamples = 1000000, precision = 0.001, seed = 1 } = options;
+        return this._callWorker("player_equity", makeMessage(this._player, maxSamples, String(precision), seed), (results) => {
+            const status = parseInt(results[0]);
+            return status == StatusCode.SUCCESS ? { status, ...JSON.parse(parseString(results[1])) } : { status };
+        });
+    }
+
     on_game_over(): void {
        this._callWorker("poker_delete_player", makeMessage(this._player), {});
     }
@@ -1,4 +1,5 @@
 #include "unencrypted_participant.h"
+#include "codec.h"
 
 #include <algorithm>
 #include <chrono>
@@ -171,4 +172,44 @@ size_t unencrypted_participant::get_open_card(int card_index) {
     return card_type;
 }
 
+static game_error save_cards(encoder& e, const std::vector<int>& cards) {
+    game_error res;
+    if ((res = e.write((int)cards.size())))
+        return res;
+    for (auto c : cards)
+        if ((res = e.write(c)))
+            return res;
+    return SUCCESS;
+}
+
+static game_error load_cards(decoder& d, std::vector<int>& cards) {
+    game_error res;
+    int count;
+    if ((res = d.read(count)))
+        return res;
+    if (count < 0 || count > DECK_SIZE)
+        return TMC_INVALID_STATE;
+    cards.resize(count);
+    for (auto& c : cards)
+        if ((res = d.read(c)))
+            return res;
+    return SUCCESS;
+}
+
+game_error unencrypted_participant::save(std::ostream& out) {
+    game_error res;
+    encoder e(out);
+    if ((res = e.write(_winner)) || (res = save_cards(e, _stack)) || (res = save_cards(e, _cards)))
+        return res;
+    return SUCCESS;
+}
+
+game_error unencrypted_participant::load(std::istream& in) {
+    game_error res;
+    decoder d(in);
+    if ((res = d.read(_winner)) || (res = load_cards(d, _stack)) || (res = load_cards(d, _cards)))
+        return res;
+    return SUCCESS;
+}
+
 }  // namespace poker
@@ -50,6 +50,9 @@ class unencrypted_participant : public i_participant {
     game_error verify_card_secret(int card_index, blob& their_proof) override;
     game_error open_card(int card_index) override;
     size_t get_open_card(int card_index) override;
+
+    game_error save(std::ostream& out) override;
+    game_error load(std::istream& in) override;
 };
 
 }  // namespace poker
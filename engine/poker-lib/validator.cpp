@@ -41,8 +41,8 @@ game_error place_bet(game_state& g, bet_type type, money_t amt) {
 static game_error call(game_state& g) {
     player_state& player = g.players[g.current_player];
     player_state& opponent = g.players[opponent_id(player.id)];
-    money_t difference = opponent.bets - player.bets;
-    if (difference <= (money_t)0)
+    money_t difference;
+    if (!checked_sub(opponent.bets, player.bets, difference) || difference == 0)
         return (g.error = GRR_OPPONENT_BET_NOT_HIGHER);
     if ((g.error = bet(g, difference)) != SUCCESS)
         return g.error;
@@ -65,19 +65,22 @@ static game_error call(game_state& g) {
 static game_error raise(game_state& g, money_t amount) {
     player_state& player = g.players[g.current_player];
     player_state& opponent = g.players[opponent_id(player.id)];
-    money_t last_raise = opponent.bets - player.bets;
+    money_t last_raise;
 
-    if (player.bets > opponent.bets)
+    if (!checked_sub(opponent.bets, player.bets, last_raise))
         return (g.error = GRR_BET_ALREADY_HIGHER);
 
     // TODO: restore this code when the UI code is able to deal with this logic
     // if (amount < g.big_blind)
     //     return (g.error = GRR_BET_BELOW_MINIMUM);
 
-    if ((opponent.bets + amount) > opponent.total_funds)
+    money_t opponent_bets, total;
+    if (!checked_add(opponent.bets, amount, opponent_bets) || opponent_bets > opponent.total_funds)
         return (g.error = GRR_BET_ABOVE_MAXIMUM);  // max bet is to force all in
 
-    if ((g.error = bet(g, amount + last_raise)) != SUCCESS)
+    if (!checked_add(amount, last_raise, total))
+        return (g.error = GRR_BET_ABOVE_MAXIMUM);
+    if ((g.error = bet(g, total)) != SUCCESS)
         return g.error;
 
     g.last_aggressor = g.current_player;
@@ -113,12 +116,12 @@ game_error share_funds(game_state& g) {
     if (g.winner < 0)
         return GRR_GAME_NOT_OVER;
 
-    if (g.winner == ALICE) {
-        g.funds_share[ALICE] = g.players[ALICE].total_funds + g.players[BOB].bets;
-        g.funds_share[BOB] = g.players[BOB].total_funds - g.players[BOB].bets;
-    } else if (g.winner == BOB) {
-        g.funds_share[BOB] = g.players[BOB].total_funds + g.players[ALICE].bets;
-        g.funds_share[ALICE] = g.players[ALICE].total_funds - g.players[ALICE].bets;
+    if (g.winner == ALICE || g.winner == BOB) {
+        auto& winner = g.players[g.winner];
+        auto& loser = g.players[opponent_id(g.winner)];
+        if (!checked_add(winner.total_funds, loser.bets, g.funds_share[winner.id]) ||
+            !checked_sub(loser.total_funds, loser.bets, g.funds_share[loser.id]))
+            return (g.error = BIG_OVERFLOW);
     } else {  // tie
         g.funds_share[BOB] = g.players[BOB].total_funds;
         g.funds_share[ALICE] = g.players[ALICE].total_funds;
@@ -156,6 +159,12 @@ static void end_phase(game_state& g) {
         int aux = g.phase;
         g.phase = (bet_phase)++aux;
 
+        // nobody can bet once a player is all in: straight to the showdown,
+        // unless the game is played at a version that bets every street
+        if (g.version >= runout_version && g.phase < PHS_SHOWDOWN && (g.players[ALICE].bets == g.players[ALICE].total_funds ||
+                                       g.players[BOB].bets == g.players[BOB].total_funds))
+            g.phase = PHS_SHOWDOWN;
+
         if (g.phase == PHS_SHOWDOWN)
             g.current_player = NONE;
     }
@@ -176,10 +185,11 @@ static game_error bet(game_state& g, money_t amount) {
     player_state& player = g.players[g.current_player];
     player_state& opponent = g.players[opponent_id(player.id)];
 
-    if (player.bets + amount > player.total_funds)
+    money_t bets;
+    if (!checked_add(player.bets, amount, bets) || bets > player.total_funds)
         return (g.error = GRR_INSUFFICIENT_FUNDS);
 
-    g.players[player.id].bets += amount;
+    g.players[player.id].bets = bets;
     return SUCCESS;
 }
 
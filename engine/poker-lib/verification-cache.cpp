@@ -0,0 +1,144 @@
+#include "verification-cache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <gcrypt.h>
+#ifdef POKER_THREADS
+#include <mutex>
+#endif
+
+namespace poker {
+
+// set again by each init_poker_lib, while other threads verify
+static std::string cache_dir;
+#ifdef POKER_THREADS
+static std::mutex cache_dir_lock;
+#define LOCK_CACHE_DIR() std::lock_guard<std::mutex> lock(cache_dir_lock)
+#else
+#define LOCK_CACHE_DIR()
+#endif
+
+static const char record_header[] = "poker-verified-prefix-1";
+
+void set_verification_cache(const std::string& dir) {
+    LOCK_CACHE_DIR();
+    cache_dir = dir;
+}
+
+std::string verification_cache_dir() {
+    LOCK_CACHE_DIR();
+    return cache_dir;
+}
+
+std::string next_transcript_hash(const std::string& prev, const std::string& message) {
+    std::string data = prev + message;
+    std::string digest(gcry_md_get_algo_dlen(GCRY_MD_SHA256), 0);
+    gcry_md_hash_buffer(GCRY_MD_SHA256, &digest[0], data.data(), data.size());
+    return digest;
+}
+
+static std::string to_hex(const std::string& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    for (unsigned char c : bytes) {
+        hex += digits[c >> 4];
+        hex += digits[c & 0xf];
+    }
+    return hex;
+}
+
+static int from_hex_digit(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+static bool from_hex(const std::string& hex, std::string& bytes) {
+    if (hex.size() % 2)
+        return false;
+    bytes.clear();
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int hi = from_hex_digit(hex[i]), lo = from_hex_digit(hex[i+1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        bytes += (char)(hi << 4 | lo);
+    }
+    return true;
+}
+
+static std::string prefix_path(const std::string& dir, const std::string& first_hash) {
+    return dir + "/" + to_hex(first_hash);
+}
+
+std::string verified_prefix_path(const std::string& first_hash) {
+    return prefix_path(verification_cache_dir(), first_hash);
+}
+
+bool load_verified_prefix(const std::string& first_hash, verified_prefix& prefix) {
+    auto dir = verification_cache_dir();
+    if (dir.empty())
+        return false;
+    std::ifstream is(prefix_path(dir, first_hash));
+    std::string header, hash;
+    size_t hash_count, card_count;
+    if (!(is >> header >> hash_count) || header != record_header)
+        return false;
+
+    prefix = verified_prefix();
+    for (size_t i = 0; i < hash_count; i++) {
+        std::string bytes;
+        if (!(is >> hash) || !from_hex(hash, bytes))
+            return false;
+        prefix.hashes.push_back(bytes);
+    }
+    if (!(is >> card_count))
+        return false;
+    for (size_t i = 0; i < card_count; i++) {
+        int index, card;
+        if (!(is >> index >> card))
+            return false;
+        prefix.cards[index] = card;
+    }
+    return prefix.hashes.size() && prefix.hashes[0] == first_hash;
+}
+
+// Records are replaced atomically, so concurrent verifications of one game
+// read either record whole.
+bool store_verified_prefix(const verified_prefix& prefix) {
+    static std::atomic<unsigned> counter(0);
+    auto dir = verification_cache_dir();
+    if (dir.empty() || prefix.hashes.empty())
+        return false;
+
+    auto path = prefix_path(dir, prefix.hashes[0]);
+    auto tmp = path + ".tmp" + std::to_string(counter++) + "-" +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream os(tmp);
+        os << record_header << "\n" << prefix.hashes.size() << "\n";
+        for (auto& h : prefix.hashes)
+            os << to_hex(h) << "\n";
+        os << prefix.cards.size() << "\n";
+        for (auto& c : prefix.cards)
+            os << c.first << " " << c.second << "\n";
+        if (!os.good()) {
+            os.close();
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+#ifdef WINDOWS
+    std::remove(path.c_str());  // rename does not replace files there
+#endif
+    if (std::rename(tmp.c_str(), path.c_str())) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace poker
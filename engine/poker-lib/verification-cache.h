@@ -0,0 +1,149 @@
+#ifndef VERIFICATION_CACHE_H
+#define VERIFICATION_CACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "i_participant.h"
+
+namespace poker {
+
+/*
+ * On-disk cache of transcript prefixes whose cryptography was verified.
+ * Transcripts are identified by a running hash over their messages:
+ * hash[k] = SHA-256(hash[k-1] || message k), see game_playback. A record
+ * keeps the hashes of a verified prefix and the cards opened while playing
+ * it back, and lives in a file named after the hash of the first message,
+ * so re-verifying the same game needs no proof checking while betting and
+ * the verification rules are evaluated again.
+ */
+
+// Cache directory; empty disables the cache
+void set_verification_cache(const std::string& dir);
+std::string verification_cache_dir();
+
+// Next running hash of a transcript, from the previous one ("" at the start)
+std::string next_transcript_hash(const std::string& prev, const std::string& message);
+
+struct verified_prefix {
+    std::vector<std::string> hashes;  // running hashes of the verified messages
+    std::map<int, int> cards;         // card index -> opened card
+
+    // whether the prefix holds the first n messages of the transcript ending with hash
+    bool covers(size_t n, const std::string& hash) const {
+        return n > 0 && hashes.size() >= n && hashes[n - 1] == hash;
+    }
+};
+
+// File holding the record of the game whose first message has this hash
+std::string verified_prefix_path(const std::string& first_hash);
+bool load_verified_prefix(const std::string& first_hash, verified_prefix& prefix);
+bool store_verified_prefix(const verified_prefix& prefix);
+
+/*
+ * Forwards to another participant, recording the cards it opens.
+ */
+class recording_participant : public i_participant {
+    i_participant* _p;
+    std::map<int, int>& _cards;
+
+   public:
+    // takes ownership of p
+    recording_participant(i_participant* p, std::map<int, int>& cards) : _p(p), _cards(cards) {}
+    ~recording_participant() { delete _p; }
+
+    void init(int id, int num_participants, bool predictable) override { _p->init(id, num_participants, predictable); }
+    int id() override { return _p->id(); }
+    int num_participants() override { return _p->num_participants(); }
+    bool predictable() override { return _p->predictable(); }
+
+    game_error create_group(blob& group) override { return _p->create_group(group); }
+    game_error load_group(blob& group) override { return _p->load_group(group); }
+
+    game_error generate_key(blob& key) override { return _p->generate_key(key); }
+    game_error load_their_key(blob& key) override { return _p->load_their_key(key); }
+    game_error finalize_key_generation() override { return _p->finalize_key_generation(); }
+
+    game_error create_vsshe_group(blob& group) override { return _p->create_vsshe_group(group); }
+    game_error load_vsshe_group(blob& group) override { return _p->load_vsshe_group(group); }
+
+    game_error create_stack() override { return _p->create_stack(); }
+    game_error shuffle_stack(blob& mixed_stack, blob& stack_proof) override { return _p->shuffle_stack(mixed_stack, stack_proof); }
+    game_error load_stack(blob& mixed_stack, blob& mixed_stack_proof) override { return _p->load_stack(mixed_stack, mixed_stack_proof); }
+
+    game_error take_cards_from_stack(int count) override { return _p->take_cards_from_stack(count); }
+    game_error prove_card_secret(int card_index, blob& my_proof) override { return _p->prove_card_secret(card_index, my_proof); }
+    game_error self_card_secret(int card_index) override { return _p->self_card_secret(card_index); }
+    game_error verify_card_secret(int card_index, blob& their_proof) override { return _p->verify_card_secret(card_index, their_proof); }
+    game_error open_card(int card_index) override { return _p->open_card(card_index); }
+    size_t get_open_card(int card_index) override {
+        auto card = _p->get_open_card(card_index);
+        _cards[card_index] = (int)card;
+        return card;
+    }
+
+    game_error save(std::ostream& out) override { return _p->save(out); }
+    game_error load(std::istream& in) override { return _p->load(in); }
+};
+
+/*
+ * Replays a verified prefix: accepts all cryptographic material and opens
+ * the recorded cards. Asking for a card that was not recorded sets missed().
+ */
+class cached_participant : public i_participant {
+    const std::map<int, int>& _cards;
+    bool& _missed;
+    int _id;
+    int _num_participants;
+    bool _predictable;
+
+   public:
+    cached_participant(const std::map<int, int>& cards, bool& missed)
+        : _cards(cards), _missed(missed), _id(-1), _num_participants(0), _predictable(false) {}
+
+    void init(int id, int num_participants, bool predictable) override {
+        _id = id;
+        _num_participants = num_participants;
+        _predictable = predictable;
+    }
+    int id() override { return _id; }
+    int num_participants() override { return _num_participants; }
+    bool predictable() override { return _predictable; }
+
+    game_error create_group(blob& group) override { return SUCCESS; }
+    game_error load_group(blob& group) override { return SUCCESS; }
+
+    game_error generate_key(blob& key) override { return SUCCESS; }
+    game_error load_their_key(blob& key) override { return SUCCESS; }
+    game_error finalize_key_generation() override { return SUCCESS; }
+
+    game_error create_vsshe_group(blob& group) override { return SUCCESS; }
+    game_error load_vsshe_group(blob& group) override { return SUCCESS; }
+
+    game_error create_stack() override { return SUCCESS; }
+    game_error shuffle_stack(blob& mixed_stack, blob& stack_proof) override { return SUCCESS; }
+    game_error load_stack(blob& mixed_stack, blob& mixed_stack_proof) override { return SUCCESS; }
+
+    game_error take_cards_from_stack(int count) override { return SUCCESS; }
+    game_error prove_card_secret(int card_index, blob& my_proof) override { return SUCCESS; }
+    game_error self_card_secret(int card_index) override { return SUCCESS; }
+    game_error verify_card_secret(int card_index, blob& their_proof) override { return SUCCESS; }
+    game_error open_card(int card_index) override { return SUCCESS; }
+    size_t get_open_card(int card_index) override {
+        auto it = _cards.find(card_index);
+        if (it == _cards.end()) {
+            _missed = true;
+            return 0;
+        }
+        return it->second;
+    }
+
+    // the replayed state lives in the cache record
+    game_error save(std::ostream& out) override { return TMC_INVALID_STATE; }
+    game_error load(std::istream& in) override { return TMC_INVALID_STATE; }
+};
+
+}  // namespace poker
+
+#endif
@@ -1,9 +1,14 @@
 #include <iostream>
+#include <sstream>
 #include <algorithm>
 #include "verifier.h"
 #include "referee.h"
 #include "compression.h"
 #include "game-playback.h"
+#include "streams.h"
+#include "structural_participant.h"
+#include "verification-cache.h"
+#include "service_locator.h"
 
 namespace poker {
 
@@ -14,10 +19,30 @@ verifier::verifier(std::istream& in_player_info, std::istream& in_turn_metadata,
     std::ostream& out_result)
     : _in_player_info(in_player_info),
       _in_turn_metadata(in_turn_metadata), _in_verification_info(in_verification_info),
-      _in_turn_data(in_turn_data), _out_result(out_result), _applied_rule(RULE_UNKNOWN)
+      _in_turn_data(in_turn_data), _out_result(out_result), _turn_data_size(0), _applied_rule(RULE_UNKNOWN),
+      _decided_structurally(false), _proofs_cached(false)
 {
 }
 
+// outcome of playing the turns back, see replay_turns()
+struct verifier::playback_outcome {
+    game_error result;        // playback result, VRF_* for turn metadata rules
+    int last_player_id;       // sender of the last processed message
+    int expected_player_id;   // expected sender of the last processed message
+    int crypto_senders;       // bit mask of the senders of replayed messages checked with crypto
+    bool crypto_failure;      // playback failed while handling a message checked with crypto
+    bool folded;              // a player folded
+};
+
+// messages whose playback verifies groups, keys, shuffles or card proofs;
+// proofs carried by bets are only checked with the next card proof message
+static bool checked_with_crypto(message* msg) {
+    return msg->type() != MSG_BET_REQUEST;
+}
+
+// frames decoded ahead of the referee while playing the turns back
+static const int pipeline_depth = 4;
+
 game_error verifier::verify() {
     game_error res;
     logger << "Verification started" << std::endl;
@@ -27,69 +52,210 @@ game_error verifier::verify() {
         return res;
     }
 
-    game_playback vcr;
-    std::istringstream is(_turn_data);
+    /*
+     * Phase 1: replay the betting and the turn metadata rules with a referee
+     * that accepts all cryptographic material. When that already decides the
+     * dispute, and no crypto failure could move the punishment to the other
+     * player, the cryptographic phase is skipped. Needs a seekable turn data
+     * stream to replay it again.
+     */
+    playback_outcome outcome;
+    std::vector<std::string> transcript;  // running hashes of the messages read
+    _decided_structurally = false;
+    _proofs_cached = false;
+    auto turn_data_start = _in_turn_data.rdbuf()->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+    if (turn_data_start != std::streampos(std::streamoff(-1))) {
+        game_playback structure(new structural_participant());
+        if ((res = replay_turns(structure, outcome)))
+            return res;
+        _g = structure.game();
+        transcript = structure.transcript_hashes();
+        if ((res = compute_result(_results, _applied_rule, _g, outcome.result, outcome.last_player_id,
+                                  outcome.expected_player_id, _verification_info, _player_infos))) {
+            logger << "Failed to compute results" << std::endl;
+            return res;
+        }
+        _decided_structurally = decided_by_structure(outcome);
+        if (!_decided_structurally &&
+            _in_turn_data.rdbuf()->pubseekpos(turn_data_start, std::ios_base::in) != turn_data_start)
+            return CPR_READ_ERROR;
+    }
+
+    /*
+     * Phase 2: full playback. Proofs are not checked again when a previous
+     * verification of this game checked all messages read in phase 1 (see
+     * verification-cache.h); those runs record the cards they open.
+     */
+    if (!_decided_structurally) {
+        verified_prefix cached;
+        if (transcript.size() && load_verified_prefix(transcript[0], cached) &&
+            cached.covers(transcript.size(), transcript.back())) {
+            bool missed = false;
+            game_playback vcr(new cached_participant(cached.cards, missed));
+            if ((res = replay_turns(vcr, outcome)))
+                return res;
+            _g = vcr.game();
+            _proofs_cached = !missed;
+            if (missed && _in_turn_data.rdbuf()->pubseekpos(turn_data_start, std::ios_base::in) != turn_data_start)
+                return CPR_READ_ERROR;
+        }
+        if (!_proofs_cached) {
+            verified_prefix verified;
+            game_playback vcr(new recording_participant(service_locator::instance().new_participant(), verified.cards));
+            if ((res = replay_turns(vcr, outcome)))
+                return res;
+            _g = vcr.game();
+            auto& hashes = vcr.transcript_hashes();
+            verified.hashes.assign(hashes.begin(), hashes.begin() + vcr.messages_handled());
+            if (verified.hashes.size() && !cached.covers(verified.hashes.size(), verified.hashes.back()))
+                store_verified_prefix(verified);
+        }
+        res = compute_result(_results,      // output
+                             _applied_rule, // output
+                             _g,
+                             outcome.result,
+                             outcome.last_player_id,
+                             outcome.expected_player_id,
+                             _verification_info,
+                             _player_infos);
+
+        if (res != SUCCESS) {
+            logger << "Failed to compute results" << std::endl;
+            return res;
+        }
+    }
+
+    logger << "Applied verification rule:" << ((int)_applied_rule)
+           << (_decided_structurally ? " (structural)" : _proofs_cached ? " (cached proofs)" : "") << std::endl;
+
+    if ((res = write_result(_out_result))) {
+        logger << "Failed write verification result: " <<  (int)res << std::endl;
+        return res;
+    }
+
+    return SUCCESS;
+}
+
+// Plays back all turns, checking them against the turn metadata.
+// Fails only when the turn data is shorter than the metadata declares.
+game_error verifier::replay_turns(game_playback& vcr, playback_outcome& out) {
+    // turns are played back straight from the input, nothing is buffered
+    bounded_streambuf turn_data(_in_turn_data.rdbuf(), _turn_data_size);
+    std::istream is(&turn_data);
+    // the turn data is drained below anyway, so frames may be decoded ahead
+    vcr.set_pipeline_depth(pipeline_depth);
     auto meta = _turn_metadata.begin();
-    auto expected_player_id = find_player_id(meta->player_address);
-    auto player_id = -1; // sender of the last processed message
+    out.expected_player_id = find_player_id(meta->player_address);
+    out.last_player_id = -1;
+    out.crypto_senders = 0;
+    out.folded = false;
+    auto rejected = false;  // by the turn metadata rules
+    auto crypto = false;    // last handled message is checked with crypto
 
     // playback all turns
-    auto playback_res = vcr.playback(is, [&](message* msg) {
-      player_id = msg->player_id;
-      if (player_id != expected_player_id)
-        return VRF_TURN_PLAYER_MISMATCH;
-
-      if (meta == _turn_metadata.end())
-        return VRF_TURN_METADATA_MISSING;
-
-      if (msg->type() == MSG_VTMF) {
-        // 1st message sent by ALICE, initialize game
-        msg_vtmf* vtmf = (msg_vtmf*)msg;
-        referee::init_game_state(vcr.game(), vtmf->alice_money, vtmf->bob_money, vtmf->big_blind);
+    out.result = vcr.playback(is, [&](message* msg) {
+      // further messages of a batch frame belong to the same turn
+      if (vcr.frame_message_index() > 0) {
+        if (msg->player_id != out.last_player_id) {
+          rejected = true;
+          return VRF_TURN_PLAYER_MISMATCH;
+        }
+      } else {
+        out.last_player_id = msg->player_id;
+        auto res = check_turn(vcr, msg, meta, out.expected_player_id);
+        if (res) {
+          rejected = true;
+          return res;
+        }
       }
 
-      if (meta->player_stake != vcr.game().players[player_id].bets)
-        return VRF_STAKE_MISMATCH;
-
-      expected_player_id = find_player_id(meta->next_player_address);
-      meta++;
+      crypto = checked_with_crypto(msg);
+      if (crypto)
+        out.crypto_senders |= 1 << msg->player_id;
+      if (msg->type() == MSG_BET_REQUEST && ((msg_bet_request*)msg)->type == BET_FOLD)
+        out.folded = true;
       return SUCCESS;
     });
+    out.crypto_failure = out.result != SUCCESS && !rejected && crypto;
 
     if (meta != _turn_metadata.end())
-      playback_res = VRF_TURN_METADATA_NOT_CONSUMED;
-
-    _g = vcr.game();
-    res = compute_result(_results,      // output
-                         _applied_rule, // output
-                         _g,
-                         playback_res,
-                         player_id,
-                         expected_player_id,
-                         _verification_info,
-                         _player_infos);
-
-    if (res != SUCCESS) {
-        logger << "Failed to compute results" << std::endl;
-        return res;
+      out.result = VRF_TURN_METADATA_NOT_CONSUMED;
+
+    // all turns declared in the metadata must be present
+    if (!turn_data.drain())
+      return END_OF_STREAM;
+    return SUCCESS;
+}
+
+// turn metadata rules for the first message of a turn
+game_error verifier::check_turn(game_playback& vcr, message* msg, std::vector<turn_metadata_t>::iterator& meta, int& expected_player_id) {
+    if (msg->player_id != expected_player_id)
+      return VRF_TURN_PLAYER_MISMATCH;
+
+    if (meta == _turn_metadata.end())
+      return VRF_TURN_METADATA_MISSING;
+
+    if (msg->type() == MSG_VTMF || msg->type() == MSG_SHORT_VTMF) {
+      // 1st message sent by ALICE, initialize game
+      msg_vtmf* vtmf = (msg_vtmf*)msg;
+      referee::init_game_state(vcr.game(), vtmf->alice_money, vtmf->bob_money, vtmf->big_blind);
     }
 
-    logger << "Applied verification rule:" << ((int)_applied_rule) << std::endl;
+    if (meta->player_stake != vcr.game().players[msg->player_id].bets)
+      return VRF_STAKE_MISMATCH;
 
-    if ((res = write_result(_out_result))) {
-        logger << "Failed write verification result: " <<  (int)res << std::endl;
-        return res;
+    expected_player_id = find_player_id(meta->next_player_address);
+    meta++;
+    return SUCCESS;
+}
+
+/*
+ * Whether the result of the structural phase is final. A message failing its
+ * crypto checks would have ended the full playback earlier, punishing its
+ * sender: that changes nothing only if all such messages were sent by the
+ * player punished anyway (the applied rule would then read
+ * RULE_PLAYBACK_FAILED, with the same funds). Showdown winners depend on the
+ * actual cards and are never decided here.
+ */
+bool verifier::decided_by_structure(const playback_outcome& o) {
+    if (o.crypto_failure)
+        return false;
+    if (o.result == SUCCESS && _g.winner != -1 && !_g.muck && !o.folded)
+        return false;
+
+    int punished;
+    switch(_applied_rule) {
+        case RULE_TURN_PLAYER_MISMATCH:
+        case RULE_STAKE_MISMATCH:
+        case RULE_TURN_METADATA_MISSING:
+        case RULE_PLAYBACK_FAILED:
+            punished = o.last_player_id;
+            break;
+        case RULE_GAME_IS_NOT_OVER:
+        case RULE_NO_CLAIMER:
+        case RULE_CLAIM_IS_TRUE:
+            punished = _verification_info.challenger_id;
+            break;
+        case RULE_CLAIM_IS_FALSE:
+            punished = opponent_id(_verification_info.challenger_id);
+            break;
+        default:
+            return false;
     }
+    if (punished != ALICE && punished != BOB)
+        return false;
+    return (o.crypto_senders & ~(1 << punished)) == 0;
+}
 
-    // write verification results and game state as JSON to stdout
-    std::cout << "{\"funds\":[";
+std::string verifier::to_json() {
+    std::ostringstream os;
+    os << "{\"funds\":[";
     for(int i=0; i < _results.size(); i++) {
-        if (i>0) std::cout << ",";
-        std::cout << "\"" << _results[i].to_string() << "\"";
+        if (i>0) os << ",";
+        os << "\"" << _results[i].to_string() << "\"";
     }
-    std::cout << "], \"game_state\":" << _g.to_json() << "}";
-
-    return SUCCESS;
+    os << "], \"game_state\":" << _g.to_json() << "}";
+    return os.str();
 }
 
 game_error verifier::compute_result(verification_results_t& results,
@@ -107,65 +273,61 @@ game_error verifier::compute_result(verification_results_t& results,
     // message sender is not the expected player
     if (playback_result == VRF_TURN_PLAYER_MISMATCH) {
       rule = RULE_TURN_PLAYER_MISMATCH;
-      punish(last_player_id, results);
-      return SUCCESS;
+      return punish(last_player_id, results);
     }
 
     // computed stake different from the amount reported in turn metadata
     if (playback_result == VRF_STAKE_MISMATCH) {
     rule = RULE_STAKE_MISMATCH;
-    punish(last_player_id, results);
-    return SUCCESS;
+    return punish(last_player_id, results);
   }
 
     // There is no metadata for this turn
     if (playback_result == VRF_TURN_METADATA_MISSING) {
       rule = RULE_TURN_METADATA_MISSING;
-      punish(last_player_id, results);
-      return SUCCESS;
+      return punish(last_player_id, results);
     }
 
     // If an error arises, punish the player whose move was illegal.
     if (playback_result != SUCCESS) {
         // playback failed - punish last_player_id
         rule = RULE_PLAYBACK_FAILED;
-        punish(last_player_id, results);
-        return SUCCESS;
+        return punish(last_player_id, results);
     }
 
     // If no error arises and the game has not ended yet, punish the challenger (player who triggered a useless verification)
     auto game_over = (g.winner != -1);
     if (!game_over) {
         // playback succeeded, but the game did not reach game over condition
-        punish(ver_info.challenger_id, results);
         rule = RULE_GAME_IS_NOT_OVER;
-        return SUCCESS;
+        return punish(ver_info.challenger_id, results);
     }
 
     // If a result is computed, compare it with the claimed result. Punish the claimer if they do not match, otherwise punish the challenger
     
     if (ver_info.claimer_addr == bignumber(0)) {
         rule = RULE_NO_CLAIMER;;
-        punish(ver_info.challenger_id, results);
+        return punish(ver_info.challenger_id, results);
     } else {
         auto claimed_result_matches = (g.funds_share[ALICE] == ver_info.claimed_funds[ALICE])
                                    && (g.funds_share[BOB]   == ver_info.claimed_funds[BOB]);
         if (claimed_result_matches) {
             rule = RULE_CLAIM_IS_TRUE;
-            punish(ver_info.challenger_id, results);
+            return punish(ver_info.challenger_id, results);
         } else {
             rule = RULE_CLAIM_IS_FALSE;
-            punish(opponent_id(ver_info.challenger_id), results);
+            return punish(opponent_id(ver_info.challenger_id), results);
         }
     } 
-    return SUCCESS;
 }
 
-void verifier::punish(int player, verification_results_t& funds) {
+game_error verifier::punish(int player, verification_results_t& funds) {
     auto honest = opponent_id(player);
     logger << "punish " << player << " honest " << honest << std::endl;
-    funds[honest] += funds[player];
+    if (!checked_add(funds[honest], funds[player], funds[honest]))
+        return BIG_OVERFLOW;
     funds[player] = 0;
+    return SUCCESS;
 }
 
 game_error verifier::write_result(std::ostream& out) {
@@ -217,6 +379,33 @@ game_error verifier::load_player_info(std::istream& in) {
     return SUCCESS;
 }
 
+static game_error load_field(bignumber& field, const char* data, int len) {
+    field.load_binary_be(data, len);
+    return SUCCESS;
+}
+
+static game_error load_field(money_t& field, const char* data, int len) {
+    return field.load_binary_be(data, len);
+}
+
+/*
+ * Reads one column of the turn metadata: a field of len bytes for each
+ * turn, stored back to back. The column is read at once and then decoded.
+ */
+template <typename T>
+static game_error read_column(std::istream& in, std::vector<turn_metadata_t>& turns, T turn_metadata_t::*field, int len) {
+    game_error res;
+    if (!in.good())
+        return BIG_READ_ERROR;
+    std::vector<char> column(turns.size() * len);
+    if (!column.empty() && !in.read(column.data(), column.size()))
+        return BIG_READ_ERROR;
+    for(size_t i=0; i < turns.size(); i++)
+        if ((res = load_field(turns[i].*field, &column[i * len], len)))
+            return res;
+    return SUCCESS;
+}
+
 game_error verifier::load_turn_metadata(std::istream& in) {
     game_error res;
     bignumber count;
@@ -226,30 +415,21 @@ game_error verifier::load_turn_metadata(std::istream& in) {
     logger << "load_turn_metadata count=" << (int)count << std::endl;
     _turn_metadata.resize(count);
 
+    if ((res = read_column(in, _turn_metadata, &turn_metadata_t::player_address, 20)) ||
+        (res = read_column(in, _turn_metadata, &turn_metadata_t::next_player_address, 20)) ||
+        (res = read_column(in, _turn_metadata, &turn_metadata_t::player_stake, 32)) ||
+        (res = read_column(in, _turn_metadata, &turn_metadata_t::timestamp, 4)) ||
+        (res = read_column(in, _turn_metadata, &turn_metadata_t::size, 4)))
+        return res;
+
     for(int i=0; i < (int)count; i++) {
-        if ((res=_turn_metadata[i].player_address.read_binary_be(in, 20)))
-            return res;
-        logger << "_turn_metadata[" << i << "].player_address = " << _turn_metadata[i].player_address.to_string(16) << std::endl;
-    }
-    for(int i=0; i < (int)count; i++) {
-        if ((res=_turn_metadata[i].next_player_address.read_binary_be(in, 20)))
-            return res;
-        logger << "_turn_metadata[" << i << "].next_player_address = " << _turn_metadata[i].next_player_address.to_string(16) << std::endl;
-    }
-    for(int i=0; i < (int)count; i++) {
-        if ((res=_turn_metadata[i].player_stake.read_binary_be(in, 32)))
-            return res;
-        logger << "_turn_metadata[" << i << "].player_stake = " << _turn_metadata[i].player_stake.to_string(10) << std::endl;
-    }
-    for(int i=0; i < (int)count; i++) {
-        if ((res=_turn_metadata[i].timestamp.read_binary_be(in, 4)))
-            return res;
-        logger << "_turn_metadata[" << i << "].timestamp = " << _turn_metadata[i].timestamp.to_string(16) << std::endl;
-    }
-    for(int i=0; i < (int)count; i++) {
-        if ((_turn_metadata[i].size.read_binary_be(in, 4)))
-            return res;
-        logger << "_turn_metadata[" << i << "].size = " << _turn_metadata[i].size.to_string() << std::endl;
+        auto& m = _turn_metadata[i];
+        logger << "_turn_metadata[" << i << "]"
+               << " player_address = " << m.player_address.to_string(16)
+               << " next_player_address = " << m.next_player_address.to_string(16)
+               << " player_stake = " << m.player_stake.to_string(10)
+               << " timestamp = " << m.timestamp.to_string(16)
+               << " size = " << m.size.to_string() << std::endl;
     }
     return SUCCESS;
 }
@@ -290,21 +470,18 @@ game_error verifier::load_verification_info(std::istream& in) {
 int verifier::find_player_id(bignumber& address) {
     
     for(int i=0; i<_player_infos.size(); i++) 
-        if (((unsigned long)address) == ((unsigned  long)_player_infos[i].address))
+        if (address == _player_infos[i].address)
             return i;
     return -1;
 }
 
+// turn data is streamed during playback, only its extent is known upfront
 game_error verifier::load_turn_data(std::istream& in) {
-    game_error res;
     logger << "load_turn_data...\n";
-    _turn_data .clear();
+    _turn_data_size = 0;
     for(int i=0; i<_turn_metadata.size(); i++) {
         int size = _turn_metadata[i].size;
-        std::string b;
-        if ((res = read_exactly(in, size, b)))
-            return res;
-        _turn_data += b;
+        _turn_data_size += size;
     }
     return SUCCESS;
 }
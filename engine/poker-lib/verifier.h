@@ -8,11 +8,13 @@
 
 #include "common.h"
 #include "bignumber.h"
+#include "money.h"
 #include "blob.h"
 #include "game-state.h"
 #include "messages.h"
 #include "codec.h"
 #include "referee.h"
+#include "game-playback.h"
 
 namespace poker {
 
@@ -30,19 +32,19 @@ enum verification_rule {
 
 struct player_info_t {
     bignumber address;
-    bignumber funds;
+    money_t funds;
 };
 typedef std::array<player_info_t, NUM_PLAYERS> player_infos_t;
 
 struct turn_metadata_t {
     bignumber player_address;
     bignumber next_player_address;
-    bignumber player_stake;
+    money_t player_stake;
     bignumber timestamp;
     bignumber size;
 };
 
-typedef std::array<bignumber, NUM_PLAYERS> claimed_funds_t;
+typedef std::array<money_t, NUM_PLAYERS> claimed_funds_t;
 
 struct verification_info_t {
     bignumber challenger_addr;
@@ -54,7 +56,7 @@ struct verification_info_t {
     claimed_funds_t claimed_funds;
 };
 
-typedef std::array<bignumber, NUM_PLAYERS> verification_results_t;
+typedef std::array<money_t, NUM_PLAYERS> verification_results_t;
 
 class verifier {
 private:
@@ -69,7 +71,7 @@ private:
     player_infos_t _player_infos;
     std::vector<turn_metadata_t> _turn_metadata;
     verification_info_t _verification_info;
-    std::string _turn_data;
+    std::streamsize _turn_data_size;
     verification_results_t _results;
 
     // game recreated after verification
@@ -77,6 +79,12 @@ private:
 
     // applied verification rule
     verification_rule _applied_rule;
+    // decided without the cryptographic playback
+    bool _decided_structurally;
+    // proofs of the turn data found in the verification cache
+    bool _proofs_cached;
+
+    struct playback_outcome;
 
 public:
     verifier(std::istream& in_player_info, std::istream& in_turn_metadata,
@@ -92,6 +100,15 @@ public:
 
     verification_rule applied_rule() { return _applied_rule; }
 
+    // true when the dispute was decided by the betting and turn metadata
+    // alone; game() then holds placeholder cards
+    bool decided_structurally() { return _decided_structurally; }
+    // true when the proofs were not checked again, see verification-cache.h
+    bool proofs_cached() { return _proofs_cached; }
+
+    // verification results and game state
+    std::string to_json();
+
     static game_error compute_result(verification_results_t& results,       // output: receives the final funds distribution
                               verification_rule& rule,                      // output: verification rule applied
                               const game_state& g,                          // game state after playback
@@ -101,7 +118,7 @@ public:
                               const verification_info_t& verification_info, // decoded info
                               const player_infos_t& player_infos);           // decoded info
 
-    static void punish(int player, verification_results_t& funds);
+    static game_error punish(int player, verification_results_t& funds);
 
 private:
     game_error load_inputs();
@@ -109,6 +126,9 @@ private:
     game_error load_turn_metadata(std::istream& in);
     game_error load_verification_info(std::istream& in);
     game_error load_turn_data(std::istream& in);
+    game_error replay_turns(game_playback& vcr, playback_outcome& out);
+    game_error check_turn(game_playback& vcr, message* msg, std::vector<turn_metadata_t>::iterator& meta, int& expected_player_id);
+    bool decided_by_structure(const playback_outcome& o);
     game_error write_result(std::ostream& out);
 
     int find_player_id(bignumber& address);
@@ -0,0 +1,179 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "mapped-file.h"
+#include "poker-lib.h"
+#include "streams.h"
+#include "verifier.h"
+
+using namespace poker;
+
+/*
+   Verifies many disputes in one process, with a pool of worker threads.
+   Library initialization and group validation are paid once per process
+   instead of once per dispute.
+
+   Usage: verify-batch [-j <threads>] <bundles>
+
+   <bundles> is either a directory whose subdirectories are dispute bundles
+   (player-info.raw, turn-metadata.raw, verification-info.raw and
+   turn-data.raw, as written by generate) with results going to
+   <bundle>/result.raw, or a manifest file with one bundle per line:
+
+     <name> <player-info> <turn-metadata> <verification-info> <turn-data> <output>
+
+   Prints one JSON line per bundle as it completes, then aggregate stats.
+   Exits with 1 if any bundle failed to verify.
+*/
+
+struct bundle {
+    std::string name;
+    std::string player_info;
+    std::string turn_metadata;
+    std::string verification_info;
+    std::string turn_data;
+    std::string output;
+};
+
+struct bundle_result {
+    game_error error;
+    verification_rule rule;
+    double ms;
+    std::string json;
+};
+
+static int usage(char** argv) {
+    std::cerr << "Usage: " << argv[0] << " [-j <threads>] <bundle-directory | manifest>" << std::endl;
+    return -1;
+}
+
+static bool is_directory(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static bool load_directory(const std::string& dir, std::vector<bundle>& bundles) {
+    DIR* d = opendir(dir.c_str());
+    if (!d)
+        return false;
+    while (auto e = readdir(d)) {
+        std::string name = e->d_name;
+        auto path = dir + "/" + name;
+        if (name == "." || name == ".." || !is_directory(path))
+            continue;
+        bundles.push_back(bundle{name, path + "/player-info.raw", path + "/turn-metadata.raw",
+                                 path + "/verification-info.raw", path + "/turn-data.raw", path + "/result.raw"});
+    }
+    closedir(d);
+    return true;
+}
+
+static bool load_manifest(const std::string& path, std::vector<bundle>& bundles) {
+    std::ifstream is(path);
+    if (!is.good())
+        return false;
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream ls(line);
+        bundle b;
+        if (!(ls >> b.name >> b.player_info >> b.turn_metadata >> b.verification_info >> b.turn_data >> b.output)) {
+            std::cerr << "Invalid manifest line: " << line << std::endl;
+            return false;
+        }
+        bundles.push_back(b);
+    }
+    return true;
+}
+
+static bundle_result verify_bundle(const bundle& b) {
+    bundle_result r{SUCCESS, RULE_UNKNOWN, 0, ""};
+    auto start = std::chrono::steady_clock::now();
+
+    std::ifstream player_info(b.player_info, std::ios::binary);
+    std::ifstream turn_metadata(b.turn_metadata, std::ios::binary);
+    std::ifstream verification_info(b.verification_info, std::ios::binary);
+    std::ofstream output(b.output, std::ios::binary);
+    mapped_file turn_data_file;
+    if (!player_info.good() || !turn_metadata.good() || !verification_info.good() ||
+        !output.good() || !turn_data_file.open(b.turn_data.c_str())) {
+        r.error = END_OF_STREAM;
+    } else {
+        memory_streambuf turn_data_buf(turn_data_file.data(), turn_data_file.size());
+        std::istream turn_data(&turn_data_buf);
+        verifier ver(player_info, turn_metadata, verification_info, turn_data, output);
+        r.error = ver.verify();
+        r.rule = ver.applied_rule();
+        if (!r.error)
+            r.json = ver.to_json();
+    }
+
+    r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return r;
+}
+
+int main(int argc, char** argv) {
+    int threads = std::thread::hardware_concurrency();
+    int arg = 1;
+    if (argc > 2 && std::string(argv[1]) == "-j") {
+        threads = atoi(argv[2]);
+        arg = 3;
+    }
+    if (argc != arg + 1 || threads < 1)
+        return usage(argv);
+
+    poker_lib_options opts;
+    init_poker_lib(&opts);
+
+    std::vector<bundle> bundles;
+    std::string source = argv[arg];
+    if (!(is_directory(source) ? load_directory(source, bundles) : load_manifest(source, bundles))) {
+        std::cerr << "failed to read " << source << std::endl;
+        return -1;
+    }
+
+    std::atomic<size_t> next(0);
+    std::mutex print_lock;
+    int failed = 0;
+    double total_ms = 0, max_ms = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads && t < (int)bundles.size(); t++) {
+        pool.push_back(std::thread([&]() {
+            for (size_t i; (i = next++) < bundles.size();) {
+                auto r = verify_bundle(bundles[i]);
+                std::lock_guard<std::mutex> lock(print_lock);
+                if (r.error)
+                    failed++;
+                total_ms += r.ms;
+                max_ms = std::max(max_ms, r.ms);
+                std::cout << "{\"bundle\":\"" << bundles[i].name << "\", \"error\":" << (int)r.error
+                          << ", \"rule\":" << (int)r.rule << ", \"ms\":" << r.ms;
+                if (r.json.size())
+                    std::cout << ", \"result\":" << r.json;
+                std::cout << "}" << std::endl;
+            }
+        }));
+    }
+    for (auto& t : pool)
+        t.join();
+
+    auto wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "{\"bundles\":" << bundles.size() << ", \"failed\":" << failed << ", \"threads\":" << threads
+              << ", \"seconds\":" << wall << ", \"bundles_per_second\":" << (wall > 0 ? bundles.size() / wall : 0)
+              << ", \"mean_ms\":" << (bundles.size() ? total_ms / bundles.size() : 0) << ", \"max_ms\":" << max_ms
+              << "}" << std::endl;
+
+    return failed ? 1 : 0;
+}
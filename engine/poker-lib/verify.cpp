@@ -3,6 +3,8 @@
 #include "common.h"
 #include "poker-lib.h"
 #include "verifier.h"
+#include "mapped-file.h"
+#include "streams.h"
 
 void open_write(std::ofstream &f, char* path);
 void open_read(std::ifstream &f, char* path);
@@ -27,15 +29,23 @@ int main(int argc, char**argv) {
     init_poker_lib(&opts);
     
     logger << "opening files... \n";
-    std::ifstream player_info, turn_metadata, verification_info, turn_data;
+    std::ifstream player_info, turn_metadata, verification_info;
     std::ofstream output;
+    mapped_file turn_data_file;
 
     logger << "library initialized \n";
     open_read(player_info, argv[1]);
     open_read(turn_metadata, argv[2]);
     open_read(verification_info, argv[3]);
-    open_read(turn_data, argv[4]);
+    if (!turn_data_file.open(argv[4])) {
+        std::cerr << "failed to open " << argv[4] << std::endl;
+        exit(-1);
+    }
     open_write(output, argv[5]);
+
+    // the turns drive is read in place
+    memory_streambuf turn_data_buf(turn_data_file.data(), turn_data_file.size());
+    std::istream turn_data(&turn_data_buf);
     
     logger << "verifying... \n";
     verifier ver(player_info, turn_metadata, verification_info, turn_data, output);
@@ -44,7 +54,7 @@ int main(int argc, char**argv) {
         std::cout << std::endl << ver.game().to_json() << std::endl;
         return (int)res;
     }
-    std::cout << std::endl;
+    std::cout << ver.to_json() << std::endl;
 
     for(auto&& r: ver.results())
         std::cout << r.to_string() << " ";